@@ -0,0 +1,460 @@
+#ifndef ARITHMETIC_H
+#define ARITHMETIC_H
+
+#include "utils.h"
+#include <stdexcept>
+#include <type_traits>
+
+/*
+ * Function raises overflow error. Called, when result of rational
+ * operation does not fit into the integer type.
+ */
+[[noreturn]] inline void RaiseOverflowError() {
+    RATIONAL_INSTRUMENT(CountRationalEvent(rational_event::exception));
+    throw std::overflow_error("Error: rational overflow!");
+}
+
+/*
+ * Function raises logical error. Called, when denominator of rational
+ * (or divisor) is zero.
+ */
+[[noreturn]] inline void RaiseZeroDenominatorError() {
+    RATIONAL_INSTRUMENT(CountRationalEvent(rational_event::exception));
+    throw std::logic_error("Error: denominator == 0!");
+}
+
+/*
+ * Checked integer arithmetic.
+ *
+ * Every operation sets `overflow` flag, if the result does not fit into
+ * `T`, and returns the wrapped result. `__builtin_*_overflow_p` is used,
+ * so the check compiles to one flag test and works in `constexpr`.
+ */
+template<typename T>
+struct checked_arithmetic {
+    typedef typename integer_traits<T>::unsigned_type unsigned_type;
+
+    bool overflow;
+
+    constexpr checked_arithmetic() : overflow(false) {}
+
+    constexpr T add(T a, T b) {
+        overflow |= __builtin_add_overflow_p(a, b, static_cast<T>(0));
+        return static_cast<T>(static_cast<unsigned_type>(a) +
+                static_cast<unsigned_type>(b));
+    }
+    constexpr T sub(T a, T b) {
+        overflow |= __builtin_sub_overflow_p(a, b, static_cast<T>(0));
+        return static_cast<T>(static_cast<unsigned_type>(a) -
+                static_cast<unsigned_type>(b));
+    }
+    constexpr T mul(T a, T b) {
+        overflow |= __builtin_mul_overflow_p(a, b, static_cast<T>(0));
+        return static_cast<T>(static_cast<unsigned_type>(a) *
+                static_cast<unsigned_type>(b));
+    }
+    constexpr T neg(T a) {
+        return sub(0, a);
+    }
+};
+
+/*
+ * Saturating integer arithmetic.
+ *
+ * Every operation, which does not fit into `T`, returns the nearest limit
+ * of the type and sets `overflow` flag.
+ */
+template<typename T>
+struct saturating_arithmetic {
+    bool overflow;
+
+    constexpr saturating_arithmetic() : overflow(false) {}
+
+    constexpr T add(T a, T b) {
+        if (__builtin_add_overflow_p(a, b, static_cast<T>(0))) {
+            overflow = true;
+            return b > 0 ? integer_traits<T>::max() : integer_traits<T>::min();
+        }
+        return a + b;
+    }
+    constexpr T sub(T a, T b) {
+        if (__builtin_sub_overflow_p(a, b, static_cast<T>(0))) {
+            overflow = true;
+            return b < 0 ? integer_traits<T>::max() : integer_traits<T>::min();
+        }
+        return a - b;
+    }
+    constexpr T mul(T a, T b) {
+        if (__builtin_mul_overflow_p(a, b, static_cast<T>(0))) {
+            overflow = true;
+            return (a < 0) != (b < 0) ? integer_traits<T>::min()
+                    : integer_traits<T>::max();
+        }
+        return a * b;
+    }
+    constexpr T neg(T a) {
+        return sub(0, a);
+    }
+};
+
+/*
+ * Function normalizes rational `num/deno`: divides numerator and
+ * denominator by their greatest common divisor and moves the sign to
+ * the numerator. Denominator must be different from zero.
+ *
+ * Result is written to `n` and `d`.
+ */
+template<typename Arithmetic, typename T>
+constexpr void NormalizeRational(Arithmetic& arithmetic, T num, T deno,
+        T& n, T& d)
+{
+    T gcd = GreatestCommonDivisor(num, deno);
+    if (gcd != 1) {
+        num = num / gcd;
+        deno = deno / gcd;
+    }
+    if (deno < 0) {
+        num = arithmetic.neg(num);
+        deno = arithmetic.neg(deno);
+    }
+    n = num;
+    d = deno;
+}
+
+/*
+ * Types, which have a wider signed integer type (see `integer_traits`).
+ * Other types (`__int128`, `big_integer`) get `std::false_type`.
+ */
+template<typename T>
+struct has_wider_integer : std::false_type {};
+
+template<>
+struct has_wider_integer<int> : std::true_type {};
+
+template<>
+struct has_wider_integer<long> : std::true_type {};
+
+template<>
+struct has_wider_integer<long long> : std::true_type {};
+
+/*
+ * Function checks, whether Knuth's `t` (see `AddRational`) with
+ * `g = gcd(d1, d2)` overflows `T`. If so, the sum is computed in the
+ * wider type, where `t` always fits, and the reduced result is narrowed.
+ * Returns `true`, if the result is stored to `n/d`, and `false`, if `t`
+ * fits into `T` or the result does not.
+ */
+template<bool Subtract, typename T>
+constexpr bool AddRationalWide(T n1, T d1, T n2, T d2, T gcd, T& n, T& d,
+        std::true_type)
+{
+    checked_arithmetic<T> probe;
+    T left = probe.mul(n1, d2 / gcd);
+    T right = probe.mul(n2, d1 / gcd);
+    if (Subtract) {
+        probe.sub(left, right);
+    } else {
+        probe.add(left, right);
+    }
+    if (!probe.overflow) {
+        return false;
+    }
+    typedef typename integer_traits<T>::wider_type W;
+    W wide_left = static_cast<W>(n1) * (d2 / gcd);
+    W wide_right = static_cast<W>(n2) * (d1 / gcd);
+    W t = Subtract ? wide_left - wide_right : wide_left + wide_right;
+    W gcd2 = GreatestCommonDivisor(t, static_cast<W>(gcd));
+    W wide_n = t / gcd2;
+    W wide_d = static_cast<W>(d1 / gcd) * (d2 / gcd2);
+    if (wide_n < integer_traits<T>::min() || wide_n > integer_traits<T>::max() ||
+            wide_d > integer_traits<T>::max()) {
+        return false;
+    }
+    n = static_cast<T>(wide_n);
+    d = static_cast<T>(wide_d);
+    return true;
+}
+
+template<bool Subtract, typename T>
+constexpr bool AddRationalWide(T, T, T, T, T, T&, T&, std::false_type) {
+    return false;
+}
+
+/*
+ * Function adds (or subtracts, if `Subtract` is true) two normalized
+ * rationals `n1/d1` and `n2/d2`. Result is normalized.
+ *
+ * If denominators equals, numerators are added and the sum is normalized.
+ * Otherwise Knuth's algorithm is used: `g = gcd(d1, d2)`,
+ * `t = n1 * (d2 / g) + n2 * (d1 / g)`, `g2 = gcd(t, g)`,
+ * `n = t / g2`, `d = (d1 / g) * (d2 / g2)`. Intermediate values stay
+ * as small as possible. If the sum (or `t`) overflows before it is
+ * divided by the GCD, the step is repeated in the wider type (see
+ * `AddRationalWide`), so the result overflows only when it really does
+ * not fit into the type.
+ */
+template<bool Subtract, typename Arithmetic, typename T>
+constexpr void AddRational(Arithmetic& arithmetic, T n1, T d1, T n2, T d2,
+        T& n, T& d)
+{
+    typedef has_wider_integer<T> has_wider;
+    if (d1 == d2) {
+        if (AddRationalWide<Subtract>(n1, d1, n2, d2, d1, n, d, has_wider())) {
+            return;
+        }
+        T sum = Subtract ? arithmetic.sub(n1, n2) : arithmetic.add(n1, n2);
+        NormalizeRational(arithmetic, sum, d1, n, d);
+        return;
+    }
+    T gcd = GreatestCommonDivisor(d1, d2);
+    if (gcd == 1) {
+        T left = arithmetic.mul(n1, d2);
+        T right = arithmetic.mul(n2, d1);
+        n = Subtract ? arithmetic.sub(left, right) : arithmetic.add(left, right);
+        d = arithmetic.mul(d1, d2);
+        return;
+    }
+    if (AddRationalWide<Subtract>(n1, d1, n2, d2, gcd, n, d, has_wider())) {
+        return;
+    }
+    T left = arithmetic.mul(n1, d2 / gcd);
+    T right = arithmetic.mul(n2, d1 / gcd);
+    T t = Subtract ? arithmetic.sub(left, right) : arithmetic.add(left, right);
+    if (t == 0) {
+        n = 0;
+        d = 1;
+        return;
+    }
+    T gcd2 = GreatestCommonDivisor(t, gcd);
+    n = t / gcd2;
+    d = arithmetic.mul(d1 / gcd, d2 / gcd2);
+}
+
+/*
+ * Function multiplies two normalized rationals `n1/d1` and `n2/d2`.
+ * Result is normalized.
+ *
+ * Numerators and denominators are cancelled crosswise before
+ * multiplication: `g1 = gcd(n1, d2)`, `g2 = gcd(n2, d1)`,
+ * `n = (n1 / g1) * (n2 / g2)`, `d = (d1 / g2) * (d2 / g1)`.
+ */
+template<typename Arithmetic, typename T>
+constexpr void MultiplyRational(Arithmetic& arithmetic, T n1, T d1, T n2,
+        T d2, T& n, T& d)
+{
+    T gcd1 = GreatestCommonDivisor(n1, d2);
+    T gcd2 = GreatestCommonDivisor(n2, d1);
+    n = arithmetic.mul(n1 / gcd1, n2 / gcd2);
+    d = arithmetic.mul(d1 / gcd2, d2 / gcd1);
+}
+
+/*
+ * Function divides normalized rational `n1/d1` by normalized rational
+ * `n2/d2`. Numerator `n2` must be different from zero.
+ * Result is normalized.
+ *
+ * Like `MultiplyRational` with `d2/n2`, the sign is moved to the
+ * numerator at the end.
+ */
+template<typename Arithmetic, typename T>
+constexpr void DivideRational(Arithmetic& arithmetic, T n1, T d1, T n2,
+        T d2, T& n, T& d)
+{
+    T gcd1 = GreatestCommonDivisor(n1, n2);
+    T gcd2 = GreatestCommonDivisor(d2, d1);
+    n = arithmetic.mul(n1 / gcd1, d2 / gcd2);
+    d = arithmetic.mul(d1 / gcd2, n2 / gcd1);
+    if (d < 0) {
+        n = arithmetic.neg(n);
+        d = arithmetic.neg(d);
+    }
+}
+
+/*
+ * Function compares `n1/d1` and `n2/d2` by their continued fractions,
+ * without multiplication, so it works for every integer type.
+ *
+ * Integer parts `floor(n/d)` are compared first. If they are equal, the
+ * fractional parts `r1/d1`, `r2/d2` are compared as `d1/r1` and `d2/r2`
+ * with reversed order, which is the same step with smaller numbers, like
+ * Euclid's algorithm. Denominators must be positive.
+ */
+template<typename T>
+RATIONAL_INSTRUMENTED_CONSTEXPR
+int CompareContinuedFraction(T n1, T d1, T n2, T d2) {
+    int order = 1;
+    for (;;) {
+        T q1 = n1 / d1;
+        T r1 = n1 % d1;
+        if (r1 < 0) {
+            r1 += d1;
+            q1 -= 1;
+        }
+        T q2 = n2 / d2;
+        T r2 = n2 % d2;
+        if (r2 < 0) {
+            r2 += d2;
+            q2 -= 1;
+        }
+        if (q1 != q2) {
+            return q1 < q2 ? -order : order;
+        }
+        if (r1 == 0 || r2 == 0) {
+            if (r1 == r2) {
+                return 0;
+            }
+            return r1 == 0 ? -order : order;
+        }
+        RATIONAL_INSTRUMENT(CountRationalEvent(rational_event::comparison_step));
+        n1 = d1;
+        d1 = r1;
+        n2 = d2;
+        d2 = r2;
+        order = -order;
+    }
+}
+
+/*
+ * Functions compare `n1/d1` and `n2/d2` by cross multiplication in the
+ * wider type `W`, or by continued fractions, if there is no wider type.
+ */
+template<typename W, typename T>
+constexpr int CompareWidened(T n1, T d1, T n2, T d2, std::false_type) {
+    W left = static_cast<W>(n1) * d2;
+    W right = static_cast<W>(n2) * d1;
+    return (left > right) - (left < right);
+}
+template<typename W, typename T>
+constexpr int CompareWidened(T n1, T d1, T n2, T d2, std::true_type) {
+    return CompareContinuedFraction(n1, d1, n2, d2);
+}
+
+/*
+ * Function compares two normalized rationals `n1/d1` and `n2/d2` with
+ * positive denominators. Returns -1, 0 or 1, if the first rational is
+ * less than, equal to or more than the second one.
+ *
+ * Denominators are positive, so `n1/d1 < n2/d2` is `n1 * d2 < n2 * d1`.
+ * Products are computed in the wider type (see `integer_traits`), where
+ * they can not overflow. The widest type has no wider one, so it is
+ * compared by continued fraction expansion (`CompareContinuedFraction`).
+ */
+template<typename T>
+constexpr int CompareRational(T n1, T d1, T n2, T d2) {
+    typedef typename integer_traits<T>::wider_type wider_type;
+    return CompareWidened<wider_type>(n1, d1, n2, d2,
+            std::is_void<wider_type>());
+}
+
+/*
+ * Operations of rational arithmetic as function objects, so overflow
+ * policy can repeat the operation with other arithmetic or integer type.
+ *
+ * Every operation takes arithmetic, operands `n1/d1`, `n2/d2` and
+ * writes the result to `n`, `d`. `normalize_operation` uses only the
+ * first operand.
+ */
+struct normalize_operation {
+    template<typename Arithmetic, typename T>
+    constexpr void operator()(Arithmetic& arithmetic, T n1, T d1, T, T,
+            T& n, T& d) const {
+        NormalizeRational(arithmetic, n1, d1, n, d);
+    }
+};
+
+struct add_operation {
+    template<typename Arithmetic, typename T>
+    constexpr void operator()(Arithmetic& arithmetic, T n1, T d1, T n2, T d2,
+            T& n, T& d) const {
+        AddRational<false>(arithmetic, n1, d1, n2, d2, n, d);
+    }
+};
+
+struct subtract_operation {
+    template<typename Arithmetic, typename T>
+    constexpr void operator()(Arithmetic& arithmetic, T n1, T d1, T n2, T d2,
+            T& n, T& d) const {
+        AddRational<true>(arithmetic, n1, d1, n2, d2, n, d);
+    }
+};
+
+struct multiply_operation {
+    template<typename Arithmetic, typename T>
+    constexpr void operator()(Arithmetic& arithmetic, T n1, T d1, T n2, T d2,
+            T& n, T& d) const {
+        MultiplyRational(arithmetic, n1, d1, n2, d2, n, d);
+    }
+};
+
+struct divide_operation {
+    template<typename Arithmetic, typename T>
+    constexpr void operator()(Arithmetic& arithmetic, T n1, T d1, T n2, T d2,
+            T& n, T& d) const {
+        DivideRational(arithmetic, n1, d1, n2, d2, n, d);
+    }
+};
+
+/*
+ * Overflow policies of `basic_rational`.
+ *
+ * Every operation is done with `checked_arithmetic` first. Only if it
+ * overflows, `recover` of the policy is called with the same operation
+ * and operands, and it must write the result to `n` and `d`.
+ *
+ * `overflow_throw` - raises `std::overflow_error`.
+ * `overflow_saturate` - repeats the operation with `saturating_arithmetic`,
+ * so overflowing values are clamped to the limits of the type. The result
+ * is not exact any more.
+ * `overflow_promote` - repeats the operation in the next wider integer
+ * type, then reduced result is narrowed back. Raises `std::overflow_error`,
+ * if the result does not fit or there is no wider type.
+ */
+struct overflow_throw {
+    template<typename T, typename Operation>
+    static void recover(Operation, T, T, T, T, T&, T&) {
+        RaiseOverflowError();
+    }
+};
+
+struct overflow_saturate {
+    template<typename T, typename Operation>
+    static constexpr void recover(Operation operation, T n1, T d1, T n2, T d2,
+            T& n, T& d) {
+        saturating_arithmetic<T> arithmetic;
+        operation(arithmetic, n1, d1, n2, d2, n, d);
+        NormalizeRational(arithmetic, n, d, n, d);
+    }
+};
+
+struct overflow_promote {
+    template<typename T, typename Operation>
+    static constexpr void recover(Operation operation, T n1, T d1, T n2, T d2,
+            T& n, T& d) {
+        typedef typename integer_traits<T>::wider_type wider_type;
+        promote<wider_type>(operation, n1, d1, n2, d2, n, d,
+                std::is_void<wider_type>());
+    }
+
+private:
+    template<typename W, typename T, typename Operation>
+    static constexpr void promote(Operation operation, T n1, T d1, T n2, T d2,
+            T& n, T& d, std::false_type) {
+        checked_arithmetic<W> arithmetic;
+        W num = 0, deno = 1;
+        operation(arithmetic, static_cast<W>(n1), static_cast<W>(d1),
+                static_cast<W>(n2), static_cast<W>(d2), num, deno);
+        if (arithmetic.overflow || num < integer_traits<T>::min() ||
+                num > integer_traits<T>::max() ||
+                deno > integer_traits<T>::max()) {
+            RaiseOverflowError();
+        }
+        n = static_cast<T>(num);
+        d = static_cast<T>(deno);
+    }
+    template<typename W, typename T, typename Operation>
+    static void promote(Operation, T, T, T, T, T&, T&, std::true_type) {
+        RaiseOverflowError();
+    }
+};
+
+#endif /* ARITHMETIC_H */
@@ -0,0 +1,1248 @@
+#include "rational.h"
+#include "rational_array.h"
+#include "rational_reduce.h"
+#include "rational_flat_map.h"
+#include "rational_io.h"
+#include "rational_binary.h"
+#include "rational_matrix.h"
+#include "rational_polynomial.h"
+#include "rational_float.h"
+#include "rational_expression.h"
+#include "rational_dot.h"
+#include "rational_sort.h"
+#include "fixed_rational.h"
+#include "rational_decimal.h"
+#include "rational_farey.h"
+#include "rational_statistics.h"
+#include "big_rational.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+
+using namespace std;
+
+/*
+ * Variable, which keeps benchmark results alive, so the compiler can not
+ * remove measured code.
+ */
+volatile long long BenchSink = 0;
+
+/*
+ * Number of operations in one timed sample of `Measure`, and number of
+ * runs of `MeasureBatch`. Percentiles are computed over samples.
+ */
+const size_t BenchSampleSize = 256;
+const int BenchRepetitions = 5;
+
+/*
+ * Result of one benchmark. Times are nanoseconds per operation.
+ */
+struct bench_result {
+    string name;
+    string workload;
+    size_t operations;
+    size_t samples;
+    double mean;
+    double p50;
+    double p90;
+    double p99;
+};
+
+/*
+ * Results of all benchmarks for JSON output.
+ */
+vector<bench_result> BenchResults;
+
+/*
+ * Pair of operands for benchmark.
+ */
+template<typename T>
+struct operand_pair {
+    T a;
+    T b;
+};
+
+typedef operand_pair<int> Operands;
+
+/*
+ * Function generates `count` pairs of operands in range `[1, limit]`.
+ * Generator is seeded, so every run uses the same workload.
+ */
+vector<Operands> GenerateUniform(size_t count, int limit, unsigned seed) {
+    mt19937 generator(seed);
+    uniform_int_distribution<int> distribution(1, limit);
+    vector<Operands> result(count);
+    for (Operands& operands : result) {
+        operands.a = distribution(generator);
+        operands.b = distribution(generator);
+    }
+    return result;
+}
+
+/*
+ * Function generates `count` pairs of consecutive Fibonacci numbers, the
+ * worst case of Euclid's algorithm.
+ */
+vector<Operands> GenerateFibonacci(size_t count) {
+    vector<int> fibonacci = {1, 2};
+    while (fibonacci.back() < (1 << 30)) {
+        fibonacci.push_back(fibonacci[fibonacci.size() - 1] +
+                fibonacci[fibonacci.size() - 2]);
+    }
+    vector<Operands> result(count);
+    for (size_t i = 0; i < count; i++) {
+        size_t k = 10 + i % (fibonacci.size() - 11);
+        result[i] = {fibonacci[k + 1], fibonacci[k]};
+    }
+    return result;
+}
+
+/*
+ * Function generates `count` pairs of rationals with numerators and
+ * denominators in range `[1, limit]`, signs of numerators are random.
+ */
+template<typename Rational>
+vector<operand_pair<Rational>> GenerateRationals(size_t count, int limit,
+        unsigned seed) {
+    const vector<Operands> numerators = GenerateUniform(count, limit, seed);
+    const vector<Operands> denominators = GenerateUniform(count, limit, seed + 1);
+    vector<operand_pair<Rational>> result(count);
+    for (size_t i = 0; i < count; i++) {
+        int sign = (numerators[i].a ^ denominators[i].b) & 1 ? -1 : 1;
+        result[i].a = Rational(sign * numerators[i].a, denominators[i].a);
+        result[i].b = Rational(numerators[i].b, denominators[i].b);
+    }
+    return result;
+}
+
+/*
+ * Function generates `count` pairs of ratios of consecutive Fibonacci
+ * numbers: denominators are coprime and large, so every operation does
+ * the longest GCD and the widest products.
+ */
+template<typename Rational>
+vector<operand_pair<Rational>> GenerateAdversarial(size_t count) {
+    const vector<Operands> fibonacci = GenerateFibonacci(count + 1);
+    vector<operand_pair<Rational>> result(count);
+    for (size_t i = 0; i < count; i++) {
+        result[i].a = Rational(fibonacci[i].b, fibonacci[i].a);
+        result[i].b = Rational(fibonacci[i + 1].a, fibonacci[i + 1].b);
+    }
+    return result;
+}
+
+/*
+ * Euclid's algorithm, which was used by `GreatestCommonDivisor` before.
+ * Kept as reference for comparison.
+ */
+int EuclidGreatestCommonDivisor(int p, int q) {
+    while (q) {
+        int t = p % q;
+        p = q;
+        q = t;
+    }
+    return p;
+}
+
+/*
+ * Function computes percentiles of samples (nanoseconds per operation),
+ * prints the result and keeps it for JSON output.
+ */
+void Report(const string& name, const string& workload, size_t operations,
+        double nanoseconds, vector<double> samples) {
+    sort(samples.begin(), samples.end());
+    auto percentile = [&samples](size_t percent) {
+        return samples[min(samples.size() - 1, samples.size() * percent / 100)];
+    };
+    bench_result result = {name, workload, operations, samples.size(),
+            nanoseconds / operations, percentile(50), percentile(90),
+            percentile(99)};
+    BenchResults.push_back(result);
+    cout << left << setw(24) << name << setw(16) << workload << right
+            << fixed << setprecision(2) << setw(10) << result.mean
+            << " ns/op" << setw(14) << setprecision(0) << 1e9 / result.mean
+            << " ops/s" << setprecision(2) << "  p50 " << setw(8)
+            << result.p50 << "  p90 " << setw(8) << result.p90 << "  p99 "
+            << setw(8) << result.p99 << "\n";
+}
+
+/*
+ * Function runs `function` for every operand once. Operations are timed
+ * by samples of `BenchSampleSize`, so percentiles show slow parts of the
+ * workload (for example, growing tree).
+ */
+template<typename Operand, typename Function>
+void Measure(const string& name, const string& workload,
+        const vector<Operand>& operands, Function function)
+{
+    long long sink = 0;
+    vector<double> samples;
+    samples.reserve(operands.size() / BenchSampleSize + 1);
+    auto start = chrono::steady_clock::now();
+    auto sample_start = start;
+    for (size_t first = 0; first < operands.size(); first += BenchSampleSize) {
+        size_t last = min(first + BenchSampleSize, operands.size());
+        for (size_t i = first; i < last; i++) {
+            sink += function(operands[i]);
+        }
+        auto sample_finish = chrono::steady_clock::now();
+        samples.push_back(chrono::duration<double, nano>(
+                sample_finish - sample_start).count() / (last - first));
+        sample_start = sample_finish;
+    }
+    BenchSink = BenchSink + sink;
+    Report(name, workload, operands.size(), chrono::duration<double, nano>(
+            sample_start - start).count(), samples);
+}
+
+/*
+ * Function runs batch operation over `count` elements `BenchRepetitions`
+ * times and reports nanoseconds per element. Percentiles are over runs,
+ * so the operation must not change its input.
+ */
+template<typename Function>
+void MeasureBatch(const string& name, const string& workload, size_t count,
+        Function function)
+{
+    vector<double> samples;
+    double nanoseconds = 0;
+    for (int run = 0; run < BenchRepetitions; run++) {
+        auto start = chrono::steady_clock::now();
+        function();
+        auto finish = chrono::steady_clock::now();
+        double time = chrono::duration<double, nano>(finish - start).count();
+        samples.push_back(time / count);
+        nanoseconds += time;
+    }
+    Report(name, workload, count * samples.size(), nanoseconds, samples);
+}
+
+/*
+ * Function generates `count` pairs of operands of small-denominator
+ * workloads: `prices` - numerators up to 10^6 (cents) and denominator
+ * 100, `durations` - numerators up to 2^10 and denominators `2^k` up to
+ * 64 (musical durations).
+ */
+vector<Operands> GenerateSmallDenominators(size_t count, bool prices,
+        unsigned seed) {
+    mt19937 generator(seed);
+    vector<Operands> result(count);
+    for (Operands& operands : result) {
+        if (prices) {
+            operands = {int(generator() % 1000000) + 1, 100};
+        } else {
+            operands = {int(generator() % 1024) + 1, 1 << (generator() % 7)};
+        }
+    }
+    return result;
+}
+
+/*
+ * GCD and LCD benchmarks for several denominator distributions.
+ * `binary-gcd` is the binary loop without the small-operand table,
+ * `gcd` is `GreatestCommonDivisor`, which uses the table for small
+ * operands. Hit rate is the share of pairs, answered by the table.
+ */
+void BenchGreatestCommonDivisor() {
+    const size_t count = 1 << 20;
+    const vector<pair<string, vector<Operands>>> workloads = {
+        {"uniform-2^8", GenerateUniform(count, 1 << 8, 1)},
+        {"uniform-2^16", GenerateUniform(count, 1 << 16, 2)},
+        {"uniform-2^31", GenerateUniform(count, 0x7fffffff, 3)},
+        {"fibonacci", GenerateFibonacci(count)},
+        {"prices", GenerateSmallDenominators(count, true, 5)},
+        {"durations", GenerateSmallDenominators(count, false, 6)},
+    };
+    for (const auto& workload : workloads) {
+        Measure("euclid-gcd", workload.first, workload.second,
+                [](const Operands& pair) {
+            return EuclidGreatestCommonDivisor(pair.a, pair.b);
+        });
+        Measure("binary-gcd", workload.first, workload.second,
+                [](const Operands& pair) {
+            return BinaryGreatestCommonDivisor(unsigned(pair.a),
+                    unsigned(pair.b));
+        });
+        Measure("gcd", workload.first, workload.second,
+                [](const Operands& pair) {
+            return GreatestCommonDivisor(pair.a, pair.b);
+        });
+        Measure("lcm", workload.first, workload.second, [](const Operands& pair) {
+            return LeastCommonDenominator<long long>(pair.a, pair.b);
+        });
+        size_t hits = 0;
+        for (const Operands& pair : workload.second) {
+            hits += IsTableGreatestCommonDivisor(unsigned(pair.a),
+                    unsigned(pair.b));
+        }
+        cout << "gcd table hit rate " << workload.first << ": " << fixed
+                << setprecision(1) << 100.0 * hits / count << "%\n";
+    }
+}
+
+/*
+ * Benchmark of every operator of `basic_rational` and of stream
+ * operators for one workload.
+ */
+template<typename Rational>
+void BenchOperators(const string& workload,
+        const vector<operand_pair<Rational>>& operands) {
+    typedef operand_pair<Rational> operand;
+    Measure("add", workload, operands, [](const operand& pair) {
+        return (pair.a + pair.b).numerator();
+    });
+    Measure("subtract", workload, operands, [](const operand& pair) {
+        return (pair.a - pair.b).numerator();
+    });
+    Measure("multiply", workload, operands, [](const operand& pair) {
+        return (pair.a * pair.b).numerator();
+    });
+    Measure("divide", workload, operands, [](const operand& pair) {
+        return (pair.a / pair.b).numerator();
+    });
+    Measure("add-assign", workload, operands, [](const operand& pair) {
+        Rational value = pair.a;
+        value += pair.b;
+        return value.numerator();
+    });
+    Measure("subtract-assign", workload, operands, [](const operand& pair) {
+        Rational value = pair.a;
+        value -= pair.b;
+        return value.numerator();
+    });
+    Measure("multiply-assign", workload, operands, [](const operand& pair) {
+        Rational value = pair.a;
+        value *= pair.b;
+        return value.numerator();
+    });
+    Measure("divide-assign", workload, operands, [](const operand& pair) {
+        Rational value = pair.a;
+        value /= pair.b;
+        return value.numerator();
+    });
+    Measure("equal", workload, operands, [](const operand& pair) {
+        return pair.a == pair.b;
+    });
+    Measure("not-equal", workload, operands, [](const operand& pair) {
+        return pair.a != pair.b;
+    });
+    Measure("less", workload, operands, [](const operand& pair) {
+        return pair.a < pair.b;
+    });
+    Measure("less-equal", workload, operands, [](const operand& pair) {
+        return pair.a <= pair.b;
+    });
+    Measure("greater", workload, operands, [](const operand& pair) {
+        return pair.a > pair.b;
+    });
+    Measure("greater-equal", workload, operands, [](const operand& pair) {
+        return pair.a >= pair.b;
+    });
+    Measure("not", workload, operands, [](const operand& pair) {
+        return !pair.a;
+    });
+    Measure("bool", workload, operands, [](const operand& pair) {
+        return static_cast<bool>(pair.a);
+    });
+    ofstream output("/dev/null");
+    Measure("ostream-write", workload, operands, [&output](const operand& pair) {
+        output << pair.a << '\n';
+        return 0;
+    });
+    ostringstream text;
+    for (const operand& pair : operands) {
+        text << pair.a << '\n';
+    }
+    istringstream input(text.str());
+    Measure("istream-read", workload, operands, [&input](const operand&) {
+        Rational value;
+        input >> value;
+        return value.numerator();
+    });
+}
+
+/*
+ * Operators for small and large denominators and for adversarial pairs.
+ * Large values are `long long` rationals, so results do not overflow.
+ */
+void BenchOperators() {
+    const size_t count = 1 << 18;
+    BenchOperators("small-2^8", GenerateRationals<rational>(count, 1 << 8, 4));
+    BenchOperators("large-2^30", GenerateRationals<basic_rational<long long>>(
+            count, 1 << 30, 12));
+    BenchOperators("fibonacci", GenerateAdversarial<basic_rational<long long>>(
+            count));
+}
+
+/*
+ * Benchmark of `rational_array` batch operations with every supported
+ * kernel against the loop over `std::vector<rational>`.
+ */
+void BenchRationalArray() {
+    const size_t count = 1 << 20;
+    const vector<Operands> numerators = GenerateUniform(count, 1 << 15, 5);
+    const vector<Operands> denominators = GenerateUniform(count, 1 << 15, 6);
+    vector<rational> left(count), right(count), result(count);
+    for (size_t i = 0; i < count; i++) {
+        left[i] = rational(numerators[i].a, denominators[i].a);
+        right[i] = rational(numerators[i].b, denominators[i].b);
+    }
+    const string workload = "uniform-2^15";
+    MeasureBatch("vector-add", workload, count, [&]() {
+        for (size_t i = 0; i < count; i++) {
+            result[i] = left[i] + right[i];
+        }
+    });
+    MeasureBatch("vector-mul", workload, count, [&]() {
+        for (size_t i = 0; i < count; i++) {
+            result[i] = left[i] * right[i];
+        }
+    });
+    BenchSink = BenchSink + result[count / 2].numerator();
+    
+    rational_array a(left), b(right), c;
+    const pair<string, rational_kernel> kernels[] = {
+        {"scalar", rational_kernel::scalar},
+        {"avx2", rational_kernel::avx2},
+        {"avx512", rational_kernel::avx512},
+    };
+    rational_kernel active = GetRationalKernel();
+    for (const auto& kernel : kernels) {
+        if (!IsRationalKernelSupported(kernel.second)) {
+            continue;
+        }
+        SetRationalKernel(kernel.second);
+        MeasureBatch("array-add-" + kernel.first, workload, count, [&]() {
+            AddRationalArray(a, b, c);
+        });
+        MeasureBatch("array-mul-" + kernel.first, workload, count, [&]() {
+            MultiplyRationalArray(a, b, c);
+        });
+        MeasureBatch("array-div-" + kernel.first, workload, count, [&]() {
+            DivideRationalArray(a, b, c);
+        });
+        vector<signed char> order;
+        MeasureBatch("array-cmp-" + kernel.first, workload, count, [&]() {
+            CompareRationalArray(a, b, order);
+        });
+        BenchSink = BenchSink + c.numerators()[count / 2] + order[count / 2];
+    }
+    SetRationalKernel(active);
+}
+
+/*
+ * Benchmark of `RationalSum` with several thread pools against the
+ * chained `+=` loop. Terms `1/(k(k+1))` have different denominators.
+ */
+void BenchReduce() {
+    typedef basic_rational<long long> rational64;
+    const size_t count = 1 << 20;
+    vector<rational64> terms;
+    for (long long k = 1; k <= static_cast<long long>(count); k++) {
+        terms.push_back(rational64(1, k * (k + 1)));
+    }
+    const string workload = "telescoping";
+    MeasureBatch("chained-sum", workload, count, [&]() {
+        rational64 sum;
+        for (const rational64& term : terms) {
+            sum += term;
+        }
+        BenchSink = BenchSink + sum.numerator();
+    });
+    size_t hardware = thread::hardware_concurrency();
+    for (size_t threads = 1; threads <= hardware || threads == 1;
+            threads *= 2) {
+        thread_pool pool(threads);
+        MeasureBatch("pairwise-sum-" + to_string(threads) + "t", workload,
+                count, [&]() {
+            BenchSink = BenchSink + RationalSum(terms, pool).numerator();
+        });
+    }
+}
+
+/*
+ * Comparison by least common denominator, which was used by `rational`
+ * before. Kept as reference for comparison.
+ */
+bool LeastCommonDenominatorLess(const rational& left, const rational& right) {
+    int lcd = LeastCommonDenominator(left.denominator(), right.denominator());
+    return left.numerator() * (lcd / left.denominator()) <
+            right.numerator() * (lcd / right.denominator());
+}
+
+/*
+ * Benchmark of `<` and of `std::set<rational>`, which compares keys at
+ * every node. Values are small, so the reference does not overflow.
+ */
+void BenchComparison() {
+    const size_t count = 1 << 18;
+    const vector<Operands> operands = GenerateUniform(count, 1 << 12, 7);
+    vector<rational> values;
+    for (const Operands& pair : operands) {
+        values.push_back(rational(pair.a, pair.b));
+    }
+    const string workload = "uniform-2^12";
+    MeasureBatch("lcd-less", workload, count, [&]() {
+        long long sink = 0;
+        for (size_t i = 1; i < count; i++) {
+            sink += LeastCommonDenominatorLess(values[i - 1], values[i]);
+        }
+        BenchSink = BenchSink + sink;
+    });
+    MeasureBatch("cross-less", workload, count, [&]() {
+        long long sink = 0;
+        for (size_t i = 1; i < count; i++) {
+            sink += values[i - 1] < values[i];
+        }
+        BenchSink = BenchSink + sink;
+    });
+    set<rational> tree;
+    Measure("set-insert", workload, values, [&tree](const rational& value) {
+        return tree.insert(value).second;
+    });
+    Measure("set-find", workload, values, [&tree](const rational& value) {
+        return tree.count(value);
+    });
+}
+
+/*
+ * Benchmark of group-by: counting of `count` random keys in `std::map`,
+ * `std::unordered_map` and `rational_flat_map`, then lookup of every key.
+ */
+void BenchFlatMap(size_t count) {
+    const vector<Operands> operands = GenerateUniform(count, 1 << 20, 8);
+    vector<rational> keys;
+    keys.reserve(count);
+    for (const Operands& pair : operands) {
+        keys.push_back(rational(pair.a, pair.b));
+    }
+    const string workload = "keys-" + to_string(count);
+    {
+        map<rational, int> tree;
+        Measure("std-map-count", workload, keys, [&tree](const rational& key) {
+            return ++tree[key];
+        });
+        Measure("std-map-find", workload, keys, [&tree](const rational& key) {
+            return tree.find(key)->second;
+        });
+    }
+    {
+        unordered_map<rational, int> table;
+        Measure("unordered-map-count", workload, keys,
+                [&table](const rational& key) {
+            return ++table[key];
+        });
+        Measure("unordered-map-find", workload, keys,
+                [&table](const rational& key) {
+            return table.find(key)->second;
+        });
+    }
+    {
+        rational_flat_map<int> flat;
+        Measure("flat-map-count", workload, keys, [&flat](const rational& key) {
+            return ++flat[key];
+        });
+        Measure("flat-map-find", workload, keys, [&flat](const rational& key) {
+            return *flat.find(key);
+        });
+    }
+}
+
+/*
+ * Benchmark of parsing of `n/d` lines: `operator>>` against
+ * `ParseRationalText` with and without thread pool.
+ */
+void BenchParse() {
+    const size_t count = 1 << 20;
+    const vector<Operands> operands = GenerateUniform(count, 1 << 30, 9);
+    string text;
+    for (const Operands& pair : operands) {
+        text += to_string(pair.a - (1 << 29)) + "/" + to_string(pair.b) + "\n";
+    }
+    const string workload = "uniform-2^30";
+    vector<rational> values;
+    MeasureBatch("istream-parse", workload, count, [&]() {
+        istringstream input(text);
+        rational value;
+        values.clear();
+        while (input >> value) {
+            values.push_back(value);
+        }
+    });
+    MeasureBatch("bulk-parse", workload, count, [&]() {
+        ParseRationalText(text.data(), text.data() + text.size(), values);
+    });
+    MeasureBatch("bulk-parse-pool", workload, count, [&]() {
+        ParseRationalText(text.data(), text.data() + text.size(), values,
+                &DefaultThreadPool());
+    });
+    BenchSink = BenchSink + values.size();
+}
+
+/*
+ * Formatting of rationals: `operator<<` of single values and
+ * `rational_writer` of the whole vector. Both write to `/dev/null`, so
+ * only formatting and calls of the stream or system are measured.
+ */
+void BenchFormat() {
+    const size_t count = 1 << 20;
+    const vector<Operands> operands = GenerateUniform(count, 1 << 30, 10);
+    vector<rational> values;
+    values.reserve(count);
+    for (const Operands& pair : operands) {
+        values.push_back(rational(pair.a - (1 << 29), pair.b));
+    }
+    const string workload = "uniform-2^30";
+    MeasureBatch("ostream-format", workload, count, [&]() {
+        ofstream output("/dev/null");
+        for (const rational& value : values) {
+            output << value << '\n';
+        }
+    });
+    MeasureBatch("bulk-format", workload, count, [&]() {
+        rational_writer writer("/dev/null");
+        writer.write(values);
+    });
+}
+
+/*
+ * Binary format: writing and reading of the whole vector through the
+ * file in `/tmp`. The file stays in page cache, so decoding is measured.
+ */
+void BenchBinary() {
+    const size_t count = 1 << 20;
+    const vector<Operands> operands = GenerateUniform(count, 1 << 30, 11);
+    vector<rational> values;
+    values.reserve(count);
+    for (const Operands& pair : operands) {
+        values.push_back(rational(pair.a - (1 << 29), pair.b));
+    }
+    const string workload = "uniform-2^30";
+    const string path = "/tmp/rational_bench.bin";
+    MeasureBatch("binary-write", workload, count, [&]() {
+        WriteRationalBinary(path, values);
+    });
+    vector<rational> loaded;
+    MeasureBatch("binary-read", workload, count, [&]() {
+        ReadRationalBinary(path, loaded);
+    });
+    rational_array array;
+    MeasureBatch("binary-read-array", workload, count, [&]() {
+        ReadRationalBinary(path, array);
+    });
+    BenchSink = BenchSink + loaded.size() + array.size();
+    remove(path.c_str());
+}
+
+/*
+ * Function returns determinant by Gaussian elimination with division in
+ * `big_rational`, how it was computed before `rational_matrix`. Kept as
+ * reference for comparison.
+ */
+rational NaiveDeterminant(vector<vector<big_rational>> matrix) {
+    big_rational determinant = 1;
+    const size_t size = matrix.size();
+    for (size_t k = 0; k < size; k++) {
+        size_t pivot = k;
+        while (pivot < size && matrix[pivot][k] == big_rational()) {
+            pivot++;
+        }
+        if (pivot == size) {
+            return 0;
+        }
+        if (pivot != k) {
+            swap(matrix[pivot], matrix[k]);
+            determinant *= big_rational(-1);
+        }
+        determinant *= matrix[k][k];
+        for (size_t i = k + 1; i < size; i++) {
+            big_rational factor = matrix[i][k] / matrix[k][k];
+            for (size_t j = k; j < size; j++) {
+                matrix[i][j] -= factor * matrix[k][j];
+            }
+        }
+    }
+    rational result;
+    determinant.toRational(result);
+    return result;
+}
+
+/*
+ * Linear algebra benchmarks. Matrix is product of random unit lower and
+ * upper triangular matrices, so determinant is 1 and solution of
+ * `a * x = a * (1, ..., 1)` fits into `rational`, but intermediate
+ * fractions grow.
+ */
+void BenchMatrix(size_t size) {
+    rational_matrix lower = rational_matrix::identity(size);
+    rational_matrix upper = rational_matrix::identity(size);
+    mt19937 generator(12);
+    for (size_t i = 0; i < size; i++) {
+        for (size_t j = 0; j < i; j++) {
+            lower(i, j) = int(generator() % 3) - 1;
+            upper(j, i) = rational(int(generator() % 3) - 1, 2);
+        }
+    }
+    const rational_matrix matrix = lower * upper;
+    rational_matrix ones(size, 1);
+    fill(ones.data(), ones.data() + size, rational(1));
+    const rational_matrix product = matrix * ones;
+    const vector<rational> right(product.data(), product.data() + size);
+    vector<vector<big_rational>> nested(size, vector<big_rational>(size));
+    for (size_t i = 0; i < size; i++) {
+        for (size_t j = 0; j < size; j++) {
+            nested[i][j] = matrix(i, j);
+        }
+    }
+    const string workload = to_string(size) + "x" + to_string(size);
+    long long sink = 0;
+    MeasureBatch("naive-determinant", workload, 1, [&]() {
+        sink += NaiveDeterminant(nested).numerator();
+    });
+    MeasureBatch("matrix-determinant", workload, 1, [&]() {
+        sink += MatrixDeterminant(matrix).numerator();
+    });
+    MeasureBatch("matrix-determinant-pool", workload, 1, [&]() {
+        sink += MatrixDeterminant(matrix, &DefaultThreadPool()).numerator();
+    });
+    MeasureBatch("matrix-solve", workload, 1, [&]() {
+        sink += SolveLinearSystem(matrix, right)[0].numerator();
+    });
+    // Values of the inverse of larger matrices do not fit into `rational`.
+    if (size <= 16) {
+        MeasureBatch("matrix-inverse", workload, 1, [&]() {
+            sink += MatrixInverse(matrix)(0, 0).numerator();
+        });
+    }
+    BenchSink = BenchSink + sink;
+}
+
+/*
+ * Polynomial benchmarks: Horner's scheme with `big_rational` operators,
+ * which reduce at every step, and schoolbook multiplication of
+ * `big_rational` coefficients are kept as reference for comparison.
+ */
+void BenchPolynomial() {
+    mt19937 generator(13);
+    auto random_coefficients = [&generator](size_t size) {
+        vector<rational> values(size);
+        for (rational& value : values) {
+            value = rational(int(generator() % 2001) - 1000,
+                    int(generator() % 64) + 1);
+        }
+        return values;
+    };
+    const vector<rational> coefficients = random_coefficients(8);
+    const rational_polynomial polynomial(coefficients);
+    const size_t count = 1 << 14;
+    vector<rational> points(count);
+    for (rational& point : points) {
+        point = rational(int(generator() % 201) - 100, int(generator() % 16) + 1);
+    }
+    const string workload = "degree-7";
+    long long sink = 0;
+    MeasureBatch("naive-horner", workload, count, [&]() {
+        for (const rational& point : points) {
+            big_rational x = point, sum = coefficients.back();
+            for (size_t i = coefficients.size() - 1; i-- > 0;) {
+                sum = sum * x + coefficients[i];
+            }
+            sink += sum.isSmall();
+        }
+    });
+    MeasureBatch("polynomial-evaluate", workload, count, [&]() {
+        sink += EvaluatePolynomial(polynomial, points).size();
+    });
+
+    for (size_t size : {32, 256}) {
+        const vector<rational> left = random_coefficients(size);
+        const vector<rational> right = random_coefficients(size);
+        const string product_workload = "size-" + to_string(size);
+        MeasureBatch("naive-multiply", product_workload, 1, [&]() {
+            vector<big_rational> product(2 * size - 1);
+            for (size_t i = 0; i < size; i++) {
+                for (size_t j = 0; j < size; j++) {
+                    product[i + j] += big_rational(left[i]) * right[j];
+                }
+            }
+            sink += product.back().isSmall();
+        });
+        const rational_polynomial a(left), b(right);
+        MeasureBatch("polynomial-multiply", product_workload, 1, [&]() {
+            sink += (a * b).size();
+        });
+    }
+    BenchSink = BenchSink + sink;
+}
+
+/*
+ * Floating point conversion benchmarks. Conversion by the cast of
+ * numerator and denominator is kept as reference for comparison, it is
+ * not correctly rounded for `long long`.
+ */
+void BenchFloat() {
+    const size_t count = 1 << 20;
+    const vector<Operands> operands = GenerateUniform(count, 1 << 30, 14);
+    vector<rational> values;
+    values.reserve(count);
+    for (const Operands& pair : operands) {
+        values.push_back(rational(pair.a - (1 << 29), pair.b));
+    }
+    const rational_array array(values);
+    const string workload = "uniform-2^30";
+    vector<double> doubles(count);
+    MeasureBatch("cast-to-double", workload, count, [&]() {
+        for (size_t i = 0; i < count; i++) {
+            doubles[i] = double(values[i].numerator()) / values[i].denominator();
+        }
+    });
+    MeasureBatch("array-to-double", workload, count, [&]() {
+        RationalArrayToDouble(array, doubles);
+    });
+    vector<float> floats;
+    MeasureBatch("array-to-float", workload, count, [&]() {
+        RationalArrayToFloat(array, floats);
+    });
+    const vector<operand_pair<basic_rational<long long>>> wide =
+            GenerateAdversarial<basic_rational<long long>>(count);
+    double sum = 0;
+    Measure("long-cast-to-double", "fibonacci", wide,
+            [&sum](const operand_pair<basic_rational<long long>>& pair) {
+        sum += double(pair.a.numerator()) / pair.a.denominator();
+        return 0;
+    });
+    Measure("long-to-double", "fibonacci", wide,
+            [&sum](const operand_pair<basic_rational<long long>>& pair) {
+        sum += RationalToDouble(pair.a);
+        return 0;
+    });
+    // Values `n / 2^k`, which are exact in `rational`.
+    vector<double> dyadic(count);
+    for (size_t i = 0; i < count; i++) {
+        dyadic[i] = ldexp(operands[i].a - (1 << 29), -(operands[i].b % 30));
+    }
+    rational_array restored;
+    MeasureBatch("array-from-double", workload, count, [&]() {
+        RationalArrayFromDouble(dyadic, restored);
+    });
+    // Proper fractions, so every approximation fits into `rational`.
+    vector<double> fractions(count);
+    for (size_t i = 0; i < count; i++) {
+        fractions[i] = double(operands[i].a % operands[i].b) / operands[i].b;
+    }
+    MeasureBatch("best-approximation", workload, count, [&]() {
+        BestRationalApproximationArray(fractions, 1 << 30, restored);
+    });
+    BenchSink = BenchSink + static_cast<long long>(sum) + restored.size() +
+            floats.size();
+}
+
+/*
+ * Compound expression `a * b + c * d - e` by eager operators (normalization
+ * after every operation) and by expression templates (one normalization).
+ * With instrumentation also prints GCD calls per expression.
+ */
+void BenchExpression() {
+    typedef basic_rational<long long> long_rational;
+    typedef operand_pair<long_rational> operand;
+    const size_t count = 1 << 18;
+    const vector<operand> operands =
+            GenerateRationals<long_rational>(count + 2, 1 << 12, 18);
+    vector<size_t> indices(count);
+    for (size_t i = 0; i < count; i++) {
+        indices[i] = i;
+    }
+    const string workload = "uniform-2^12";
+    auto eager = [&operands](size_t i) {
+        return operands[i].a * operands[i].b + operands[i + 1].a *
+                operands[i + 1].b - operands[i + 2].a;
+    };
+    auto fused = [&operands](size_t i) {
+        return long_rational(Fuse(operands[i].a) * operands[i].b +
+                Fuse(operands[i + 1].a) * operands[i + 1].b -
+                operands[i + 2].a);
+    };
+    Measure("eager-expression", workload, indices, [&eager](size_t i) {
+        return eager(i).numerator();
+    });
+    Measure("fused-expression", workload, indices, [&fused](size_t i) {
+        return fused(i).numerator();
+    });
+    if (IsInstrumentationEnabled()) {
+        ResetInstrumentation();
+        for (size_t i = 0; i < count; i++) {
+            BenchSink = BenchSink + eager(i).numerator();
+        }
+        double eager_gcd = InstrumentationSnapshot().count(rational_event::gcd);
+        ResetInstrumentation();
+        for (size_t i = 0; i < count; i++) {
+            BenchSink = BenchSink + fused(i).numerator();
+        }
+        double fused_gcd = InstrumentationSnapshot().count(rational_event::gcd);
+        cout << "gcd calls per expression: eager " << fixed
+                << setprecision(2) << eager_gcd / count << ", fused "
+                << fused_gcd / count << "\n";
+    }
+}
+
+/*
+ * Dot product by eager `acc += x[i] * y[i]` (two normalizations per
+ * element) and by `RationalDot`, serial and parallel. Denominators are
+ * `2^i` and `3^j`, so the sum fits into `long long`.
+ */
+void BenchDot() {
+    typedef basic_rational<long long> long_rational;
+    const size_t count = 1 << 20;
+    const vector<Operands> operands = GenerateUniform(count, 1 << 12, 19);
+    vector<long_rational> x(count), y(count);
+    for (size_t i = 0; i < count; i++) {
+        x[i] = long_rational(operands[i].a - (1 << 11), 1 << (i % 7));
+        y[i] = long_rational(operands[i].b - (1 << 11),
+                i % 5 == 0 ? 1 : i % 5 == 1 ? 3 : i % 5 == 2 ? 9 : 27);
+    }
+    const string workload = "uniform-2^12";
+    long_rational result;
+    MeasureBatch("eager-dot", workload, count, [&]() {
+        long_rational sum;
+        for (size_t i = 0; i < count; i++) {
+            sum += x[i] * y[i];
+        }
+        result = sum;
+    });
+    MeasureBatch("fused-dot", workload, count, [&]() {
+        result = RationalDot(x, y);
+    });
+    MeasureBatch("parallel-fused-dot", workload, count, [&]() {
+        result = RationalDot(x, y, DefaultThreadPool());
+    });
+    BenchSink = BenchSink + result.numerator();
+}
+
+/*
+ * `std::sort` with exact comparison and `RationalSort` (radix sort by
+ * floating point keys), serial and parallel. Every run sorts a copy, so
+ * the copy is included in all results.
+ */
+template<typename Rational>
+void BenchSort(const string& workload,
+        const vector<operand_pair<Rational>>& operands) {
+    vector<Rational> values;
+    values.reserve(operands.size());
+    for (const operand_pair<Rational>& pair : operands) {
+        values.push_back(pair.a);
+    }
+    vector<Rational> sorted;
+    MeasureBatch("std-sort", workload, values.size(), [&]() {
+        sorted = values;
+        sort(sorted.begin(), sorted.end());
+    });
+    MeasureBatch("rational-sort", workload, values.size(), [&]() {
+        sorted = values;
+        RationalSort(sorted);
+    });
+    MeasureBatch("parallel-rational-sort", workload, values.size(), [&]() {
+        sorted = values;
+        RationalSort(sorted, DefaultThreadPool());
+    });
+    BenchSink = BenchSink + sorted[sorted.size() / 2].numerator();
+}
+
+void BenchSort() {
+    const size_t count = 1 << 20;
+    BenchSort("large-2^30", GenerateRationals<rational>(count, 1 << 30, 20));
+    BenchSort("long-2^30", GenerateRationals<basic_rational<long long>>(
+            count, 1 << 30, 21));
+}
+
+/*
+ * Prices in cents by `basic_rational<long long>` (GCD and common
+ * denominator in every operation) and by `fixed_rational<100>`
+ * (integer operations, one rescale for product).
+ */
+void BenchFixedRational() {
+    typedef basic_rational<long long> long_rational;
+    typedef fixed_rational<100> money;
+    const size_t count = 1 << 20;
+    const vector<Operands> cents = GenerateUniform(count, 1000000, 22);
+    vector<operand_pair<long_rational>> rationals(count);
+    vector<operand_pair<money>> fixed(count);
+    for (size_t i = 0; i < count; i++) {
+        rationals[i] = {long_rational(cents[i].a, 100),
+                long_rational(cents[i].b % 200, 100)};
+        fixed[i] = {money::fromTicks(cents[i].a),
+                money::fromTicks(cents[i].b % 200)};
+    }
+    const string workload = "prices";
+    Measure("rational-add", workload, rationals,
+            [](const operand_pair<long_rational>& pair) {
+        return (pair.a + pair.b).numerator();
+    });
+    Measure("fixed-add", workload, fixed,
+            [](const operand_pair<money>& pair) {
+        return (pair.a + pair.b).ticks();
+    });
+    Measure("rational-multiply", workload, rationals,
+            [](const operand_pair<long_rational>& pair) {
+        return (pair.a * pair.b).numerator();
+    });
+    Measure("fixed-multiply", workload, fixed,
+            [](const operand_pair<money>& pair) {
+        return (pair.a * pair.b).ticks();
+    });
+    Measure("rational-less", workload, rationals,
+            [](const operand_pair<long_rational>& pair) {
+        return pair.a < pair.b;
+    });
+    Measure("fixed-less", workload, fixed,
+            [](const operand_pair<money>& pair) {
+        return pair.a < pair.b;
+    });
+}
+
+/*
+ * Function writes `digits` digits of `n/d` after the point by long
+ * division with one digit per step, the baseline of `FormatDecimal`.
+ */
+char* FormatDecimalByDigit(char* first, long long n, long long d,
+        size_t digits) {
+    first = FormatInteger(first, n / d);
+    *first++ = '.';
+    unsigned long long remainder = static_cast<unsigned long long>(
+            AbsoluteValue(n % d));
+    for (size_t i = 0; i < digits; i++) {
+        unsigned __int128 scaled = static_cast<unsigned __int128>(remainder) * 10;
+        *first++ = static_cast<char>('0' + scaled / d);
+        remainder = static_cast<unsigned long long>(scaled % d);
+    }
+    return first;
+}
+
+/*
+ * Decimal expansion with 40 digits: one digit per division against 9 or
+ * 19 digits per division of `FormatDecimal`, and full repeating
+ * expansion of small denominators.
+ */
+void BenchDecimal() {
+    typedef basic_rational<long long> long_rational;
+    const size_t count = 1 << 18;
+    const size_t digits = 40;
+    for (int limit : {1 << 16, 1 << 30}) {
+        const vector<Operands> operands = GenerateUniform(count, limit, 23);
+        vector<long_rational> values;
+        for (const Operands& pair : operands) {
+            values.push_back(long_rational(pair.a,
+                    static_cast<long long>(pair.b) * pair.b | 1));
+        }
+        const string workload = "digits-40-2^" + to_string(limit == 1 << 16
+                ? 32 : 60);
+        MeasureBatch("decimal-by-digit", workload, count, [&values, digits]() {
+            char buffer[64];
+            long long sum = 0;
+            for (const long_rational& value : values) {
+                sum += FormatDecimalByDigit(buffer, value.numerator(),
+                        value.denominator(), digits) - buffer + buffer[2];
+            }
+            BenchSink = BenchSink + sum;
+        });
+        MeasureBatch("decimal", workload, count, [&values, digits]() {
+            char buffer[64];
+            long long sum = 0;
+            for (const long_rational& value : values) {
+                sum += FormatDecimal(buffer, buffer + sizeof(buffer), value,
+                        digits, rounding_mode::toward_zero).ptr - buffer +
+                        buffer[2];
+            }
+            BenchSink = BenchSink + sum;
+        });
+    }
+    const vector<Operands> small = GenerateUniform(count, 1000, 24);
+    vector<rational> fractions;
+    for (const Operands& pair : small) {
+        fractions.push_back(rational(pair.a, pair.b));
+    }
+    MeasureBatch("repeating-decimal", "denominators-1000", count,
+            [&fractions]() {
+        char buffer[1024];
+        long long sum = 0;
+        for (const rational& value : fractions) {
+            sum += FormatRepeatingDecimal(buffer, buffer + sizeof(buffer),
+                    value).ptr - buffer + buffer[2];
+        }
+        BenchSink = BenchSink + sum;
+    });
+}
+
+/*
+ * Farey sequence of order 2000 (about 1.2 million terms): `std::set` of
+ * all `rational(n, d)` against the recurrence of `ForEachFarey` and its
+ * parallel version.
+ */
+void BenchFarey() {
+    const int order = 2000;
+    const size_t count = static_cast<size_t>(FareyLength(order));
+    const string workload = "order-" + to_string(order);
+    MeasureBatch("farey-set", workload, count, [order]() {
+        set<rational> terms;
+        for (int d = 1; d <= order; d++) {
+            for (int n = 0; n <= d; n++) {
+                terms.insert(rational(n, d));
+            }
+        }
+        BenchSink = BenchSink + terms.size();
+    });
+    MeasureBatch("farey", workload, count, [order]() {
+        long long sum = 0;
+        ForEachFarey(order, [&sum](int n, int d) {
+            sum += n ^ d;
+        });
+        BenchSink = BenchSink + sum;
+    });
+    thread_pool& pool = DefaultThreadPool();
+    MeasureBatch("farey-parallel", workload, count, [order, &pool]() {
+        vector<long long> sums(FareyChunkCount(order, pool));
+        ParallelFarey(order, pool, [&sums](size_t chunk, int n, int d) {
+            sums[chunk] += n ^ d;
+        });
+        long long sum = 0;
+        for (long long chunk_sum : sums) {
+            sum += chunk_sum;
+        }
+        BenchSink = BenchSink + sum;
+    });
+}
+
+/*
+ * Variance of prices (denominator 100) and durations (powers of two):
+ * sums by `operator+=` against `rational_statistics`, serial and by
+ * threads of the default pool. Both compute the variance from sums in
+ * `big_rational`: its denominator grows as `n^2` and does not fit into
+ * `long long`.
+ */
+void BenchStatistics() {
+    typedef basic_rational<long long> long_rational;
+    const size_t count = 1 << 20;
+    for (bool prices : {true, false}) {
+        const vector<Operands> operands =
+                GenerateSmallDenominators(count, prices, 25);
+        vector<long_rational> values;
+        for (const Operands& pair : operands) {
+            values.push_back(long_rational(pair.a, pair.b));
+        }
+        const string workload = prices ? "prices" : "durations";
+        MeasureBatch("eager-variance", workload, count, [&values]() {
+            long_rational sum, squares;
+            for (const long_rational& value : values) {
+                sum += value;
+                squares += value * value;
+            }
+            big_rational correction = sum, variance = squares;
+            big_rational n(static_cast<long long>(values.size()));
+            correction *= sum;
+            correction /= n;
+            variance -= correction;
+            variance /= n;
+            BenchSink = BenchSink + variance.isSmall();
+        });
+        MeasureBatch("statistics", workload, count, [&values]() {
+            rational_statistics<long_rational> statistics =
+                    RationalStatistics(values);
+            BenchSink = BenchSink + statistics.exactVariance().isSmall();
+        });
+        MeasureBatch("statistics-pool", workload, count, [&values]() {
+            rational_statistics<long_rational> statistics =
+                    RationalStatistics(values, DefaultThreadPool());
+            BenchSink = BenchSink + statistics.exactVariance().isSmall();
+        });
+    }
+}
+
+/*
+ * Function writes results of all benchmarks as JSON, so results of two
+ * runs can be compared by tools.
+ */
+void WriteJson(ostream& output) {
+    output << "{\n  \"benchmarks\": [";
+    for (size_t i = 0; i < BenchResults.size(); i++) {
+        const bench_result& result = BenchResults[i];
+        output << (i ? "," : "") << "\n    {\"name\": \"" << result.name
+                << "\", \"workload\": \"" << result.workload
+                << "\", \"operations\": " << result.operations
+                << ", \"samples\": " << result.samples << fixed
+                << setprecision(3) << ", \"ns_per_op\": " << result.mean
+                << ", \"ops_per_second\": " << setprecision(0)
+                << 1e9 / result.mean << setprecision(3)
+                << ", \"p50_ns\": " << result.p50
+                << ", \"p90_ns\": " << result.p90
+                << ", \"p99_ns\": " << result.p99 << "}";
+    }
+    output << "\n  ]\n}\n";
+}
+
+/*
+ * Benchmarks entry point.
+ *
+ * Arguments:
+ * `--json path` - write results as JSON to the file (`-` for stdout).
+ * numbers - numbers of keys for `BenchFlatMap`, by default 10^6.
+ * Example: `bench --json results.json 1000000 10000000`.
+ */
+int main(int argc, char** argv) {
+    vector<size_t> sizes;
+    string json;
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) == "--json" && i + 1 < argc) {
+            json = argv[++i];
+        } else {
+            sizes.push_back(stoull(argv[i]));
+        }
+    }
+    if (sizes.empty()) {
+        sizes.push_back(1000000);
+    }
+    BenchGreatestCommonDivisor();
+    BenchOperators();
+    BenchComparison();
+    BenchRationalArray();
+    BenchReduce();
+    BenchParse();
+    BenchFormat();
+    BenchBinary();
+    BenchMatrix(16);
+    BenchMatrix(32);
+    BenchPolynomial();
+    BenchFloat();
+    BenchExpression();
+    BenchDot();
+    BenchSort();
+    BenchFixedRational();
+    BenchDecimal();
+    BenchFarey();
+    BenchStatistics();
+    for (size_t count : sizes) {
+        BenchFlatMap(count);
+    }
+    if (json == "-") {
+        WriteJson(cout);
+    } else if (!json.empty()) {
+        ofstream output(json);
+        WriteJson(output);
+        if (!output) {
+            cerr << "Error: can not write file `" << json << "`!\n";
+            return 1;
+        }
+    }
+    return 0;
+}
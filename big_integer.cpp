@@ -0,0 +1,533 @@
+#include "big_integer.h"
+#include <algorithm>
+#include <stdexcept>
+
+
+typedef big_integer::limb_type limb_type;
+
+/*
+ * Function compares two magnitudes.
+ * Returns -1, if left is less than right, 0 if equal, 1 if more.
+ */
+static int CompareMagnitude(const std::vector<limb_type>& left,
+        const std::vector<limb_type>& right)
+{
+    if (left.size() != right.size()) {
+        return left.size() < right.size() ? -1 : 1;
+    }
+    for (size_t i = left.size(); i-- > 0;) {
+        if (left[i] != right[i]) {
+            return left[i] < right[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Function multiplies magnitude by `factor` and adds `addend` in place.
+ */
+static void MultiplyAddSmall(std::vector<limb_type>& value, limb_type factor,
+        limb_type addend)
+{
+    std::uint64_t carry = addend;
+    for (limb_type& limb : value) {
+        std::uint64_t product = static_cast<std::uint64_t>(limb) * factor + carry;
+        limb = static_cast<limb_type>(product);
+        carry = product >> 32;
+    }
+    if (carry) {
+        value.push_back(static_cast<limb_type>(carry));
+    }
+}
+
+/*
+ * Function divides magnitude by `divisor` in place.
+ * Returns remainder. Leading zero limbs are removed.
+ */
+static limb_type DivideSmall(std::vector<limb_type>& value, limb_type divisor) {
+    std::uint64_t remainder = 0;
+    for (size_t i = value.size(); i-- > 0;) {
+        std::uint64_t current = (remainder << 32) | value[i];
+        value[i] = static_cast<limb_type>(current / divisor);
+        remainder = current % divisor;
+    }
+    while (!value.empty() && value.back() == 0) {
+        value.pop_back();
+    }
+    return static_cast<limb_type>(remainder);
+}
+
+/*
+ * Function divides magnitude `u` by magnitude `v`, `v` is not zero.
+ *
+ * Knuth's algorithm D (The Art of Computer Programming, vol. 2, 4.3.1)
+ * is used: divisor is normalized, so its leading limb has the highest bit
+ * set, then every quotient limb is estimated from two leading limbs and
+ * corrected at most twice.
+ */
+static void DivideMagnitude(const std::vector<limb_type>& u,
+        const std::vector<limb_type>& v, std::vector<limb_type>& quotient,
+        std::vector<limb_type>& remainder)
+{
+    if (CompareMagnitude(u, v) < 0) {
+        quotient.clear();
+        remainder = u;
+        return;
+    }
+    if (v.size() == 1) {
+        quotient = u;
+        limb_type rest = DivideSmall(quotient, v[0]);
+        remainder.clear();
+        if (rest) {
+            remainder.push_back(rest);
+        }
+        return;
+    }
+    const size_t n = v.size();
+    const size_t m = u.size();
+    const int shift = __builtin_clz(v[n - 1]);
+    // normalize divisor and dividend.
+    std::vector<limb_type> vn(n);
+    std::vector<limb_type> un(m + 1);
+    for (size_t i = n - 1; i > 0; i--) {
+        vn[i] = shift ? (v[i] << shift) | (v[i - 1] >> (32 - shift)) : v[i];
+    }
+    vn[0] = v[0] << shift;
+    un[m] = shift ? u[m - 1] >> (32 - shift) : 0;
+    for (size_t i = m - 1; i > 0; i--) {
+        un[i] = shift ? (u[i] << shift) | (u[i - 1] >> (32 - shift)) : u[i];
+    }
+    un[0] = u[0] << shift;
+
+    const std::uint64_t base = static_cast<std::uint64_t>(1) << 32;
+    quotient.assign(m - n + 1, 0);
+    for (size_t j = m - n + 1; j-- > 0;) {
+        std::uint64_t numerator =
+                (static_cast<std::uint64_t>(un[j + n]) << 32) | un[j + n - 1];
+        std::uint64_t qhat = numerator / vn[n - 1];
+        std::uint64_t rhat = numerator % vn[n - 1];
+        while (qhat >= base ||
+                qhat * vn[n - 2] > ((rhat << 32) | un[j + n - 2])) {
+            qhat--;
+            rhat += vn[n - 1];
+            if (rhat >= base) {
+                break;
+            }
+        }
+        // multiply and subtract.
+        std::int64_t borrow = 0;
+        std::int64_t t = 0;
+        for (size_t i = 0; i < n; i++) {
+            std::uint64_t product = qhat * vn[i];
+            t = static_cast<std::int64_t>(un[i + j]) - borrow -
+                    static_cast<std::int64_t>(product & 0xFFFFFFFF);
+            un[i + j] = static_cast<limb_type>(t);
+            borrow = static_cast<std::int64_t>(product >> 32) - (t >> 32);
+        }
+        t = static_cast<std::int64_t>(un[j + n]) - borrow;
+        un[j + n] = static_cast<limb_type>(t);
+        quotient[j] = static_cast<limb_type>(qhat);
+        // add back, if subtracted too much.
+        if (t < 0) {
+            quotient[j]--;
+            std::uint64_t carry = 0;
+            for (size_t i = 0; i < n; i++) {
+                std::uint64_t sum = static_cast<std::uint64_t>(un[i + j]) +
+                        vn[i] + carry;
+                un[i + j] = static_cast<limb_type>(sum);
+                carry = sum >> 32;
+            }
+            un[j + n] = static_cast<limb_type>(un[j + n] + carry);
+        }
+    }
+    // denormalize remainder.
+    remainder.assign(n, 0);
+    for (size_t i = 0; i < n; i++) {
+        remainder[i] = shift ? (un[i] >> shift) |
+                (static_cast<limb_type>(un[i + 1] << (32 - shift))) : un[i];
+    }
+    while (!quotient.empty() && quotient.back() == 0) {
+        quotient.pop_back();
+    }
+    while (!remainder.empty() && remainder.back() == 0) {
+        remainder.pop_back();
+    }
+}
+
+/*
+ * Constructor class. By default: `value = 0`.
+ * Accepts any integer up to `__int128`.
+ */
+big_integer::big_integer(__int128 value) : negative(value < 0) {
+    unsigned __int128 magnitude = negative
+            ? ~static_cast<unsigned __int128>(value) + 1
+            : static_cast<unsigned __int128>(value);
+    while (magnitude) {
+        limbs.push_back(static_cast<limb_type>(magnitude));
+        magnitude >>= 32;
+    }
+}
+/*
+ * This function returns sign of the value: -1, 0 or 1.
+ */
+int big_integer::sign() const {
+    return limbs.empty() ? 0 : (negative ? -1 : 1);
+}
+/*
+ * This function checks, if value is zero.
+ */
+bool big_integer::isZero() const {
+    return limbs.empty();
+}
+/*
+ * This function converts value to `__int128`.
+ *
+ * Returns `false` and does not change `value`, if the value does not fit.
+ */
+bool big_integer::toInt128(__int128& value) const {
+    if (limbs.size() > 4) {
+        return false;
+    }
+    unsigned __int128 magnitude = 0;
+    for (size_t i = limbs.size(); i-- > 0;) {
+        magnitude = (magnitude << 32) | limbs[i];
+    }
+    const unsigned __int128 limit = static_cast<unsigned __int128>(1) << 127;
+    if (magnitude > limit || (magnitude == limit && !negative)) {
+        return false;
+    }
+    value = negative ? static_cast<__int128>(~magnitude + 1)
+            : static_cast<__int128>(magnitude);
+    return true;
+}
+/*
+ * This function returns value in decimal format.
+ *
+ * Magnitude is divided by 10^9, so nine digits are produced per division.
+ */
+std::string big_integer::toString() const {
+    if (limbs.empty()) {
+        return "0";
+    }
+    std::vector<limb_type> magnitude = limbs;
+    std::string result;
+    while (!magnitude.empty()) {
+        limb_type chunk = DivideSmall(magnitude, 1000000000);
+        for (int i = 0; i < 9; i++) {
+            result.push_back(static_cast<char>('0' + chunk % 10));
+            chunk /= 10;
+            if (magnitude.empty() && chunk == 0) {
+                break;
+            }
+        }
+    }
+    if (negative) {
+        result.push_back('-');
+    }
+    std::reverse(result.begin(), result.end());
+    return result;
+}
+/*
+ * This function parses value in decimal format: optional sign and digits.
+ *
+ * Returns `false` and does not change `value`, if text is not a number.
+ */
+bool big_integer::fromString(const std::string& text, big_integer& value) {
+    size_t position = 0;
+    bool minus = false;
+    if (!text.empty() && (text[0] == '-' || text[0] == '+')) {
+        minus = text[0] == '-';
+        position = 1;
+    }
+    if (position == text.size()) {
+        return false;
+    }
+    big_integer result;
+    while (position < text.size()) {
+        limb_type chunk = 0;
+        limb_type factor = 1;
+        for (int i = 0; i < 9 && position < text.size(); i++, position++) {
+            char c = text[position];
+            if (c < '0' || c > '9') {
+                return false;
+            }
+            chunk = chunk * 10 + static_cast<limb_type>(c - '0');
+            factor *= 10;
+        }
+        MultiplyAddSmall(result.limbs, factor, chunk);
+    }
+    result.trim();
+    result.negative = minus && !result.limbs.empty();
+    value = result;
+    return true;
+}
+/*
+ * This function divides `a` by `b`. Quotient is truncated toward zero,
+ * remainder has the sign of `a`.
+ *
+ * Raises logical error, if `b` is zero.
+ */
+void big_integer::divideModulo(const big_integer& a, const big_integer& b,
+        big_integer& quotient, big_integer& remainder)
+{
+    if (b.isZero()) {
+        throw std::logic_error("Error: division by zero!");
+    }
+    // signs are saved, `quotient` or `remainder` can be the same object
+    // as `a` or `b`.
+    const bool anegative = a.negative;
+    const bool bnegative = b.negative;
+    std::vector<limb_type> q, r;
+    DivideMagnitude(a.limbs, b.limbs, q, r);
+    quotient.limbs.swap(q);
+    quotient.negative = anegative != bnegative && !quotient.limbs.empty();
+    remainder.limbs.swap(r);
+    remainder.negative = anegative && !remainder.limbs.empty();
+}
+/*
+ * This function removes leading zero limbs.
+ */
+void big_integer::trim() {
+    while (!limbs.empty() && limbs.back() == 0) {
+        limbs.pop_back();
+    }
+    if (limbs.empty()) {
+        negative = false;
+    }
+}
+/*
+ * This function adds magnitude to the magnitude of value.
+ */
+void big_integer::addMagnitude(const std::vector<limb_type>& right) {
+    if (limbs.size() < right.size()) {
+        limbs.resize(right.size(), 0);
+    }
+    std::uint64_t carry = 0;
+    for (size_t i = 0; i < limbs.size(); i++) {
+        std::uint64_t sum = static_cast<std::uint64_t>(limbs[i]) + carry +
+                (i < right.size() ? right[i] : 0);
+        limbs[i] = static_cast<limb_type>(sum);
+        carry = sum >> 32;
+        if (!carry && i >= right.size()) {
+            break;
+        }
+    }
+    if (carry) {
+        limbs.push_back(static_cast<limb_type>(carry));
+    }
+}
+/*
+ * This function subtracts magnitude from the magnitude of value.
+ * Magnitude of value must not be less than `right`.
+ */
+void big_integer::subtractMagnitude(const std::vector<limb_type>& right) {
+    std::int64_t borrow = 0;
+    for (size_t i = 0; i < limbs.size(); i++) {
+        std::int64_t difference = static_cast<std::int64_t>(limbs[i]) - borrow -
+                (i < right.size() ? right[i] : 0);
+        borrow = difference < 0;
+        limbs[i] = static_cast<limb_type>(difference);
+        if (!borrow && i >= right.size()) {
+            break;
+        }
+    }
+    trim();
+}
+
+/*
+ * Overload unary `-` operator for big integer class.
+ */
+big_integer big_integer::operator-() const {
+    big_integer result = *this;
+    result.negative = !negative && !limbs.empty();
+    return result;
+}
+
+/*
+ * Overload `+=` operator for big integer class.
+ *
+ * If signs equals, magnitudes are added. Otherwise the smaller magnitude
+ * is subtracted from the larger one, result gets sign of the larger one.
+ */
+big_integer& big_integer::operator+=(const big_integer& right) {
+    if (negative == right.negative || right.limbs.empty()) {
+        addMagnitude(right.limbs);
+    } else if (CompareMagnitude(limbs, right.limbs) >= 0) {
+        subtractMagnitude(right.limbs);
+    } else {
+        big_integer result = right;
+        result.subtractMagnitude(limbs);
+        *this = result;
+    }
+    return *this;
+}
+
+/*
+ * Overload `-=` operator for big integer class.
+ */
+big_integer& big_integer::operator-=(const big_integer& right) {
+    return *this += -right;
+}
+
+/*
+ * Overload `*=` operator for big integer class.
+ *
+ * Schoolbook multiplication with 64-bit intermediate products.
+ */
+big_integer& big_integer::operator*=(const big_integer& right) {
+    if (limbs.empty() || right.limbs.empty()) {
+        *this = big_integer();
+        return *this;
+    }
+    std::vector<limb_type> product(limbs.size() + right.limbs.size(), 0);
+    for (size_t i = 0; i < limbs.size(); i++) {
+        std::uint64_t carry = 0;
+        for (size_t j = 0; j < right.limbs.size(); j++) {
+            std::uint64_t current = static_cast<std::uint64_t>(limbs[i]) *
+                    right.limbs[j] + product[i + j] + carry;
+            product[i + j] = static_cast<limb_type>(current);
+            carry = current >> 32;
+        }
+        product[i + right.limbs.size()] = static_cast<limb_type>(carry);
+    }
+    limbs.swap(product);
+    negative = negative != right.negative;
+    trim();
+    return *this;
+}
+
+/*
+ * Overload `/=` operator for big integer class. Truncating division.
+ */
+big_integer& big_integer::operator/=(const big_integer& right) {
+    big_integer remainder;
+    divideModulo(*this, right, *this, remainder);
+    return *this;
+}
+
+/*
+ * Overload `%=` operator for big integer class.
+ * Remainder has the sign of left operand.
+ */
+big_integer& big_integer::operator%=(const big_integer& right) {
+    big_integer quotient;
+    divideModulo(*this, right, quotient, *this);
+    return *this;
+}
+
+big_integer operator+(big_integer left, const big_integer& right) {
+    return left += right;
+}
+
+big_integer operator-(big_integer left, const big_integer& right) {
+    return left -= right;
+}
+
+big_integer operator*(const big_integer& left, const big_integer& right) {
+    big_integer result = left;
+    result *= right;
+    return result;
+}
+
+big_integer operator/(const big_integer& left, const big_integer& right) {
+    big_integer quotient, remainder;
+    big_integer::divideModulo(left, right, quotient, remainder);
+    return quotient;
+}
+
+big_integer operator%(const big_integer& left, const big_integer& right) {
+    big_integer quotient, remainder;
+    big_integer::divideModulo(left, right, quotient, remainder);
+    return remainder;
+}
+
+/*
+ * Overload `==` operator for big integer class.
+ */
+bool operator==(const big_integer& left, const big_integer& right) {
+    return left.negative == right.negative && left.limbs == right.limbs;
+}
+
+/*
+ * Overload `<` operator for big integer class.
+ */
+bool operator<(const big_integer& left, const big_integer& right) {
+    if (left.negative != right.negative) {
+        return left.negative;
+    }
+    int compare = CompareMagnitude(left.limbs, right.limbs);
+    return left.negative ? compare > 0 : compare < 0;
+}
+
+bool operator!=(const big_integer& left, const big_integer& right) {
+    return !(left == right);
+}
+
+bool operator>(const big_integer& left, const big_integer& right) {
+    return right < left;
+}
+
+bool operator<=(const big_integer& left, const big_integer& right) {
+    return !(right < left);
+}
+
+bool operator>=(const big_integer& left, const big_integer& right) {
+    return !(left < right);
+}
+
+/*
+ * The function returns the greatest common divisor of two big integers.
+ *
+ * Euclid's algorithm is used, every step is one `divideModulo`.
+ */
+big_integer GreatestCommonDivisor(big_integer p, big_integer q) {
+    if (p.sign() < 0) {
+        p = -p;
+    }
+    if (q.sign() < 0) {
+        q = -q;
+    }
+    while (!q.isZero()) {
+        big_integer t = p % q;
+        p = q;
+        q = t;
+    }
+    return p;
+}
+
+/*
+ * Overload `>>` operator for big integer class.
+ *
+ * Skips leading whitespaces, reads optional sign and digits.
+ * Sets `failbit`, if there are no digits.
+ */
+std::istream& operator>>(std::istream& stream, big_integer& value) {
+    std::istream::sentry sentry(stream);
+    if (!sentry) {
+        return stream;
+    }
+    std::string text;
+    int c = stream.peek();
+    if (c == '-' || c == '+') {
+        text.push_back(static_cast<char>(stream.get()));
+        c = stream.peek();
+    }
+    while (c >= '0' && c <= '9') {
+        text.push_back(static_cast<char>(stream.get()));
+        c = stream.peek();
+    }
+    if (c == std::char_traits<char>::eof()) {
+        stream.setstate(std::ios_base::eofbit);
+    }
+    if (!big_integer::fromString(text, value)) {
+        stream.setstate(std::ios_base::failbit);
+    }
+    return stream;
+}
+
+/*
+ * Overload `<<` operator for big integer class.
+ */
+std::ostream& operator<<(std::ostream& stream, const big_integer& value) {
+    return stream << value.toString();
+}
@@ -0,0 +1,106 @@
+#ifndef BIG_INTEGER_H
+#define BIG_INTEGER_H
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/*
+ * Class big_integer. Signed integer of arbitrary precision.
+ *
+ * Stores sign and magnitude. Magnitude is a vector of 32-bit limbs, least
+ * significant limb first, without leading zero limbs. Zero has no limbs,
+ * so small values do not allocate memory until they grow.
+ *
+ * Public:
+ * 1. `big_integer(value)` - class initializer. By default `value = 0`.
+ * 2. `sign()` - return -1, 0 or 1.
+ * 3. `isZero()` - check if value is zero.
+ * 4. `toInt128(value)` - convert to `__int128`, returns `false` if value
+ * does not fit.
+ * 5. `toString()` - return value in decimal format.
+ * 6. `fromString(text, value)` - parse value in decimal format, returns
+ * `false` if text is not a number.
+ * 7. `divideModulo(a, b, quotient, remainder)` - truncating division.
+ *
+ * Also operators: `+`, `-`, `*`, `/`, `%`, `+=`, `-=`, `*=`, `/=`, `%=`,
+ * unary `-`, comparison operators and `>>`, `<<`.
+ *
+ * Private:
+ * 1. `negative` - sign of the value.
+ * 2. `limbs` - magnitude of the value.
+ * 3. `trim` - remove leading zero limbs.
+ */
+class big_integer {
+public:
+    typedef std::uint32_t limb_type;
+
+    big_integer(__int128 value = 0);
+
+    int sign() const;
+    bool isZero() const;
+    bool toInt128(__int128& value) const;
+    std::string toString() const;
+    static bool fromString(const std::string& text, big_integer& value);
+    static void divideModulo(const big_integer& a, const big_integer& b,
+            big_integer& quotient, big_integer& remainder);
+
+    big_integer operator-() const;
+    big_integer& operator+=(const big_integer& right);
+    big_integer& operator-=(const big_integer& right);
+    big_integer& operator*=(const big_integer& right);
+    big_integer& operator/=(const big_integer& right);
+    big_integer& operator%=(const big_integer& right);
+
+    friend bool operator==(const big_integer& left, const big_integer& right);
+    friend bool operator<(const big_integer& left, const big_integer& right);
+
+private:
+    bool negative;
+    std::vector<limb_type> limbs;
+
+    void trim();
+    void addMagnitude(const std::vector<limb_type>& right);
+    void subtractMagnitude(const std::vector<limb_type>& right);
+};
+
+/*
+ * Operators:
+ * `+` - addition two big integers.
+ * `-` - subtraction two big integers.
+ * `*` - multiplication two big integers.
+ * `/` - truncating division two big integers.
+ * `%` - remainder of truncating division, has the sign of left operand.
+ */
+big_integer operator+(big_integer left, const big_integer& right);
+big_integer operator-(big_integer left, const big_integer& right);
+big_integer operator*(const big_integer& left, const big_integer& right);
+big_integer operator/(const big_integer& left, const big_integer& right);
+big_integer operator%(const big_integer& left, const big_integer& right);
+
+/*
+ * Comparison operators.
+ */
+bool operator!=(const big_integer& left, const big_integer& right);
+bool operator>(const big_integer& left, const big_integer& right);
+bool operator<=(const big_integer& left, const big_integer& right);
+bool operator>=(const big_integer& left, const big_integer& right);
+
+/*
+ * Function returns greatest common divisor of two big integers.
+ * Sign of the numbers is ignored, result is not negative.
+ *
+ * Overload of `GreatestCommonDivisor` from `utils.h`, so the kernels from
+ * `arithmetic.h` work with big integers.
+ */
+big_integer GreatestCommonDivisor(big_integer p, big_integer q);
+
+/*
+ * Input/Output operators in decimal format.
+ */
+std::istream& operator>>(std::istream& stream, big_integer& value);
+std::ostream& operator<<(std::ostream& stream, const big_integer& value);
+
+#endif /* BIG_INTEGER_H */
@@ -0,0 +1,317 @@
+#include "big_rational.h"
+#include "arithmetic.h"
+
+
+/*
+ * Exact arithmetic of big integers for the kernels from `arithmetic.h`.
+ * Big integers can not overflow, so `overflow` flag is never set.
+ */
+struct exact_arithmetic {
+    bool overflow = false;
+
+    big_integer add(const big_integer& a, const big_integer& b) {
+        return a + b;
+    }
+    big_integer sub(const big_integer& a, const big_integer& b) {
+        return a - b;
+    }
+    big_integer mul(const big_integer& a, const big_integer& b) {
+        return a * b;
+    }
+    big_integer neg(const big_integer& a) {
+        return -a;
+    }
+};
+
+/*
+ * Constructor class. By default: `num = 0`, `deno = 1`.
+ * Like `rational`, zero numerator gives `0/1` (also with zero
+ * denominator), otherwise raises logical error, if denominator is zero.
+ *
+ * Value is normalized inline. Only `LLONG_MIN` with negative denominator
+ * does not fit and is stored as big value.
+ */
+big_rational::big_rational(long long num, long long deno)
+    : small_numerator(0), small_denominator(1)
+{
+    if (num == 0) {
+        return;
+    }
+    if (deno == 0) {
+        RaiseZeroDenominatorError();
+    }
+    checked_arithmetic<long long> arithmetic;
+    NormalizeRational(arithmetic, num, deno, small_numerator, small_denominator);
+    if (arithmetic.overflow) {
+        setRational(big_integer(num), big_integer(deno));
+    }
+}
+/*
+ * Constructor from big integers. Zero denominator is handled like in the
+ * constructor above.
+ */
+big_rational::big_rational(const big_integer& num, const big_integer& deno)
+    : small_numerator(0), small_denominator(1)
+{
+    setRational(num, deno);
+}
+/*
+ * Copy constructor. Heap value is copied, inline value is not allocated.
+ */
+big_rational::big_rational(const big_rational& other)
+    : small_numerator(other.small_numerator),
+      small_denominator(other.small_denominator),
+      big(other.big ? new big_parts(*other.big) : nullptr)
+{
+}
+/*
+ * Copy assignment.
+ */
+big_rational& big_rational::operator=(const big_rational& other) {
+    if (this != &other) {
+        small_numerator = other.small_numerator;
+        small_denominator = other.small_denominator;
+        big.reset(other.big ? new big_parts(*other.big) : nullptr);
+    }
+    return *this;
+}
+/*
+ * This function returns numerator value.
+ */
+big_integer big_rational::numerator() const {
+    return big ? big->numerator : big_integer(small_numerator);
+}
+/*
+ * This function returns denominator value.
+ */
+big_integer big_rational::denominator() const {
+    return big ? big->denominator : big_integer(small_denominator);
+}
+/*
+ * This function change numerator and denominator.
+ *
+ * Zero numerator gives `0/1`, otherwise raises logical error, if
+ * denominator is zero.
+ */
+void big_rational::setRational(const big_integer& num, const big_integer& deno) {
+    if (num.isZero()) {
+        assignBig(big_integer(0), big_integer(1));
+        return;
+    }
+    if (deno.isZero()) {
+        RaiseZeroDenominatorError();
+    }
+    exact_arithmetic arithmetic;
+    big_integer n, d;
+    NormalizeRational(arithmetic, num, deno, n, d);
+    assignBig(n, d);
+}
+/*
+ * This function checks, if value is stored inline.
+ */
+bool big_rational::isSmall() const {
+    return !big;
+}
+/*
+ * This function sets normalized value.
+ *
+ * If numerator and denominator fit into `long long`, value is moved inline
+ * and heap memory is released.
+ */
+void big_rational::assignBig(const big_integer& num, const big_integer& deno) {
+    __int128 n = 0, d = 1;
+    if (num.toInt128(n) && deno.toInt128(d) &&
+            n >= integer_traits<long long>::min() &&
+            n <= integer_traits<long long>::max() &&
+            d <= integer_traits<long long>::max()) {
+        small_numerator = static_cast<long long>(n);
+        small_denominator = static_cast<long long>(d);
+        big.reset();
+        return;
+    }
+    if (big) {
+        big->numerator = num;
+        big->denominator = deno;
+    } else {
+        big.reset(new big_parts{num, deno});
+    }
+}
+/*
+ * This function runs operation.
+ *
+ * If both values are inline, operation runs with `checked_arithmetic` on
+ * `long long`. If it does not overflow, result stays inline. Otherwise
+ * operation is repeated with big integers.
+ */
+template<typename Operation>
+void big_rational::applyRational(Operation operation,
+        const big_rational& right) {
+    if (!big && !right.big) {
+        checked_arithmetic<long long> arithmetic;
+        long long n = 0, d = 1;
+        operation(arithmetic, small_numerator, small_denominator,
+                right.small_numerator, right.small_denominator, n, d);
+        if (!arithmetic.overflow) {
+            small_numerator = n;
+            small_denominator = d;
+            return;
+        }
+    }
+    exact_arithmetic arithmetic;
+    big_integer n, d;
+    operation(arithmetic, numerator(), denominator(), right.numerator(),
+            right.denominator(), n, d);
+    assignBig(n, d);
+}
+
+/*
+ * Overload `+=` operator for big rational class.
+ * Same algorithm as for `rational` (see `AddRational`).
+ */
+void big_rational::operator+=(const big_rational& right) {
+    applyRational(add_operation(), right);
+}
+
+/*
+ * Overload `-=` operator for big rational class.
+ */
+void big_rational::operator-=(const big_rational& right) {
+    applyRational(subtract_operation(), right);
+}
+
+/*
+ * Overload `*=` operator for big rational class.
+ * Same algorithm as for `rational` (see `MultiplyRational`).
+ */
+void big_rational::operator*=(const big_rational& right) {
+    applyRational(multiply_operation(), right);
+}
+
+/*
+ * Overload `/=` operator for big rational class.
+ * Raises logical error, if right rational is zero.
+ */
+void big_rational::operator/=(const big_rational& right) {
+    if (!static_cast<bool>(right)) {
+        RaiseZeroDenominatorError();
+    }
+    applyRational(divide_operation(), right);
+}
+
+/*
+ * Conversion to bool, `true` if value is not zero.
+ */
+big_rational::operator bool() const {
+    return big || small_numerator != 0;
+}
+
+/*
+ * Overload `==` operator for big rational class.
+ *
+ * Values are normalized and stored inline whenever they fit, so equal
+ * values have equal fields.
+ */
+bool operator==(const big_rational& left, const big_rational& right) {
+    if (!left.big && !right.big) {
+        return left.small_numerator == right.small_numerator &&
+                left.small_denominator == right.small_denominator;
+    }
+    if (left.big && right.big) {
+        return left.big->numerator == right.big->numerator &&
+                left.big->denominator == right.big->denominator;
+    }
+    return false;
+}
+
+/*
+ * Overload `<` operator for big rational class.
+ *
+ * Cross multiplication: `n1 * d2 < n2 * d1`. Inline values are
+ * multiplied in `__int128`, which can not overflow.
+ */
+bool operator<(const big_rational& left, const big_rational& right) {
+    if (!left.big && !right.big) {
+        return static_cast<__int128>(left.small_numerator) *
+                right.small_denominator <
+                static_cast<__int128>(right.small_numerator) *
+                left.small_denominator;
+    }
+    return left.numerator() * right.denominator() <
+            right.numerator() * left.denominator();
+}
+
+bool operator!=(const big_rational& left, const big_rational& right) {
+    return !(left == right);
+}
+
+/*
+ * Overload `!` operator, same meaning as for `rational`:
+ * returns `false` for zero.
+ */
+bool operator!(const big_rational& right) {
+    return static_cast<bool>(right);
+}
+
+bool operator>(const big_rational& left, const big_rational& right) {
+    return right < left;
+}
+
+bool operator<=(const big_rational& left, const big_rational& right) {
+    return !(right < left);
+}
+
+bool operator>=(const big_rational& left, const big_rational& right) {
+    return !(left < right);
+}
+
+big_rational operator+(big_rational left, const big_rational& right) {
+    left += right;
+    return left;
+}
+
+big_rational operator-(big_rational left, const big_rational& right) {
+    left -= right;
+    return left;
+}
+
+big_rational operator*(big_rational left, const big_rational& right) {
+    left *= right;
+    return left;
+}
+
+big_rational operator/(big_rational left, const big_rational& right) {
+    left /= right;
+    return left;
+}
+
+/*
+ * Overload `>>` operator for big rational class.
+ *
+ * Input rational must be: `n/d`, with `/` separator.
+ * Calls `setRational` function if istream not failed.
+ */
+std::istream& operator>>(std::istream& stream, big_rational& rational) {
+    big_integer numerator, denominator;
+    stream >> numerator;
+    // ignore separator.
+    stream.ignore(1);
+    stream >> denominator;
+    if (!stream.fail()) {
+        rational.setRational(numerator, denominator);
+    }
+    return stream;
+}
+
+/*
+ * Overload `<<` operator for big rational class.
+ *
+ * Output rational in the format: `n/d`.
+ */
+std::ostream& operator<<(std::ostream& stream, const big_rational& rational) {
+    if (rational.big) {
+        return stream << rational.big->numerator << "/"
+                << rational.big->denominator;
+    }
+    return stream << rational.small_numerator << "/"
+            << rational.small_denominator;
+}
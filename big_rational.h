@@ -0,0 +1,154 @@
+#ifndef BIG_RATIONAL_H
+#define BIG_RATIONAL_H
+
+#include "big_integer.h"
+#include "rational.h"
+#include <istream>
+#include <memory>
+#include <ostream>
+
+/*
+ * Class big_rational. Rational number of arbitrary precision.
+ *
+ * Small-value optimization: while numerator and denominator fit into
+ * `long long`, they are stored inline and operations use the checked
+ * kernels of `basic_rational<long long>`, without heap allocation.
+ * Only values, which overflow, are moved to heap as `big_integer`, and
+ * they are moved back inline, when reduction makes them small again.
+ *
+ * Public:
+ * 1. `big_rational(num, deno)` - class initializer. By default `num = 0`,
+ * `deno = 1`. Also can be created from `big_integer` values or from any
+ * `basic_rational` (implicitly, so operators of `rational` work).
+ * 2. `numerator()` - return numerator value.
+ * 3. `denominator()` - return denominator value.
+ * 4. `setRational(num, deno)` - set new numerator and denominator values.
+ * 5. `isSmall()` - check, if value is stored inline.
+ * 6. `toRational(value)` - convert to `basic_rational`, returns `false`
+ * if value does not fit.
+ *
+ * Also operators: `+=`, `-=`, `*=`, `/=` .
+ *
+ * Private:
+ * 1. `small_numerator`, `small_denominator` - inline value.
+ * 2. `big` - heap value, `nullptr` for inline value.
+ * 3. `assignBig` - set normalized value, move it inline if it fits.
+ * 4. `applyRational` - run operation inline or with big integers.
+ */
+class big_rational {
+public:
+    big_rational(long long num = 0, long long deno = 1);
+    big_rational(const big_integer& num, const big_integer& deno);
+    template<typename T, typename OverflowPolicy>
+    big_rational(const basic_rational<T, OverflowPolicy>& value);
+    big_rational(const big_rational& other);
+    big_rational(big_rational&& other) noexcept = default;
+    big_rational& operator=(const big_rational& other);
+    big_rational& operator=(big_rational&& other) noexcept = default;
+
+    big_integer numerator() const;
+    big_integer denominator() const;
+    void setRational(const big_integer& num, const big_integer& deno);
+    bool isSmall() const;
+    template<typename T, typename OverflowPolicy>
+    bool toRational(basic_rational<T, OverflowPolicy>& value) const;
+
+    void operator+=(const big_rational& right);
+    void operator-=(const big_rational& right);
+    void operator*=(const big_rational& right);
+    void operator/=(const big_rational& right);
+
+    explicit operator bool() const;
+
+    friend bool operator==(const big_rational& left, const big_rational& right);
+    friend bool operator<(const big_rational& left, const big_rational& right);
+    friend std::ostream& operator<<(std::ostream& stream,
+            const big_rational& rational);
+
+private:
+    struct big_parts {
+        big_integer numerator;
+        big_integer denominator;
+    };
+
+    long long small_numerator;
+    long long small_denominator;
+    std::unique_ptr<big_parts> big;
+
+    void assignBig(const big_integer& num, const big_integer& deno);
+    template<typename Operation>
+    void applyRational(Operation operation, const big_rational& right);
+};
+
+/*
+ * Constructor from `basic_rational` of any width.
+ * Value is stored inline, if it fits into `long long`.
+ */
+template<typename T, typename OverflowPolicy>
+big_rational::big_rational(const basic_rational<T, OverflowPolicy>& value)
+    : small_numerator(0), small_denominator(1)
+{
+    __int128 num = value.numerator();
+    __int128 deno = value.denominator();
+    if (num >= integer_traits<long long>::min() &&
+            num <= integer_traits<long long>::max() &&
+            deno <= integer_traits<long long>::max()) {
+        small_numerator = static_cast<long long>(num);
+        small_denominator = static_cast<long long>(deno);
+    } else {
+        assignBig(big_integer(num), big_integer(deno));
+    }
+}
+
+/*
+ * This function converts value to `basic_rational`.
+ *
+ * Returns `false` and does not change `value`, if numerator or
+ * denominator does not fit into `T`.
+ */
+template<typename T, typename OverflowPolicy>
+bool big_rational::toRational(basic_rational<T, OverflowPolicy>& value) const {
+    __int128 num = small_numerator;
+    __int128 deno = small_denominator;
+    if (big && (!big->numerator.toInt128(num) ||
+            !big->denominator.toInt128(deno))) {
+        return false;
+    }
+    if (num < integer_traits<T>::min() || num > integer_traits<T>::max() ||
+            deno > integer_traits<T>::max()) {
+        return false;
+    }
+    value.setRational(static_cast<T>(num), static_cast<T>(deno));
+    return true;
+}
+
+/*
+ * Operators:
+ * `!=` - check if two rational objects are not equal.
+ * `!` - check if not rational object, same as for `rational`.
+ * `>`, `<=`, `>=` - comparison of two rational objects.
+ */
+bool operator!=(const big_rational& left, const big_rational& right);
+bool operator!(const big_rational& right);
+bool operator>(const big_rational& left, const big_rational& right);
+bool operator<=(const big_rational& left, const big_rational& right);
+bool operator>=(const big_rational& left, const big_rational& right);
+
+/*
+ * Operators:
+ * `+` - addition two rational objects.
+ * `-` - subtraction two rational objects.
+ * `*` - multiplication two rational objects.
+ * `/` - division two rational objects.
+ */
+big_rational operator+(big_rational left, const big_rational& right);
+big_rational operator-(big_rational left, const big_rational& right);
+big_rational operator*(big_rational left, const big_rational& right);
+big_rational operator/(big_rational left, const big_rational& right);
+
+/*
+ * Input operator, reads rational in the format `n/d`.
+ */
+std::istream& operator>>(std::istream& stream, big_rational& rational);
+
+#endif /* BIG_RATIONAL_H */
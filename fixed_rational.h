@@ -0,0 +1,306 @@
+#ifndef FIXED_RATIONAL_H
+#define FIXED_RATIONAL_H
+
+#include "rational.h"
+#include "arithmetic.h"
+#include "utils.h"
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+
+/*
+ * Function divides `n` by `d` (`d != 0`) and rounds the quotient to the
+ * nearest integer, ties to even (banker's rounding), so rounding errors
+ * of many operations do not accumulate in one direction. The remainder
+ * is compared with `|d| - |remainder|`, so nothing is doubled. `n / d`
+ * and `|d|` must fit into `W`.
+ */
+template<typename W>
+constexpr W RoundedQuotient(W n, W d) {
+    W quotient = n / d;
+    W remainder = n % d;
+    if (remainder == 0) {
+        return quotient;
+    }
+    W half = AbsoluteValue(remainder);
+    W rest = AbsoluteValue(d) - half;
+    if (half > rest || (half == rest && quotient % 2 != 0)) {
+        quotient += (n < 0) != (d < 0) ? -1 : 1;
+    }
+    return quotient;
+}
+
+/*
+ * Class fixed_rational. Header-only, all operations are `constexpr`.
+ * Rational with fixed denominator: value is `ticks / Den`, for example
+ * cents (`Den = 100`) or microseconds (`Den = 1000000`).
+ *
+ * Addition and subtraction add ticks, multiplication and division are
+ * computed in the wider type and rescaled once by `Den`, so there is no
+ * GCD and no common denominator. Product and quotient are rounded to the
+ * nearest tick, ties to even. Raises overflow error, if the result does
+ * not fit into `T`, and logical error on division by zero.
+ *
+ * Conversion to `basic_rational<T>` is implicit and exact, so existing
+ * operators of `basic_rational` (comparison, arithmetic) accept
+ * `fixed_rational` too. Conversion from `basic_rational` is explicit and
+ * raises logical error, if the value is not a multiple of `1/Den`.
+ *
+ * Template parameter `Den` - denominator, positive.
+ * Template parameter `T` - integer type of ticks, which has a wider type
+ * (`int`, `long` or `long long`).
+ *
+ * Public:
+ * 1. `fixed_rational(integer)` - class initializer, by default 0. Also
+ * can be created from `basic_rational`.
+ * 2. `fromTicks(ticks)` - return value `ticks / Den`.
+ * 3. `ticks()` - return number of ticks.
+ * 4. `denominator()` - return `Den`.
+ * 5. `toRational()` - return value as `basic_rational<T>`, also implicit
+ * conversion.
+ *
+ * Also operators: `+=`, `-=`, `*=`, `/=`, `+`, `-`, `*`, `/`, `==`, `!=`,
+ * `<`, `<=`, `>`, `>=`, `<<`, `>>`.
+ *
+ * Private:
+ * 1. `tick_value` - number of ticks.
+ */
+template<long long Den, typename T = long long>
+class fixed_rational {
+public:
+    typedef T value_type;
+    typedef typename integer_traits<T>::wider_type wider_type;
+
+    static_assert(Den > 0, "denominator of fixed_rational must be positive");
+    static_assert(Den <= integer_traits<T>::max(),
+            "denominator of fixed_rational must fit into T");
+    static_assert(!std::is_void<wider_type>::value,
+            "fixed_rational needs a wider integer type");
+
+    constexpr fixed_rational(T integer = 0);
+    template<typename U, typename OverflowPolicy>
+    constexpr explicit fixed_rational(
+            const basic_rational<U, OverflowPolicy>& value);
+
+    static constexpr fixed_rational fromTicks(T ticks) {
+        fixed_rational result;
+        result.tick_value = ticks;
+        return result;
+    }
+    constexpr T ticks() const {
+        return tick_value;
+    }
+    static constexpr T denominator() {
+        return static_cast<T>(Den);
+    }
+    constexpr basic_rational<T> toRational() const {
+        return basic_rational<T>(tick_value, static_cast<T>(Den));
+    }
+
+    template<typename OverflowPolicy>
+    constexpr operator basic_rational<T, OverflowPolicy>() const {
+        return basic_rational<T, OverflowPolicy>(tick_value,
+                static_cast<T>(Den));
+    }
+    constexpr explicit operator bool() const {
+        return tick_value != 0;
+    }
+
+    constexpr void operator+=(const fixed_rational& right);
+    constexpr void operator-=(const fixed_rational& right);
+    constexpr void operator*=(const fixed_rational& right);
+    constexpr void operator/=(const fixed_rational& right);
+
+    /*
+     * Operators `+`, `-`, `*`, `/` of two fixed rationals.
+     */
+    friend constexpr fixed_rational operator+(const fixed_rational& left,
+            const fixed_rational& right) {
+        fixed_rational result = left;
+        result += right;
+        return result;
+    }
+    friend constexpr fixed_rational operator-(const fixed_rational& left,
+            const fixed_rational& right) {
+        fixed_rational result = left;
+        result -= right;
+        return result;
+    }
+    friend constexpr fixed_rational operator*(const fixed_rational& left,
+            const fixed_rational& right) {
+        fixed_rational result = left;
+        result *= right;
+        return result;
+    }
+    friend constexpr fixed_rational operator/(const fixed_rational& left,
+            const fixed_rational& right) {
+        fixed_rational result = left;
+        result /= right;
+        return result;
+    }
+
+    /*
+     * Comparison operators of two fixed rationals compare ticks.
+     * Comparison with `basic_rational` uses its operators.
+     */
+    friend constexpr bool operator==(const fixed_rational& left,
+            const fixed_rational& right) {
+        return left.tick_value == right.tick_value;
+    }
+    friend constexpr bool operator!=(const fixed_rational& left,
+            const fixed_rational& right) {
+        return left.tick_value != right.tick_value;
+    }
+    friend constexpr bool operator<(const fixed_rational& left,
+            const fixed_rational& right) {
+        return left.tick_value < right.tick_value;
+    }
+    friend constexpr bool operator<=(const fixed_rational& left,
+            const fixed_rational& right) {
+        return left.tick_value <= right.tick_value;
+    }
+    friend constexpr bool operator>(const fixed_rational& left,
+            const fixed_rational& right) {
+        return left.tick_value > right.tick_value;
+    }
+    friend constexpr bool operator>=(const fixed_rational& left,
+            const fixed_rational& right) {
+        return left.tick_value >= right.tick_value;
+    }
+
+private:
+    T tick_value;
+
+    static constexpr T narrow(__int128 value);
+    static constexpr T rescale(wider_type n, wider_type d);
+};
+
+/*
+ * This function narrows ticks, computed in a wider type, raises overflow
+ * error, if they do not fit into `T`.
+ */
+template<long long Den, typename T>
+constexpr T fixed_rational<Den, T>::narrow(__int128 value) {
+    if (value < integer_traits<T>::min() || value > integer_traits<T>::max()) {
+        RaiseOverflowError();
+    }
+    return static_cast<T>(value);
+}
+
+/*
+ * This function returns `round(n / d)` as ticks. If `n` fits into
+ * `long long`, the division is done in `long long`: division of
+ * `__int128` is a library call, while division by constant `Den` of
+ * `long long` is a multiplication. `d == -1` and `d == LLONG_MIN` go to
+ * the wider type, where `LLONG_MIN / -1` and `|d|` fit.
+ */
+template<long long Den, typename T>
+constexpr T fixed_rational<Den, T>::rescale(wider_type n, wider_type d) {
+    if (n >= integer_traits<long long>::min() &&
+            n <= integer_traits<long long>::max() &&
+            d > integer_traits<long long>::min() &&
+            d <= integer_traits<long long>::max() && d != -1) {
+        return narrow(RoundedQuotient(static_cast<long long>(n),
+                static_cast<long long>(d)));
+    }
+    return narrow(RoundedQuotient(n, d));
+}
+
+template<long long Den, typename T>
+constexpr fixed_rational<Den, T>::fixed_rational(T integer)
+    : tick_value(narrow(static_cast<wider_type>(integer) * Den)) {}
+
+/*
+ * Conversion from `n/d` of every type up to `long long` is exact: `d`
+ * must divide `Den`, then `ticks = n * (Den / d)`, computed in
+ * `__int128`.
+ */
+template<long long Den, typename T>
+template<typename U, typename OverflowPolicy>
+constexpr fixed_rational<Den, T>::fixed_rational(
+        const basic_rational<U, OverflowPolicy>& value)
+    : tick_value(0)
+{
+    static_assert(sizeof(U) <= sizeof(long long),
+            "rational types up to long long can be converted");
+    if (Den % value.denominator() != 0) {
+        throw std::logic_error(
+                "Error: rational is not a multiple of fixed denominator!");
+    }
+    tick_value = narrow(static_cast<__int128>(value.numerator()) *
+            (Den / value.denominator()));
+}
+
+/*
+ * Overload `+=` and `-=` operators: ticks are added, no rescale.
+ */
+template<long long Den, typename T>
+constexpr void fixed_rational<Den, T>::operator+=(const fixed_rational& right) {
+    checked_arithmetic<T> arithmetic;
+    T sum = arithmetic.add(tick_value, right.tick_value);
+    if (arithmetic.overflow) {
+        RaiseOverflowError();
+    }
+    tick_value = sum;
+}
+
+template<long long Den, typename T>
+constexpr void fixed_rational<Den, T>::operator-=(const fixed_rational& right) {
+    checked_arithmetic<T> arithmetic;
+    T difference = arithmetic.sub(tick_value, right.tick_value);
+    if (arithmetic.overflow) {
+        RaiseOverflowError();
+    }
+    tick_value = difference;
+}
+
+/*
+ * Overload `*=` operator: `ticks = round(a * b / Den)`, the product is
+ * computed in the wider type.
+ */
+template<long long Den, typename T>
+constexpr void fixed_rational<Den, T>::operator*=(const fixed_rational& right) {
+    tick_value = rescale(static_cast<wider_type>(tick_value) *
+            right.tick_value, static_cast<wider_type>(Den));
+}
+
+/*
+ * Overload `/=` operator: `ticks = round(a * Den / b)`. Raises logical
+ * error, if `right` is zero.
+ */
+template<long long Den, typename T>
+constexpr void fixed_rational<Den, T>::operator/=(const fixed_rational& right) {
+    if (right.tick_value == 0) {
+        RaiseZeroDenominatorError();
+    }
+    tick_value = rescale(static_cast<wider_type>(tick_value) * Den,
+            static_cast<wider_type>(right.tick_value));
+}
+
+/*
+ * Overload `>>` operator: reads rational `n/d` and converts it exactly.
+ */
+template<long long Den, typename T>
+std::istream& operator>>(std::istream& stream, fixed_rational<Den, T>& value)
+{
+    basic_rational<T> rational;
+    stream >> rational;
+    if (!stream.fail()) {
+        value = fixed_rational<Den, T>(rational);
+    }
+    return stream;
+}
+
+/*
+ * Overload `<<` operator: output in the format of `basic_rational`,
+ * `n/d` reduced.
+ */
+template<long long Den, typename T>
+std::ostream& operator<<(std::ostream& stream,
+        const fixed_rational<Den, T>& value)
+{
+    return stream << value.toRational();
+}
+
+#endif /* FIXED_RATIONAL_H */
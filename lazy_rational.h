@@ -0,0 +1,375 @@
+#ifndef LAZY_RATIONAL_H
+#define LAZY_RATIONAL_H
+
+#include "rational.h"
+#include "arithmetic.h"
+#include <ostream>
+#include <stdexcept>
+
+/*
+ * Function adds (or subtracts, if `Subtract` is true) two rationals
+ * without reduction. Denominators must be positive, result denominator
+ * is positive.
+ *
+ * If one denominator divides the other, the larger one is used as common
+ * denominator (one `%` instead of GCD). Otherwise denominators are
+ * multiplied.
+ */
+template<bool Subtract, typename Arithmetic, typename T>
+constexpr void LazyAddRational(Arithmetic& arithmetic, T n1, T d1, T n2,
+        T d2, T& n, T& d)
+{
+    T left = n1;
+    T right = n2;
+    d = d1;
+    if (d1 != d2) {
+        if (d1 > d2 && d1 % d2 == 0) {
+            right = arithmetic.mul(n2, d1 / d2);
+        } else if (d2 > d1 && d2 % d1 == 0) {
+            left = arithmetic.mul(n1, d2 / d1);
+            d = d2;
+        } else {
+            left = arithmetic.mul(n1, d2);
+            right = arithmetic.mul(n2, d1);
+            d = arithmetic.mul(d1, d2);
+        }
+    }
+    n = Subtract ? arithmetic.sub(left, right) : arithmetic.add(left, right);
+}
+
+/*
+ * Function multiplies two rationals without reduction.
+ */
+template<typename Arithmetic, typename T>
+constexpr void LazyMultiplyRational(Arithmetic& arithmetic, T n1, T d1, T n2,
+        T d2, T& n, T& d)
+{
+    n = arithmetic.mul(n1, n2);
+    d = arithmetic.mul(d1, d2);
+}
+
+/*
+ * Function divides two rationals without reduction. Numerator `n2` must
+ * be different from zero. Sign is moved to the numerator.
+ */
+template<typename Arithmetic, typename T>
+constexpr void LazyDivideRational(Arithmetic& arithmetic, T n1, T d1, T n2,
+        T d2, T& n, T& d)
+{
+    n = arithmetic.mul(n1, d2);
+    d = arithmetic.mul(d1, n2);
+    if (d < 0) {
+        n = arithmetic.neg(n);
+        d = arithmetic.neg(d);
+    }
+}
+
+/*
+ * Lazy operations as function objects, see `add_operation` and others
+ * in `arithmetic.h`.
+ */
+struct lazy_add_operation {
+    template<typename Arithmetic, typename T>
+    constexpr void operator()(Arithmetic& arithmetic, T n1, T d1, T n2, T d2,
+            T& n, T& d) const {
+        LazyAddRational<false>(arithmetic, n1, d1, n2, d2, n, d);
+    }
+};
+
+struct lazy_subtract_operation {
+    template<typename Arithmetic, typename T>
+    constexpr void operator()(Arithmetic& arithmetic, T n1, T d1, T n2, T d2,
+            T& n, T& d) const {
+        LazyAddRational<true>(arithmetic, n1, d1, n2, d2, n, d);
+    }
+};
+
+struct lazy_multiply_operation {
+    template<typename Arithmetic, typename T>
+    constexpr void operator()(Arithmetic& arithmetic, T n1, T d1, T n2, T d2,
+            T& n, T& d) const {
+        LazyMultiplyRational(arithmetic, n1, d1, n2, d2, n, d);
+    }
+};
+
+struct lazy_divide_operation {
+    template<typename Arithmetic, typename T>
+    constexpr void operator()(Arithmetic& arithmetic, T n1, T d1, T n2, T d2,
+            T& n, T& d) const {
+        LazyDivideRational(arithmetic, n1, d1, n2, d2, n, d);
+    }
+};
+
+/*
+ * Class basic_lazy_rational. Accumulator with deferred normalization.
+ *
+ * `+=`, `-=`, `*=`, `/=` do not run GCD. Numerator and denominator are
+ * reduced only when:
+ * 1. the unreduced result does not fit into `T` (the bit-width threshold)
+ * - then the value is reduced and the operation is repeated by
+ * `basic_rational` with its overflow policy;
+ * 2. the value is observed: `numerator()`, `denominator()`, `value()`,
+ * comparison or output.
+ *
+ * Observed values are always equal to the values of eager `basic_rational`
+ * doing the same operations, including overflow errors.
+ *
+ * Public:
+ * 1. `basic_lazy_rational(num, deno)` - class initializer. By default
+ * `num = 0`, `deno = 1`. Also can be created from `basic_rational`.
+ * 2. `numerator()` - return reduced numerator value.
+ * 3. `denominator()` - return reduced denominator value.
+ * 4. `value()` - return reduced value as `basic_rational`, also explicit
+ * conversion to `basic_rational`.
+ * 5. `normalize()` - reduce the stored value.
+ * 6. `isNormalized()` - check, if the stored value is reduced.
+ *
+ * Private:
+ * 1. `numerator_value`, `denominator_value` - unreduced value, denominator
+ * is always positive.
+ * 2. `normalized` - `true`, if the stored value is reduced.
+ * 3. `applyLazy` - run lazy operation, fall back to eager on overflow.
+ */
+template<typename T, typename OverflowPolicy = overflow_throw>
+class basic_lazy_rational {
+public:
+    typedef T value_type;
+    typedef basic_rational<T, OverflowPolicy> rational_type;
+
+    constexpr basic_lazy_rational(T num = 0, T deno = 1);
+    constexpr basic_lazy_rational(const rational_type& value);
+
+    constexpr T numerator() const;
+    constexpr T denominator() const;
+    constexpr rational_type value() const;
+    constexpr void normalize() const;
+    constexpr bool isNormalized() const;
+
+    constexpr explicit operator rational_type() const {
+        return value();
+    }
+
+    constexpr void operator+=(const basic_lazy_rational& right);
+    constexpr void operator-=(const basic_lazy_rational& right);
+    constexpr void operator*=(const basic_lazy_rational& right);
+    constexpr void operator/=(const basic_lazy_rational& right);
+
+    /*
+     * Comparison operators. Both values are reduced, then compared as
+     * `basic_rational`. `basic_rational` operand is converted implicitly.
+     */
+    friend constexpr bool operator==(const basic_lazy_rational& left,
+            const basic_lazy_rational& right) {
+        return left.value() == right.value();
+    }
+    friend constexpr bool operator!=(const basic_lazy_rational& left,
+            const basic_lazy_rational& right) {
+        return left.value() != right.value();
+    }
+    friend constexpr bool operator<(const basic_lazy_rational& left,
+            const basic_lazy_rational& right) {
+        return left.value() < right.value();
+    }
+    friend constexpr bool operator<=(const basic_lazy_rational& left,
+            const basic_lazy_rational& right) {
+        return left.value() <= right.value();
+    }
+    friend constexpr bool operator>(const basic_lazy_rational& left,
+            const basic_lazy_rational& right) {
+        return left.value() > right.value();
+    }
+    friend constexpr bool operator>=(const basic_lazy_rational& left,
+            const basic_lazy_rational& right) {
+        return left.value() >= right.value();
+    }
+
+private:
+    mutable T numerator_value;
+    mutable T denominator_value;
+    mutable bool normalized;
+
+    template<typename LazyOperation, typename Operation>
+    constexpr void applyLazy(LazyOperation lazy, Operation operation,
+            const basic_lazy_rational& right);
+};
+
+/*
+ * Lazy rational with `int` numerator and denominator.
+ */
+typedef basic_lazy_rational<int> lazy_rational;
+
+/*
+ * Constructor class. By default: `num = 0`, `deno = 1`.
+ * Value is normalized once, like `basic_rational`.
+ */
+template<typename T, typename OverflowPolicy>
+constexpr basic_lazy_rational<T, OverflowPolicy>::basic_lazy_rational(T num,
+        T deno)
+    : numerator_value(0), denominator_value(1), normalized(true)
+{
+    rational_type value(num, deno);
+    numerator_value = value.numerator();
+    denominator_value = value.denominator();
+}
+/*
+ * Constructor from `basic_rational`, value is already normalized.
+ */
+template<typename T, typename OverflowPolicy>
+constexpr basic_lazy_rational<T, OverflowPolicy>::basic_lazy_rational(
+        const rational_type& value)
+    : numerator_value(value.numerator()),
+      denominator_value(value.denominator()), normalized(true)
+{
+}
+/*
+ * This function returns reduced numerator value.
+ */
+template<typename T, typename OverflowPolicy>
+constexpr T basic_lazy_rational<T, OverflowPolicy>::numerator() const {
+    normalize();
+    return numerator_value;
+}
+/*
+ * This function returns reduced denominator value.
+ */
+template<typename T, typename OverflowPolicy>
+constexpr T basic_lazy_rational<T, OverflowPolicy>::denominator() const {
+    normalize();
+    return denominator_value;
+}
+/*
+ * This function returns reduced value as `basic_rational`.
+ */
+template<typename T, typename OverflowPolicy>
+constexpr basic_rational<T, OverflowPolicy>
+basic_lazy_rational<T, OverflowPolicy>::value() const {
+    normalize();
+    return rational_type(numerator_value, denominator_value);
+}
+/*
+ * This function reduces the stored value, if it is not reduced.
+ * Denominator is positive, so reduction can not overflow.
+ */
+template<typename T, typename OverflowPolicy>
+constexpr void basic_lazy_rational<T, OverflowPolicy>::normalize() const {
+    if (!normalized) {
+        T gcd = GreatestCommonDivisor(numerator_value, denominator_value);
+        if (gcd != 1) {
+            numerator_value /= gcd;
+            denominator_value /= gcd;
+        }
+        normalized = true;
+    }
+}
+/*
+ * This function checks, if the stored value is reduced.
+ */
+template<typename T, typename OverflowPolicy>
+constexpr bool basic_lazy_rational<T, OverflowPolicy>::isNormalized() const {
+    return normalized;
+}
+/*
+ * This function runs lazy operation with `checked_arithmetic`.
+ *
+ * If it overflows, both values are reduced and the operation is done by
+ * `basic_rational`, so the result and the overflow policy are the same
+ * as in the eager path.
+ */
+template<typename T, typename OverflowPolicy>
+template<typename LazyOperation, typename Operation>
+constexpr void basic_lazy_rational<T, OverflowPolicy>::applyLazy(
+        LazyOperation lazy, Operation operation,
+        const basic_lazy_rational& right)
+{
+    checked_arithmetic<T> arithmetic;
+    T num = 0, deno = 1;
+    lazy(arithmetic, numerator_value, denominator_value,
+            right.numerator_value, right.denominator_value, num, deno);
+    if (!arithmetic.overflow) {
+        numerator_value = num;
+        denominator_value = deno;
+        normalized = deno == 1;
+        return;
+    }
+    rational_type result = value();
+    rational_type other = right.value();
+    operation(result, other);
+    numerator_value = result.numerator();
+    denominator_value = result.denominator();
+    normalized = true;
+}
+
+/*
+ * Eager operations of `basic_rational` for the overflow path of
+ * `applyLazy`.
+ */
+struct eager_add {
+    template<typename R>
+    constexpr void operator()(R& left, const R& right) const { left += right; }
+};
+struct eager_subtract {
+    template<typename R>
+    constexpr void operator()(R& left, const R& right) const { left -= right; }
+};
+struct eager_multiply {
+    template<typename R>
+    constexpr void operator()(R& left, const R& right) const { left *= right; }
+};
+struct eager_divide {
+    template<typename R>
+    constexpr void operator()(R& left, const R& right) const { left /= right; }
+};
+
+/*
+ * Overload `+=` operator for lazy rational class.
+ * Denominators are multiplied, no GCD is computed.
+ */
+template<typename T, typename OverflowPolicy>
+constexpr void basic_lazy_rational<T, OverflowPolicy>::operator+=(
+        const basic_lazy_rational& right) {
+    applyLazy(lazy_add_operation(), eager_add(), right);
+}
+
+/*
+ * Overload `-=` operator for lazy rational class.
+ */
+template<typename T, typename OverflowPolicy>
+constexpr void basic_lazy_rational<T, OverflowPolicy>::operator-=(
+        const basic_lazy_rational& right) {
+    applyLazy(lazy_subtract_operation(), eager_subtract(), right);
+}
+
+/*
+ * Overload `*=` operator for lazy rational class.
+ */
+template<typename T, typename OverflowPolicy>
+constexpr void basic_lazy_rational<T, OverflowPolicy>::operator*=(
+        const basic_lazy_rational& right) {
+    applyLazy(lazy_multiply_operation(), eager_multiply(), right);
+}
+
+/*
+ * Overload `/=` operator for lazy rational class.
+ * Raises logical error, if right rational is zero.
+ */
+template<typename T, typename OverflowPolicy>
+constexpr void basic_lazy_rational<T, OverflowPolicy>::operator/=(
+        const basic_lazy_rational& right) {
+    if (right.numerator_value == 0) {
+        RaiseZeroDenominatorError();
+    }
+    applyLazy(lazy_divide_operation(), eager_divide(), right);
+}
+
+/*
+ * Overload `<<` operator for lazy rational class.
+ * Value is reduced and printed in the format: `n/d`.
+ */
+template<typename T, typename OverflowPolicy>
+std::ostream& operator<<(std::ostream& stream,
+        const basic_lazy_rational<T, OverflowPolicy>& rational)
+{
+    return stream << rational.value();
+}
+
+#endif /* LAZY_RATIONAL_H */
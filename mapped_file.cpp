@@ -0,0 +1,58 @@
+#include "mapped_file.h"
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+/*
+ * Constructor class. Opens file, maps it and closes the descriptor, the
+ * mapping stays valid. Kernel is advised, that the file is read
+ * sequentially.
+ */
+mapped_file::mapped_file(const std::string& path)
+    : address(nullptr), length(0)
+{
+    int descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        throw std::runtime_error("Error: can not open file `" + path + "`!");
+    }
+    struct stat status;
+    if (::fstat(descriptor, &status) != 0) {
+        ::close(descriptor);
+        throw std::runtime_error("Error: can not read file `" + path + "`!");
+    }
+    length = static_cast<std::size_t>(status.st_size);
+    if (length != 0) {
+        void* memory = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE,
+                descriptor, 0);
+        if (memory == MAP_FAILED) {
+            ::close(descriptor);
+            throw std::runtime_error("Error: can not map file `" + path + "`!");
+        }
+        ::madvise(memory, length, MADV_SEQUENTIAL);
+        address = static_cast<const char*>(memory);
+    }
+    ::close(descriptor);
+}
+/*
+ * Destructor class. Unmaps the file.
+ */
+mapped_file::~mapped_file() {
+    if (address != nullptr) {
+        ::munmap(const_cast<char*>(address), length);
+    }
+}
+/*
+ * This function returns pointer to the first byte of the file.
+ */
+const char* mapped_file::data() const {
+    return address;
+}
+/*
+ * This function returns size of the file in bytes.
+ */
+std::size_t mapped_file::size() const {
+    return length;
+}
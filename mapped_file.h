@@ -0,0 +1,37 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+/*
+ * Class mapped_file. Read-only file, mapped into memory with `mmap`, so
+ * the contents are read without copying.
+ *
+ * Public:
+ * 1. `mapped_file(path)` - class initializer, maps the whole file.
+ * Raises runtime error, if file can not be opened or mapped.
+ * 2. `data()` - return pointer to the first byte (`nullptr` for empty
+ * file).
+ * 3. `size()` - return size of the file in bytes.
+ *
+ * Private:
+ * 1. `address` - mapped memory.
+ * 2. `length` - size of mapped memory.
+ */
+class mapped_file {
+public:
+    explicit mapped_file(const std::string& path);
+    ~mapped_file();
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    const char* data() const;
+    std::size_t size() const;
+
+private:
+    const char* address;
+    std::size_t length;
+};
+
+#endif /* MAPPED_FILE_H */
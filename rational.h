@@ -1,95 +1,472 @@
 #ifndef RATIONAL_H
 #define RATIONAL_H
 
+#include "arithmetic.h"
+#include "utils.h"
 #include <istream>
 #include <ostream>
+#include <stdexcept>
+#include <cstddef>
+#include <functional>
 
-/* 
- * Class rational.
- * 
- * Public: 
- * 1. `rational(num, deno)` - class initializer. By default `num = 0`, `deno = 1`.
+/*
+ * Class basic_rational. Header-only, all operations are `constexpr`.
+ *
+ * Template parameter `T` - integer type of numerator and denominator:
+ * `int`, `long`, `long long` or `__int128` (see `integer_traits`).
+ * Template parameter `OverflowPolicy` - what to do, when result of operation
+ * does not fit into `T`: `overflow_throw` (default), `overflow_saturate`
+ * or `overflow_promote` (see `arithmetic.h`).
+ *
+ * Public:
+ * 1. `basic_rational(num, deno)` - class initializer. By default `num = 0`,
+ * `deno = 1`.
  * 2. `numerator()` - return numerator value.
  * 3. `denominator()` - return denominator value.
  * 4. `setRational(num, deno)` - set new numerator and denominator values.
  * 5. `setNumerator(num)` - set new numerator value.
  * 6. `setDenominator(deno)` - set new denominator value.
- * 
+ *
  * Also operators: `+=`, `-=`, `*=`, `/=` .
- * 
+ *
  * Private:
  * 1. `numerator_value` - numerator value.
  * 2. `denominator_value` - denominator value.
  * 3. `updateRational` - update numerator and denominator values.
- * 4. `defaultRational` - set default numerator and denominator values. By 
+ * 4. `defaultRational` - set default numerator and denominator values. By
  * default numerator = 0, denominator = 1.
- * 
+ * 5. `applyRational` - run checked operation, call overflow policy if
+ * it overflows.
+ * 6. `compareRational` - compare two rational objects.
+ *
  */
-class rational {
+template<typename T, typename OverflowPolicy = overflow_throw>
+class basic_rational {
 public:
-    rational (int num = 0, int deno = 1);
-    int numerator() const;
-    int denominator() const;
-    void setRational(int num, int deno);
-    void setNumerator(int num);
-    void setDenominator(int deno);
-    
-    void operator+=(const rational& right);
-    void operator-=(const rational& right);
-    void operator*=(const rational& right);
-    void operator/=(const rational& right);
-    
-    explicit operator bool() const {
+    typedef T value_type;
+    typedef OverflowPolicy overflow_policy;
+
+    constexpr basic_rational (T num = 0, T deno = 1);
+    constexpr T numerator() const;
+    constexpr T denominator() const;
+    constexpr void setRational(T num, T deno);
+    constexpr void setNumerator(T num);
+    constexpr void setDenominator(T deno);
+
+    constexpr void operator+=(const basic_rational& right);
+    constexpr void operator-=(const basic_rational& right);
+    constexpr void operator*=(const basic_rational& right);
+    constexpr void operator/=(const basic_rational& right);
+
+    constexpr explicit operator bool() const {
         if (denominator_value == 1) {
             return numerator_value != 0;
         }
         return numerator_value != 0 && denominator_value != 1;
     };
-    
+
+    /*
+     * Operators:
+     * `==` - check if two rational objects are equal.
+     * `!=` - check if two rational objects are not equal.
+     * `!` - check if not rational object, (for example,
+     * `!rational(0, 1)` - `false`).
+     *
+     * Values are always normalized, so equal rationals have equal
+     * numerators and denominators.
+     */
+    friend constexpr bool operator==(const basic_rational& left,
+            const basic_rational& right) {
+        return left.numerator_value == right.numerator_value &&
+                left.denominator_value == right.denominator_value;
+    }
+    friend constexpr bool operator!=(const basic_rational& left,
+            const basic_rational& right) {
+        return !(left == right);
+    }
+    friend constexpr bool operator!(const basic_rational& right) {
+        return !(right.denominator() == 1 && right.numerator() == 0);
+    }
+
+    /*
+     * Operators:
+     * `+` - addition two rational objects.
+     * `-` - subtraction two rational objects.
+     * `*` - multiplication two rational objects.
+     * `/` - division two rational objects.
+     */
+    friend constexpr basic_rational operator+(const basic_rational& left,
+            const basic_rational& right) {
+        basic_rational result = left;
+        result += right;
+        return result;
+    }
+    friend constexpr basic_rational operator-(const basic_rational& left,
+            const basic_rational& right) {
+        basic_rational result = left;
+        result -= right;
+        return result;
+    }
+    friend constexpr basic_rational operator*(const basic_rational& left,
+            const basic_rational& right) {
+        basic_rational result = left;
+        result *= right;
+        return result;
+    }
+    friend constexpr basic_rational operator/(const basic_rational& left,
+            const basic_rational& right) {
+        basic_rational result = left;
+        result /= right;
+        return result;
+    }
+
+    /*
+     * Operators:
+     * `<` - check, if left rational less than right rational.
+     * `<=` - check, if left rational less than or equal to right rational.
+     * `>` - check, if left rational more than right rational.
+     * `>=` - check, if left rational more than or equal to right rational.
+     *
+     * Rationals are compared by cross multiplication in the wider type
+     * (see `CompareRational`), so comparison never overflows.
+     */
+    friend constexpr bool operator<(const basic_rational& left,
+            const basic_rational& right) {
+        return compareRational(left, right) < 0;
+    }
+    friend constexpr bool operator<=(const basic_rational& left,
+            const basic_rational& right) {
+        return compareRational(left, right) <= 0;
+    }
+    friend constexpr bool operator>(const basic_rational& left,
+            const basic_rational& right) {
+        return compareRational(left, right) > 0;
+    }
+    friend constexpr bool operator>=(const basic_rational& left,
+            const basic_rational& right) {
+        return compareRational(left, right) >= 0;
+    }
+
 private:
-    int numerator_value;
-    int denominator_value;
-    
-    void updateRational(int num, int deno);
-    void defaultRational();
+    T numerator_value;
+    T denominator_value;
+
+    RATIONAL_INSTRUMENTED_CONSTEXPR void updateRational(T num, T deno);
+    constexpr void defaultRational();
+    template<typename Operation>
+    RATIONAL_INSTRUMENTED_CONSTEXPR void applyRational(Operation operation,
+            T n1, T d1, T n2, T d2);
+
+    static RATIONAL_INSTRUMENTED_CONSTEXPR int compareRational(
+            const basic_rational& left, const basic_rational& right);
 };
 
-/* 
- * Operators:
- * `==` - check if two rational objects are equal.
- * `!=` - check if two rational objects are not equal.
- * `!` - check if not rational object, (for example, `!rational(0, 1)` - `false`).
- */
-bool operator==(const rational& left, const rational& right);
-bool operator!=(const rational& left, const rational& right);
-bool operator!(const rational& right);
-
-/* 
- * Operators:
- * `+` - addition two rational objects.
- * `-` - subtraction two rational objects.
- * `*` - multiplication two rational objects.
- * `/` - division two rational objects.
- */
-rational operator+(const rational& left, const rational& right);
-rational operator-(const rational& left, const rational& right);
-rational operator/(const rational& left, const rational& right);
-rational operator*(const rational& left, const rational& right);
-
-/* 
- * Operators:
- * `<` - check, if left rational less than right rational.
- * `>` - check, if left rational more than right rational.
- */
-bool operator<(const rational& left, const rational& right);
-bool operator>(const rational& left, const rational& right);
-
-/* 
- * Input/Output operators:
- * `>>` - set rational object from input.
- * `<<` - output rational object in the format `n/d`.
- */
-std::istream& operator>>(std::istream& stream, rational& rational);
-std::ostream& operator<<(std::ostream& stream, const rational& rational);
+/*
+ * Rational number with `int` numerator and denominator.
+ */
+typedef basic_rational<int> rational;
+
+/*
+ * Constructor class. By default: `num = 0`, `deno = 1`.
+ * Create rational number object, or raises logical error,
+ * if denominator is zero.
+ *
+ * Numerator (argument `num`) -  сan be any number.
+ * Denominator (argument `deno`) - can be any number, different from zero.
+ *
+ * You can create object as: `rational(n, d)`, `rational number = {n, d}`,
+ * `{n, d}`.
+ *
+ * You can use this object in vector, map and set.
+ */
+template<typename T, typename OverflowPolicy>
+constexpr basic_rational<T, OverflowPolicy>::basic_rational (T num, T deno)
+    : numerator_value(0), denominator_value(1)
+{
+    if (num == 0) {
+        defaultRational();
+    } else if (deno == 0) {
+        RaiseZeroDenominatorError();
+    } else {
+        updateRational(num, deno);
+    }
+}
+/*
+ * This function returns numerator value.
+ */
+template<typename T, typename OverflowPolicy>
+constexpr T basic_rational<T, OverflowPolicy>::numerator() const {
+    return numerator_value;
+}
+/*
+ * This function returns denominator value.
+ */
+template<typename T, typename OverflowPolicy>
+constexpr T basic_rational<T, OverflowPolicy>::denominator() const {
+    return denominator_value;
+}
+/*
+ * This function change numerator. Denominator don`t be changed.
+ *
+ * Set default values, if numerator is zero. Otherwise update numerator.
+ */
+template<typename T, typename OverflowPolicy>
+constexpr void basic_rational<T, OverflowPolicy>::setNumerator(T num) {
+    if (num == 0) {
+        defaultRational();
+    } else {
+        updateRational(num, denominator_value);
+    }
+}
+/*
+ * This function change denominator. Numerator don`t be changed.
+ *
+ * Update denominator, if denominator not zero.
+ * Otherwise raise logical error.
+ *
+ * Denominator must be value, different from zero.
+ */
+template<typename T, typename OverflowPolicy>
+constexpr void basic_rational<T, OverflowPolicy>::setDenominator(T deno) {
+    if (deno != 0) {
+        updateRational(numerator_value, deno);
+    } else {
+        RaiseZeroDenominatorError();
+    }
+}
+/*
+ * This function change numerator and denominator.
+ *
+ * Set default values, if numerator is zero.
+ *
+ * Update denominator, if denominator not zero. Otherwise raise logic error.
+ *
+ * Denominator must value, different from zero.
+ */
+template<typename T, typename OverflowPolicy>
+constexpr void basic_rational<T, OverflowPolicy>::setRational(T num, T deno) {
+    if (num == 0) {
+        defaultRational();
+    } else if (deno == 0) {
+        RaiseZeroDenominatorError();
+    } else {
+        updateRational(num, deno);
+    }
+}
+/*
+ * This function set default values.
+ * Default `numerator = 0`;
+ * Default `denominator = 1`;
+ */
+template<typename T, typename OverflowPolicy>
+constexpr void basic_rational<T, OverflowPolicy>::defaultRational() {
+    numerator_value = 0;
+    denominator_value = 1;
+}
+/*
+ * This function update values.
+ *
+ * Numerator and denominator are divided by their greatest common divisor,
+ * so the stored values are always normalized.
+ */
+template<typename T, typename OverflowPolicy>
+RATIONAL_INSTRUMENTED_CONSTEXPR
+void basic_rational<T, OverflowPolicy>::updateRational(T num,
+        T deno) {
+    RATIONAL_INSTRUMENT(CountRationalEvent(rational_event::normalization));
+    applyRational(normalize_operation(), num, deno, 0, 1);
+}
+/*
+ * This function runs operation with `checked_arithmetic` and sets the
+ * result. If operation overflows, `recover` of the overflow policy
+ * computes the result (or raises error).
+ *
+ * The check costs one flag test, when there is no overflow.
+ */
+template<typename T, typename OverflowPolicy>
+template<typename Operation>
+RATIONAL_INSTRUMENTED_CONSTEXPR
+void basic_rational<T, OverflowPolicy>::applyRational(
+        Operation operation, T n1, T d1, T n2, T d2)
+{
+    RATIONAL_INSTRUMENT(CountRationalEvent(rational_event::operation));
+    RATIONAL_INSTRUMENT(CountRationalOperands(OperandMagnitude(n1) |
+            OperandMagnitude(d1) | OperandMagnitude(n2) | OperandMagnitude(d2)));
+    checked_arithmetic<T> arithmetic;
+    T num = 0, deno = 1;
+    operation(arithmetic, n1, d1, n2, d2, num, deno);
+    if (arithmetic.overflow) {
+        RATIONAL_INSTRUMENT(CountRationalEvent(rational_event::overflow));
+        OverflowPolicy::recover(operation, n1, d1, n2, d2, num, deno);
+    }
+    numerator_value = num;
+    denominator_value = deno;
+}
+
+/*
+ * Overload `+=` operator for rational class.
+ * Example: `a += b`.
+ *
+ * If denominators equals, numerators are added.
+ * Otherwise, Knuth's algorithm is used (see `AddRational`).
+ *
+ * Example: `a += b`. `a` - this rational, `b` - right rational.
+ * Formula: `g = gcd(d, right_d)`, `t = n * (right_d / g) + right_n * (d / g)`,
+ * new numerator is `t / gcd(t, g)`, new denominator is
+ * `(d / g) * (right_d / gcd(t, g))`, where
+ * `n` - numerator, `d` - denominator;
+ * `right_n` - numerator of right rational number,
+ * `right_d` - denominator of right rational numer;
+ *
+ */
+template<typename T, typename OverflowPolicy>
+constexpr void basic_rational<T, OverflowPolicy>::operator+=(
+        const basic_rational& right) {
+    applyRational(add_operation(), numerator_value, denominator_value,
+            right.numerator(), right.denominator());
+}
+
+/*
+ * Overload `-=` operator for rational class.
+ * Example: `a -= b`.
+ *
+ * Same as `+=`, but numerators are subtracted.
+ *
+ */
+template<typename T, typename OverflowPolicy>
+constexpr void basic_rational<T, OverflowPolicy>::operator-=(
+        const basic_rational& right) {
+    applyRational(subtract_operation(), numerator_value, denominator_value,
+            right.numerator(), right.denominator());
+}
+
+/*
+ * Overload `*=` operator for rational class.
+ * Example: `a *= b`.
+ *
+ * Example: `a *= b`. `a` - this rational, `b` - right rational.
+ * Left numerator multiplication on right numerator,
+ * left denominator multiplication on right denominator.
+ * Numerators and denominators are cancelled crosswise before
+ * multiplication (see `MultiplyRational`).
+ *
+ */
+template<typename T, typename OverflowPolicy>
+constexpr void basic_rational<T, OverflowPolicy>::operator*=(
+        const basic_rational& right) {
+    applyRational(multiply_operation(), numerator_value, denominator_value,
+            right.numerator(), right.denominator());
+}
+
+/*
+ * Overload `/=` operator for rational class.
+ * Example: `a /= b`.
+ *
+ * Raises logical error, if right rational is zero.
+ *
+ * Example: `a /= b`. `a` - this rational, `b` - right rational.
+ * Left numerator multiplication on right denominator,
+ * left denominator multiplication on right numerator.
+ * Values are cancelled crosswise before multiplication
+ * (see `DivideRational`).
+ *
+ */
+template<typename T, typename OverflowPolicy>
+constexpr void basic_rational<T, OverflowPolicy>::operator/=(
+        const basic_rational& right) {
+    if (right.numerator() == 0) {
+        RaiseZeroDenominatorError();
+    }
+    applyRational(divide_operation(), numerator_value, denominator_value,
+            right.numerator(), right.denominator());
+}
+
+/*
+ * Comparison function.
+ * Takes left class rational as first argument,
+ * right class rational as second argument.
+ *
+ * Returns -1, 0 or 1, if left rational is less than, equal to or more
+ * than right rational. Equal denominators compare numerators only.
+ */
+template<typename T, typename OverflowPolicy>
+RATIONAL_INSTRUMENTED_CONSTEXPR
+int basic_rational<T, OverflowPolicy>::compareRational(
+        const basic_rational& left, const basic_rational& right)
+{
+    RATIONAL_INSTRUMENT(CountRationalEvent(rational_event::comparison));
+    if (left.denominator_value == right.denominator_value) {
+        return (left.numerator_value > right.numerator_value) -
+                (left.numerator_value < right.numerator_value);
+    }
+    return CompareRational(left.numerator_value, left.denominator_value,
+            right.numerator_value, right.denominator_value);
+}
+
+/*
+ * Overload `>>` operator for rational class.
+ *
+ * Calls `setRational` function if istream not empty.
+ *
+ * Input rational must be: `n/d`, with `/` separator.
+ *
+ * Returns istream.
+ */
+template<typename T, typename OverflowPolicy>
+std::istream& operator>>(std::istream& stream,
+        basic_rational<T, OverflowPolicy>& rational)
+{
+    T numerator = 0, denominator = 0;
+    ReadInteger(stream, numerator);
+    // ignore separator.
+    stream.ignore(1);
+    ReadInteger(stream, denominator);
+    if (!stream.fail()) {
+        rational.setRational(numerator, denominator);
+    }
+    return stream;
+}
+
+/*
+ * Overload `<<` operator for rational class.
+ *
+ * Output rational in the format: `n/d`. With default flags of the
+ * stream rational is formatted by `FormatInteger` into local buffer and
+ * written with one `write` call.
+ *
+ * Returns ostream.
+ */
+template<typename T, typename OverflowPolicy>
+std::ostream& operator<<(std::ostream& stream,
+        const basic_rational<T, OverflowPolicy>& rational)
+{
+    if (!HasDefaultIntegerFormat(stream)) {
+        WriteInteger(stream, rational.numerator());
+        stream << "/";
+        WriteInteger(stream, rational.denominator());
+        return stream;
+    }
+    char buffer[MaxFormattedLength<T>() * 2 + 1];
+    char* end = FormatInteger(buffer, rational.numerator());
+    *end++ = '/';
+    end = FormatInteger(end, rational.denominator());
+    stream.write(buffer, end - buffer);
+    return stream;
+}
+
+/*
+ * Hash of rational for `std::unordered_map`, `std::unordered_set` and
+ * `rational_flat_map`. Values are normalized, so equal rationals have
+ * equal hashes.
+ */
+namespace std {
+template<typename T, typename OverflowPolicy>
+struct hash<basic_rational<T, OverflowPolicy>> {
+    size_t operator()(const basic_rational<T, OverflowPolicy>& value) const {
+        return static_cast<size_t>(
+                HashRational(value.numerator(), value.denominator()));
+    }
+};
+}
 
 #endif /* RATIONAL_H */
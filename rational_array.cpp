@@ -0,0 +1,687 @@
+#include "rational_array.h"
+#include "arithmetic.h"
+#include <stdexcept>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define RATIONAL_ARRAY_SIMD 1
+#define RATIONAL_TARGET_AVX2 __attribute__((target("avx2")))
+#define RATIONAL_TARGET_AVX512 \
+    __attribute__((target("avx512f,avx512cd,avx512dq")))
+#define RATIONAL_INLINE inline __attribute__((always_inline))
+#endif
+
+
+/*
+ * Constructor class. All values are `0/1`.
+ */
+rational_array::rational_array(std::size_t size)
+    : numerator_values(size, 0), denominator_values(size, 1)
+{
+}
+/*
+ * Constructor from vector of rationals.
+ */
+rational_array::rational_array(const std::vector<rational>& values)
+    : numerator_values(values.size()), denominator_values(values.size())
+{
+    for (std::size_t i = 0; i < values.size(); i++) {
+        numerator_values[i] = values[i].numerator();
+        denominator_values[i] = values[i].denominator();
+    }
+}
+/*
+ * This function returns number of values.
+ */
+std::size_t rational_array::size() const {
+    return numerator_values.size();
+}
+/*
+ * This function changes number of values. New values are `0/1`.
+ */
+void rational_array::resize(std::size_t size) {
+    numerator_values.resize(size, 0);
+    denominator_values.resize(size, 1);
+}
+/*
+ * This function returns value with index `index`.
+ */
+rational rational_array::get(std::size_t index) const {
+    return rational(numerator_values[index], denominator_values[index]);
+}
+/*
+ * This function changes value with index `index`.
+ */
+void rational_array::set(std::size_t index, const rational& value) {
+    numerator_values[index] = value.numerator();
+    denominator_values[index] = value.denominator();
+}
+/*
+ * This function adds value to the end of array.
+ */
+void rational_array::push_back(const rational& value) {
+    numerator_values.push_back(value.numerator());
+    denominator_values.push_back(value.denominator());
+}
+/*
+ * This function returns buffer of numerators.
+ */
+const int* rational_array::numerators() const {
+    return numerator_values.data();
+}
+/*
+ * This function returns buffer of denominators.
+ */
+const int* rational_array::denominators() const {
+    return denominator_values.data();
+}
+/*
+ * This function returns values as vector of rationals.
+ */
+std::vector<rational> rational_array::toVector() const {
+    std::vector<rational> result;
+    result.reserve(size());
+    for (std::size_t i = 0; i < size(); i++) {
+        result.push_back(get(i));
+    }
+    return result;
+}
+
+/*
+ * Function runs operation for one element, exactly as `rational` does:
+ * checked kernel from `arithmetic.h`, `overflow_throw` on overflow and
+ * logical error for division by zero. Sums, whose intermediate values
+ * overflow `int`, are repeated in `long long` by the kernel, so overflow
+ * error is raised only if the reduced result does not fit, like in the
+ * vector kernels.
+ */
+template<typename Operation>
+static void ApplyElement(Operation operation, int n1, int d1, int n2, int d2,
+        int& n, int& d)
+{
+    if (std::is_same<Operation, divide_operation>::value && n2 == 0) {
+        RaiseZeroDenominatorError();
+    }
+    checked_arithmetic<int> arithmetic;
+    int num = 0, deno = 1;
+    operation(arithmetic, n1, d1, n2, d2, num, deno);
+    if (arithmetic.overflow) {
+        overflow_throw::recover(operation, n1, d1, n2, d2, num, deno);
+    }
+    n = num;
+    d = deno;
+}
+
+/*
+ * Function runs operation for `count` elements, one by one.
+ */
+template<typename Operation>
+static void ArithmeticScalar(Operation operation, const int* n1,
+        const int* d1, const int* n2, const int* d2, int* n, int* d,
+        std::size_t count)
+{
+    for (std::size_t i = 0; i < count; i++) {
+        ApplyElement(operation, n1[i], d1[i], n2[i], d2[i], n[i], d[i]);
+    }
+}
+
+/*
+ * Function compares `count` elements, one by one. Denominators are
+ * positive, so `n1/d1 < n2/d2` is `n1 * d2 < n2 * d1`, products are
+ * computed in `long long` and can not overflow.
+ */
+static void CompareScalar(const int* n1, const int* d1, const int* n2,
+        const int* d2, signed char* result, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; i++) {
+        long long left = static_cast<long long>(n1[i]) * d2[i];
+        long long right = static_cast<long long>(n2[i]) * d1[i];
+        result[i] = static_cast<signed char>((left > right) - (left < right));
+    }
+}
+
+/*
+ * Function repeats operation with `ApplyElement` for the lanes of a block,
+ * whose bits are set in `fallback`, then writes the block to `n` and `d`.
+ * Inputs are read before the block is written, so `n` and `d` can point
+ * to the inputs.
+ */
+template<typename Operation>
+static void FixupBlock(Operation operation, const int* n1, const int* d1,
+        const int* n2, const int* d2, int* n, int* d, int* block_n,
+        int* block_d, unsigned fallback, int lanes)
+{
+    for (int k = 0; k < lanes; k++) {
+        if (fallback & (1u << k)) {
+            ApplyElement(operation, n1[k], d1[k], n2[k], d2[k], block_n[k],
+                    block_d[k]);
+        }
+    }
+    for (int k = 0; k < lanes; k++) {
+        n[k] = block_n[k];
+        d[k] = block_d[k];
+    }
+}
+
+#ifdef RATIONAL_ARRAY_SIMD
+
+/*
+ * AVX2 kernels.
+ *
+ * Every 32-bit value is sign-extended to a 64-bit lane. Cross products
+ * `n1 * d2`, `n2 * d1`, `d1 * d2` fit into 63 bits, so the unreduced
+ * result is exact. It is reduced by vector binary GCD, and the quotients
+ * are computed in `double`: the quotient, which fits into `int`, is
+ * recovered exactly after rounding (relative error of the division is
+ * about 2^-52). Lanes, which do not fit, are repeated by the scalar
+ * kernel, so results and errors are the same as for `rational`.
+ */
+
+/*
+ * Function returns number of trailing zero bits in every 64-bit lane,
+ * 64 for zero. AVX2 has no `tzcnt` for vectors, so bits below the lowest
+ * set bit are counted with nibble lookup table (`vpshufb`) and summed
+ * per lane with `vpsadbw`.
+ */
+RATIONAL_TARGET_AVX2 RATIONAL_INLINE
+static __m256i CountTrailingZerosAvx2(__m256i value) {
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2,
+            3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    __m256i zero = _mm256_setzero_si256();
+    __m256i lowest = _mm256_and_si256(value, _mm256_sub_epi64(zero, value));
+    __m256i below = _mm256_sub_epi64(lowest, _mm256_set1_epi64x(1));
+    __m256i low = _mm256_shuffle_epi8(table, _mm256_and_si256(below, nibble));
+    __m256i high = _mm256_shuffle_epi8(table,
+            _mm256_and_si256(_mm256_srli_epi16(below, 4), nibble));
+    return _mm256_sad_epu8(_mm256_add_epi8(low, high), zero);
+}
+
+/*
+ * Function converts 64-bit lanes to `double` (AVX2 has no instruction for
+ * it). High and low parts are placed into mantissas of two magic numbers,
+ * so the result is rounded only once.
+ */
+RATIONAL_TARGET_AVX2 RATIONAL_INLINE
+static __m256d ConvertToDoubleAvx2(__m256i value) {
+    // 3 * 2^67 and 3 * 2^67 + 2^52.
+    const __m256d magic_high = _mm256_set1_pd(442721857769029238784.0);
+    const __m256d magic_both = _mm256_set1_pd(442726361368656609280.0);
+    const __m256d magic_low = _mm256_set1_pd(4503599627370496.0);
+    __m256i high = _mm256_srai_epi32(value, 16);
+    high = _mm256_blend_epi16(high, _mm256_setzero_si256(), 0x33);
+    high = _mm256_add_epi64(high, _mm256_castpd_si256(magic_high));
+    __m256i low = _mm256_blend_epi16(value, _mm256_castpd_si256(magic_low),
+            0x88);
+    __m256d result = _mm256_sub_pd(_mm256_castsi256_pd(high), magic_both);
+    return _mm256_add_pd(result, _mm256_castsi256_pd(low));
+}
+
+/*
+ * Function reduces `num/deno` in two vectors (8 lanes) and writes 32-bit
+ * results. Two independent GCD chains are interleaved, so the latency of
+ * one chain is hidden by the other. Denominators must be not negative.
+ *
+ * Returns bit mask of lanes, which do not fit into `int` (or have zero
+ * denominator).
+ */
+RATIONAL_TARGET_AVX2 RATIONAL_INLINE
+static unsigned ReduceAvx2(const __m256i* num, const __m256i* deno,
+        __m128i* n, __m128i* d)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i u[2], v[2], shift[2];
+    for (int j = 0; j < 2; j++) {
+        __m256i sign = _mm256_cmpgt_epi64(zero, num[j]);
+        u[j] = _mm256_sub_epi64(_mm256_xor_si256(num[j], sign), sign);
+        v[j] = deno[j];
+        shift[j] = CountTrailingZerosAvx2(_mm256_or_si256(u[j], v[j]));
+        // gcd(0, v) = gcd(v, v).
+        u[j] = _mm256_blendv_epi8(u[j], v[j], _mm256_cmpeq_epi64(u[j], zero));
+        u[j] = _mm256_srlv_epi64(u[j], CountTrailingZerosAvx2(u[j]));
+    }
+    for (;;) {
+        __m256i done[2];
+        for (int j = 0; j < 2; j++) {
+            done[j] = _mm256_cmpeq_epi64(v[j], zero);
+        }
+        if (_mm256_movemask_epi8(_mm256_and_si256(done[0], done[1])) == -1) {
+            break;
+        }
+        for (int j = 0; j < 2; j++) {
+            v[j] = _mm256_srlv_epi64(v[j], CountTrailingZerosAvx2(v[j]));
+            __m256i greater = _mm256_cmpgt_epi64(u[j], v[j]);
+            __m256i smaller = _mm256_blendv_epi8(u[j], v[j], greater);
+            __m256i larger = _mm256_blendv_epi8(v[j], u[j], greater);
+            u[j] = _mm256_blendv_epi8(smaller, u[j], done[j]);
+            v[j] = _mm256_blendv_epi8(_mm256_sub_epi64(larger, smaller), v[j],
+                    done[j]);
+        }
+    }
+    const __m256d minimum = _mm256_set1_pd(integer_traits<int>::min());
+    const __m256d maximum = _mm256_set1_pd(integer_traits<int>::max());
+    unsigned fallback = 0;
+    for (int j = 0; j < 2; j++) {
+        __m256d gcd = ConvertToDoubleAvx2(_mm256_sllv_epi64(u[j], shift[j]));
+        __m256d quotient_n = _mm256_round_pd(
+                _mm256_div_pd(ConvertToDoubleAvx2(num[j]), gcd),
+                _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        __m256d quotient_d = _mm256_round_pd(
+                _mm256_div_pd(ConvertToDoubleAvx2(deno[j]), gcd),
+                _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        __m256d fits = _mm256_and_pd(
+                _mm256_and_pd(_mm256_cmp_pd(quotient_n, minimum, _CMP_GE_OQ),
+                        _mm256_cmp_pd(quotient_n, maximum, _CMP_LE_OQ)),
+                _mm256_and_pd(_mm256_cmp_pd(quotient_d, _mm256_set1_pd(1.0),
+                        _CMP_GE_OQ),
+                        _mm256_cmp_pd(quotient_d, maximum, _CMP_LE_OQ)));
+        n[j] = _mm256_cvtpd_epi32(_mm256_and_pd(quotient_n, fits));
+        d[j] = _mm256_cvtpd_epi32(_mm256_and_pd(quotient_d, fits));
+        fallback |= (~static_cast<unsigned>(_mm256_movemask_pd(fits)) & 0xf)
+                << (4 * j);
+    }
+    return fallback;
+}
+
+/*
+ * Functions compute unreduced result of operation in 4 lanes:
+ * `n1/d1 + n2/d2 = (n1 * d2 + n2 * d1) / (d1 * d2)` and others.
+ */
+RATIONAL_TARGET_AVX2 RATIONAL_INLINE
+static void CombineAvx2(add_operation, __m256i n1, __m256i d1, __m256i n2,
+        __m256i d2, __m256i& n, __m256i& d) {
+    n = _mm256_add_epi64(_mm256_mul_epi32(n1, d2), _mm256_mul_epi32(n2, d1));
+    d = _mm256_mul_epi32(d1, d2);
+}
+RATIONAL_TARGET_AVX2 RATIONAL_INLINE
+static void CombineAvx2(subtract_operation, __m256i n1, __m256i d1,
+        __m256i n2, __m256i d2, __m256i& n, __m256i& d) {
+    n = _mm256_sub_epi64(_mm256_mul_epi32(n1, d2), _mm256_mul_epi32(n2, d1));
+    d = _mm256_mul_epi32(d1, d2);
+}
+RATIONAL_TARGET_AVX2 RATIONAL_INLINE
+static void CombineAvx2(multiply_operation, __m256i n1, __m256i d1,
+        __m256i n2, __m256i d2, __m256i& n, __m256i& d) {
+    n = _mm256_mul_epi32(n1, n2);
+    d = _mm256_mul_epi32(d1, d2);
+}
+RATIONAL_TARGET_AVX2 RATIONAL_INLINE
+static void CombineAvx2(divide_operation, __m256i n1, __m256i d1,
+        __m256i n2, __m256i d2, __m256i& n, __m256i& d) {
+    __m256i num = _mm256_mul_epi32(n1, d2);
+    __m256i deno = _mm256_mul_epi32(d1, n2);
+    __m256i sign = _mm256_cmpgt_epi64(_mm256_setzero_si256(), deno);
+    n = _mm256_sub_epi64(_mm256_xor_si256(num, sign), sign);
+    d = _mm256_sub_epi64(_mm256_xor_si256(deno, sign), sign);
+}
+
+/*
+ * Function loads 4 values and sign-extends them to 64-bit lanes.
+ */
+RATIONAL_TARGET_AVX2 RATIONAL_INLINE
+static __m256i LoadAvx2(const int* values) {
+    return _mm256_cvtepi32_epi64(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(values)));
+}
+
+template<typename Operation>
+RATIONAL_TARGET_AVX2
+static void ArithmeticAvx2(Operation operation, const int* n1,
+        const int* d1, const int* n2, const int* d2, int* n, int* d,
+        std::size_t count)
+{
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i num[2], deno[2];
+        for (int j = 0; j < 2; j++) {
+            std::size_t k = i + 4 * j;
+            CombineAvx2(operation, LoadAvx2(n1 + k), LoadAvx2(d1 + k),
+                    LoadAvx2(n2 + k), LoadAvx2(d2 + k), num[j], deno[j]);
+        }
+        __m128i result_n[2], result_d[2];
+        unsigned fallback = ReduceAvx2(num, deno, result_n, result_d);
+        if (fallback == 0) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(n + i),
+                    _mm256_set_m128i(result_n[1], result_n[0]));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + i),
+                    _mm256_set_m128i(result_d[1], result_d[0]));
+        } else {
+            alignas(16) int block_n[8], block_d[8];
+            for (int j = 0; j < 2; j++) {
+                _mm_store_si128(reinterpret_cast<__m128i*>(block_n + 4 * j),
+                        result_n[j]);
+                _mm_store_si128(reinterpret_cast<__m128i*>(block_d + 4 * j),
+                        result_d[j]);
+            }
+            FixupBlock(operation, n1 + i, d1 + i, n2 + i, d2 + i, n + i,
+                    d + i, block_n, block_d, fallback, 8);
+        }
+    }
+    ArithmeticScalar(operation, n1 + i, d1 + i, n2 + i, d2 + i, n + i, d + i,
+            count - i);
+}
+
+RATIONAL_TARGET_AVX2
+static void CompareAvx2(const int* n1, const int* d1, const int* n2,
+        const int* d2, signed char* result, std::size_t count)
+{
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256i left = _mm256_mul_epi32(LoadAvx2(n1 + i), LoadAvx2(d2 + i));
+        __m256i right = _mm256_mul_epi32(LoadAvx2(n2 + i), LoadAvx2(d1 + i));
+        int greater = _mm256_movemask_pd(
+                _mm256_castsi256_pd(_mm256_cmpgt_epi64(left, right)));
+        int less = _mm256_movemask_pd(
+                _mm256_castsi256_pd(_mm256_cmpgt_epi64(right, left)));
+        for (int k = 0; k < 4; k++) {
+            result[i + k] = static_cast<signed char>(
+                    ((greater >> k) & 1) - ((less >> k) & 1));
+        }
+    }
+    CompareScalar(n1 + i, d1 + i, n2 + i, d2 + i, result + i, count - i);
+}
+
+/*
+ * AVX-512 kernels. Same algorithm as AVX2 with 8 lanes, native
+ * `vplzcntq` (CD), 64-bit `min`/`max`, `abs` and conversion to `double`
+ * (DQ), and mask registers instead of blends.
+ *
+ * Intrinsics of GCC pass `_mm512_undefined_*()` as unused source operand,
+ * which produces false `-Wmaybe-uninitialized` warnings, when they are
+ * inlined into functions with `target` attribute.
+ */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+/*
+ * Function returns number of trailing zero bits in every 64-bit lane.
+ * For zero lane result is -1, shift by it gives zero.
+ */
+RATIONAL_TARGET_AVX512 RATIONAL_INLINE
+static __m512i CountTrailingZerosAvx512(__m512i value) {
+    __m512i lowest = _mm512_and_si512(value,
+            _mm512_sub_epi64(_mm512_setzero_si512(), value));
+    return _mm512_sub_epi64(_mm512_set1_epi64(63),
+            _mm512_lzcnt_epi64(lowest));
+}
+
+RATIONAL_TARGET_AVX512 RATIONAL_INLINE
+static unsigned ReduceAvx512(__m512i num, __m512i deno, __m256i& n,
+        __m256i& d)
+{
+    const __m512i zero = _mm512_setzero_si512();
+    __m512i u = _mm512_abs_epi64(num);
+    __m512i v = deno;
+    __m512i shift = CountTrailingZerosAvx512(_mm512_or_si512(u, v));
+    // gcd(0, v) = gcd(v, v).
+    u = _mm512_mask_mov_epi64(u, _mm512_cmpeq_epi64_mask(u, zero), v);
+    u = _mm512_srlv_epi64(u, CountTrailingZerosAvx512(u));
+    __mmask8 active = _mm512_cmpneq_epi64_mask(v, zero);
+    while (active) {
+        v = _mm512_srlv_epi64(v, CountTrailingZerosAvx512(v));
+        __m512i smaller = _mm512_min_epu64(u, v);
+        __m512i larger = _mm512_max_epu64(u, v);
+        u = _mm512_mask_mov_epi64(u, active, smaller);
+        v = _mm512_mask_sub_epi64(v, active, larger, smaller);
+        active = _mm512_cmpneq_epi64_mask(v, zero);
+    }
+    __m512d gcd = _mm512_cvtepi64_pd(_mm512_sllv_epi64(u, shift));
+    __m512d quotient_n = _mm512_roundscale_pd(
+            _mm512_div_pd(_mm512_cvtepi64_pd(num), gcd),
+            _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m512d quotient_d = _mm512_roundscale_pd(
+            _mm512_div_pd(_mm512_cvtepi64_pd(deno), gcd),
+            _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    const __m512d minimum = _mm512_set1_pd(integer_traits<int>::min());
+    const __m512d maximum = _mm512_set1_pd(integer_traits<int>::max());
+    __mmask8 fits = _mm512_cmp_pd_mask(quotient_n, minimum, _CMP_GE_OQ) &
+            _mm512_cmp_pd_mask(quotient_n, maximum, _CMP_LE_OQ) &
+            _mm512_cmp_pd_mask(quotient_d, _mm512_set1_pd(1.0), _CMP_GE_OQ) &
+            _mm512_cmp_pd_mask(quotient_d, maximum, _CMP_LE_OQ);
+    n = _mm512_cvtpd_epi32(_mm512_maskz_mov_pd(fits, quotient_n));
+    d = _mm512_cvtpd_epi32(_mm512_maskz_mov_pd(fits, quotient_d));
+    return ~static_cast<unsigned>(fits) & 0xff;
+}
+
+RATIONAL_TARGET_AVX512 RATIONAL_INLINE
+static void CombineAvx512(add_operation, __m512i n1, __m512i d1, __m512i n2,
+        __m512i d2, __m512i& n, __m512i& d) {
+    n = _mm512_add_epi64(_mm512_mul_epi32(n1, d2), _mm512_mul_epi32(n2, d1));
+    d = _mm512_mul_epi32(d1, d2);
+}
+RATIONAL_TARGET_AVX512 RATIONAL_INLINE
+static void CombineAvx512(subtract_operation, __m512i n1, __m512i d1,
+        __m512i n2, __m512i d2, __m512i& n, __m512i& d) {
+    n = _mm512_sub_epi64(_mm512_mul_epi32(n1, d2), _mm512_mul_epi32(n2, d1));
+    d = _mm512_mul_epi32(d1, d2);
+}
+RATIONAL_TARGET_AVX512 RATIONAL_INLINE
+static void CombineAvx512(multiply_operation, __m512i n1, __m512i d1,
+        __m512i n2, __m512i d2, __m512i& n, __m512i& d) {
+    n = _mm512_mul_epi32(n1, n2);
+    d = _mm512_mul_epi32(d1, d2);
+}
+RATIONAL_TARGET_AVX512 RATIONAL_INLINE
+static void CombineAvx512(divide_operation, __m512i n1, __m512i d1,
+        __m512i n2, __m512i d2, __m512i& n, __m512i& d) {
+    __m512i num = _mm512_mul_epi32(n1, d2);
+    __m512i deno = _mm512_mul_epi32(d1, n2);
+    __mmask8 negative = _mm512_cmplt_epi64_mask(deno, _mm512_setzero_si512());
+    n = _mm512_mask_sub_epi64(num, negative, _mm512_setzero_si512(), num);
+    d = _mm512_abs_epi64(deno);
+}
+
+RATIONAL_TARGET_AVX512 RATIONAL_INLINE
+static __m512i LoadAvx512(const int* values) {
+    return _mm512_cvtepi32_epi64(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values)));
+}
+
+template<typename Operation>
+RATIONAL_TARGET_AVX512
+static void ArithmeticAvx512(Operation operation, const int* n1,
+        const int* d1, const int* n2, const int* d2, int* n, int* d,
+        std::size_t count)
+{
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m512i num, deno;
+        CombineAvx512(operation, LoadAvx512(n1 + i), LoadAvx512(d1 + i),
+                LoadAvx512(n2 + i), LoadAvx512(d2 + i), num, deno);
+        __m256i result_n, result_d;
+        unsigned fallback = ReduceAvx512(num, deno, result_n, result_d);
+        if (fallback == 0) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(n + i), result_n);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + i), result_d);
+        } else {
+            alignas(32) int block_n[8], block_d[8];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(block_n), result_n);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(block_d), result_d);
+            FixupBlock(operation, n1 + i, d1 + i, n2 + i, d2 + i, n + i,
+                    d + i, block_n, block_d, fallback, 8);
+        }
+    }
+    ArithmeticScalar(operation, n1 + i, d1 + i, n2 + i, d2 + i, n + i, d + i,
+            count - i);
+}
+
+RATIONAL_TARGET_AVX512
+static void CompareAvx512(const int* n1, const int* d1, const int* n2,
+        const int* d2, signed char* result, std::size_t count)
+{
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m512i left = _mm512_mul_epi32(LoadAvx512(n1 + i),
+                LoadAvx512(d2 + i));
+        __m512i right = _mm512_mul_epi32(LoadAvx512(n2 + i),
+                LoadAvx512(d1 + i));
+        unsigned greater = _mm512_cmpgt_epi64_mask(left, right);
+        unsigned less = _mm512_cmplt_epi64_mask(left, right);
+        for (int k = 0; k < 8; k++) {
+            result[i + k] = static_cast<signed char>(
+                    static_cast<int>((greater >> k) & 1) -
+                    static_cast<int>((less >> k) & 1));
+        }
+    }
+    CompareScalar(n1 + i, d1 + i, n2 + i, d2 + i, result + i, count - i);
+}
+
+#pragma GCC diagnostic pop
+
+#endif /* RATIONAL_ARRAY_SIMD */
+
+/*
+ * Kernel, which is used by batch operations. Detected once, on first use.
+ */
+static rational_kernel& ActiveKernel() {
+    static rational_kernel kernel = DetectRationalKernel();
+    return kernel;
+}
+
+/*
+ * Function checks, if CPU supports kernel.
+ */
+bool IsRationalKernelSupported(rational_kernel kernel) {
+    switch (kernel) {
+    case rational_kernel::scalar:
+        return true;
+#ifdef RATIONAL_ARRAY_SIMD
+    case rational_kernel::avx2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+    case rational_kernel::avx512:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx512f") &&
+                __builtin_cpu_supports("avx512cd") &&
+                __builtin_cpu_supports("avx512dq");
+#endif
+    default:
+        return false;
+    }
+}
+/*
+ * Function returns the best kernel, supported by CPU.
+ */
+rational_kernel DetectRationalKernel() {
+    if (IsRationalKernelSupported(rational_kernel::avx512)) {
+        return rational_kernel::avx512;
+    }
+    if (IsRationalKernelSupported(rational_kernel::avx2)) {
+        return rational_kernel::avx2;
+    }
+    return rational_kernel::scalar;
+}
+/*
+ * Function returns kernel, used by batch operations.
+ */
+rational_kernel GetRationalKernel() {
+    return ActiveKernel();
+}
+/*
+ * Function changes kernel, used by batch operations.
+ * Raises logical error, if kernel is not supported.
+ */
+void SetRationalKernel(rational_kernel kernel) {
+    if (!IsRationalKernelSupported(kernel)) {
+        throw std::logic_error("Error: rational kernel is not supported!");
+    }
+    ActiveKernel() = kernel;
+}
+
+/*
+ * Function runs operation with active kernel.
+ */
+template<typename Operation>
+static void RunArithmetic(Operation operation, const int* n1, const int* d1,
+        const int* n2, const int* d2, int* n, int* d, std::size_t count)
+{
+    switch (ActiveKernel()) {
+#ifdef RATIONAL_ARRAY_SIMD
+    case rational_kernel::avx512:
+        ArithmeticAvx512(operation, n1, d1, n2, d2, n, d, count);
+        return;
+    case rational_kernel::avx2:
+        ArithmeticAvx2(operation, n1, d1, n2, d2, n, d, count);
+        return;
+#endif
+    default:
+        ArithmeticScalar(operation, n1, d1, n2, d2, n, d, count);
+        return;
+    }
+}
+
+/*
+ * Function raises logical error, if arrays have different sizes.
+ */
+static void CheckSizes(const rational_array& left,
+        const rational_array& right) {
+    if (left.size() != right.size()) {
+        throw std::logic_error("Error: rational arrays have different sizes!");
+    }
+}
+
+void AddRationalArray(const rational_array& left, const rational_array& right,
+        rational_array& result) {
+    CheckSizes(left, right);
+    result.resize(left.size());
+    RunArithmetic(add_operation(), left.numerators(), left.denominators(),
+            right.numerators(), right.denominators(),
+            result.numerator_values.data(), result.denominator_values.data(),
+            left.size());
+}
+
+void SubtractRationalArray(const rational_array& left,
+        const rational_array& right, rational_array& result) {
+    CheckSizes(left, right);
+    result.resize(left.size());
+    RunArithmetic(subtract_operation(), left.numerators(),
+            left.denominators(), right.numerators(), right.denominators(),
+            result.numerator_values.data(), result.denominator_values.data(),
+            left.size());
+}
+
+void MultiplyRationalArray(const rational_array& left,
+        const rational_array& right, rational_array& result) {
+    CheckSizes(left, right);
+    result.resize(left.size());
+    RunArithmetic(multiply_operation(), left.numerators(),
+            left.denominators(), right.numerators(), right.denominators(),
+            result.numerator_values.data(), result.denominator_values.data(),
+            left.size());
+}
+
+void DivideRationalArray(const rational_array& left,
+        const rational_array& right, rational_array& result) {
+    CheckSizes(left, right);
+    result.resize(left.size());
+    RunArithmetic(divide_operation(), left.numerators(), left.denominators(),
+            right.numerators(), right.denominators(),
+            result.numerator_values.data(), result.denominator_values.data(),
+            left.size());
+}
+
+void CompareRationalArray(const rational_array& left,
+        const rational_array& right, std::vector<signed char>& result) {
+    CheckSizes(left, right);
+    result.resize(left.size());
+    switch (ActiveKernel()) {
+#ifdef RATIONAL_ARRAY_SIMD
+    case rational_kernel::avx512:
+        CompareAvx512(left.numerators(), left.denominators(),
+                right.numerators(), right.denominators(), result.data(),
+                left.size());
+        return;
+    case rational_kernel::avx2:
+        CompareAvx2(left.numerators(), left.denominators(),
+                right.numerators(), right.denominators(), result.data(),
+                left.size());
+        return;
+#endif
+    default:
+        CompareScalar(left.numerators(), left.denominators(),
+                right.numerators(), right.denominators(), result.data(),
+                left.size());
+        return;
+    }
+}
@@ -0,0 +1,158 @@
+#ifndef RATIONAL_ARRAY_H
+#define RATIONAL_ARRAY_H
+
+#include "rational.h"
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+/*
+ * Allocator, which returns memory aligned to `Alignment` bytes, so the
+ * buffers can be loaded by aligned vector instructions.
+ */
+template<typename T, std::size_t Alignment = 64>
+struct aligned_allocator {
+    typedef T value_type;
+
+    template<typename U>
+    struct rebind {
+        typedef aligned_allocator<U, Alignment> other;
+    };
+
+    aligned_allocator() = default;
+    template<typename U>
+    aligned_allocator(const aligned_allocator<U, Alignment>&) {}
+
+    T* allocate(std::size_t count) {
+        void* memory = nullptr;
+        if (posix_memalign(&memory, Alignment, count * sizeof(T)) != 0) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(memory);
+    }
+    void deallocate(T* pointer, std::size_t) {
+        std::free(pointer);
+    }
+};
+
+template<typename T, typename U, std::size_t Alignment>
+bool operator==(const aligned_allocator<T, Alignment>&,
+        const aligned_allocator<U, Alignment>&) {
+    return true;
+}
+
+template<typename T, typename U, std::size_t Alignment>
+bool operator!=(const aligned_allocator<T, Alignment>&,
+        const aligned_allocator<U, Alignment>&) {
+    return false;
+}
+
+/*
+ * Class rational_array. Array of `rational` in structure-of-arrays layout.
+ *
+ * Numerators and denominators are stored in separate 64-byte aligned
+ * buffers, so batch operations (see `AddRationalArray` and others) load
+ * several values with one vector instruction. Values are always
+ * normalized, like `rational`.
+ *
+ * Public:
+ * 1. `rational_array(size)` - class initializer, all values are `0/1`.
+ * Also can be created from `std::vector<rational>`.
+ * 2. `size()` - return number of values.
+ * 3. `resize(size)` - change number of values, new values are `0/1`.
+ * 4. `get(index)` - return value as `rational`.
+ * 5. `set(index, value)` - change value.
+ * 6. `push_back(value)` - add value to the end.
+ * 7. `numerators()`, `denominators()` - return buffers.
+ * 8. `toVector()` - return values as `std::vector<rational>`.
+ *
+ * Private:
+ * 1. `numerator_values` - buffer of numerators.
+ * 2. `denominator_values` - buffer of denominators.
+ */
+class rational_array {
+public:
+    typedef std::vector<int, aligned_allocator<int>> buffer_type;
+
+    explicit rational_array(std::size_t size = 0);
+    rational_array(const std::vector<rational>& values);
+
+    std::size_t size() const;
+    void resize(std::size_t size);
+    rational get(std::size_t index) const;
+    void set(std::size_t index, const rational& value);
+    void push_back(const rational& value);
+    const int* numerators() const;
+    const int* denominators() const;
+    std::vector<rational> toVector() const;
+
+    friend void AddRationalArray(const rational_array& left,
+            const rational_array& right, rational_array& result);
+    friend void SubtractRationalArray(const rational_array& left,
+            const rational_array& right, rational_array& result);
+    friend void MultiplyRationalArray(const rational_array& left,
+            const rational_array& right, rational_array& result);
+    friend void DivideRationalArray(const rational_array& left,
+            const rational_array& right, rational_array& result);
+
+private:
+    buffer_type numerator_values;
+    buffer_type denominator_values;
+};
+
+/*
+ * Element-wise operations: `result[i] = left[i] op right[i]`.
+ *
+ * Arrays must have equal size, otherwise logical error is raised.
+ * `result` is resized and can be the same object as `left` or `right`.
+ * Errors are the same as for `rational` operators: `std::overflow_error`,
+ * if value does not fit into `int`, logical error for division by zero.
+ * If error is raised, part of `result` can be already changed.
+ */
+void AddRationalArray(const rational_array& left, const rational_array& right,
+        rational_array& result);
+void SubtractRationalArray(const rational_array& left,
+        const rational_array& right, rational_array& result);
+void MultiplyRationalArray(const rational_array& left,
+        const rational_array& right, rational_array& result);
+void DivideRationalArray(const rational_array& left,
+        const rational_array& right, rational_array& result);
+
+/*
+ * Element-wise comparison: `result[i]` is -1, 0 or 1, if `left[i]` is
+ * less than, equal to or more than `right[i]`.
+ */
+void CompareRationalArray(const rational_array& left,
+        const rational_array& right, std::vector<signed char>& result);
+
+/*
+ * Implementations of batch operations.
+ *
+ * `scalar` - portable loop over `rational` kernels.
+ * `avx2` - 4 values per instruction.
+ * `avx512` - 8 values per instruction, needs AVX-512 F, CD and DQ.
+ *
+ * By default the best kernel supported by the CPU is used, it is detected
+ * at runtime, so the library is built without `-mavx2`.
+ */
+enum class rational_kernel {
+    scalar,
+    avx2,
+    avx512
+};
+
+/*
+ * Functions:
+ * `IsRationalKernelSupported(kernel)` - check, if CPU supports kernel.
+ * `DetectRationalKernel()` - return the best supported kernel.
+ * `GetRationalKernel()` - return kernel used by batch operations.
+ * `SetRationalKernel(kernel)` - change kernel used by batch operations,
+ * raises logical error, if kernel is not supported.
+ */
+bool IsRationalKernelSupported(rational_kernel kernel);
+rational_kernel DetectRationalKernel();
+rational_kernel GetRationalKernel();
+void SetRationalKernel(rational_kernel kernel);
+
+#endif /* RATIONAL_ARRAY_H */
@@ -0,0 +1,433 @@
+#include "rational_binary.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+
+/*
+ * Size of file header and block header in bytes.
+ */
+static const std::size_t BinaryHeaderSize = 32;
+static const std::size_t BinaryBlockHeaderSize = 16;
+
+/*
+ * Magic bytes at the beginning of the file.
+ */
+static const char BinaryMagic[8] = {'R', 'A', 'T', 'B', 'I', 'N', '0', '1'};
+
+/*
+ * Functions append little-endian number to the buffer.
+ */
+static void AppendUint32(std::vector<unsigned char>& buffer,
+        std::uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        buffer.push_back(static_cast<unsigned char>(value >> (8 * i)));
+    }
+}
+static void AppendUint64(std::vector<unsigned char>& buffer,
+        std::uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        buffer.push_back(static_cast<unsigned char>(value >> (8 * i)));
+    }
+}
+
+/*
+ * Function stores little-endian number at `data`.
+ */
+static void StoreUint32(unsigned char* data, std::uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        data[i] = static_cast<unsigned char>(value >> (8 * i));
+    }
+}
+
+/*
+ * Functions read little-endian number.
+ */
+static std::uint32_t ReadUint32(const unsigned char* data) {
+    return static_cast<std::uint32_t>(data[0]) |
+            static_cast<std::uint32_t>(data[1]) << 8 |
+            static_cast<std::uint32_t>(data[2]) << 16 |
+            static_cast<std::uint32_t>(data[3]) << 24;
+}
+static std::uint64_t ReadUint64(const unsigned char* data) {
+    return ReadUint32(data) | static_cast<std::uint64_t>(ReadUint32(data + 4)) << 32;
+}
+
+/*
+ * Function appends varint: 7 bits per byte, high bit is set in all
+ * bytes except the last one.
+ */
+static void AppendVarint(std::vector<unsigned char>& buffer,
+        std::uint32_t value) {
+    while (value >= 0x80) {
+        buffer.push_back(static_cast<unsigned char>(value | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back(static_cast<unsigned char>(value));
+}
+
+/*
+ * Function returns size of varint in bytes.
+ */
+static std::size_t VarintSize(std::uint32_t value) {
+    std::size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        size++;
+    }
+    return size;
+}
+
+/*
+ * Functions map signed numbers to unsigned: 0, -1, 1, -2, ... to
+ * 0, 1, 2, 3, ..., so numbers with small magnitude have short varints.
+ */
+static std::uint32_t EncodeZigzag(int value) {
+    return (static_cast<std::uint32_t>(value) << 1) ^
+            static_cast<std::uint32_t>(value >> 31);
+}
+static int DecodeZigzag(std::uint32_t value) {
+    return static_cast<int>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+/*
+ * Function raises runtime error about wrong file.
+ */
+[[noreturn]] static void RaiseBinaryError(const std::string& path) {
+    throw std::runtime_error("Error: wrong binary file `" + path + "`!");
+}
+
+/*
+ * Function reads varint from `[current, last)` and moves `current` past
+ * it. Raises runtime error, if varint is cut or does not fit into 32 bits.
+ */
+static std::uint32_t ReadVarint(const unsigned char*& current,
+        const unsigned char* last, const std::string& path) {
+    std::uint32_t value = 0;
+    for (int shift = 0; current != last; shift += 7) {
+        unsigned char byte = *current++;
+        if (shift == 28 && byte > 0x0F) {
+            RaiseBinaryError(path);
+        }
+        value |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+        if (byte < 0x80) {
+            return value;
+        }
+    }
+    RaiseBinaryError(path);
+}
+
+/*
+ * Function appends block of values `[first, last)` to the buffer.
+ * Runs of shared denominators are used, if they are allowed and make the
+ * block smaller.
+ */
+template<typename Values>
+static void AppendBlock(std::vector<unsigned char>& buffer,
+        const Values& values, std::size_t first, std::size_t last,
+        bool shared_denominators) {
+    std::size_t plain_size = 0, shared_size = 0;
+    for (std::size_t i = first; i < last; i++) {
+        std::uint32_t deno = static_cast<std::uint32_t>(values.denominator(i));
+        plain_size += VarintSize(deno);
+        if (i == first || deno != static_cast<std::uint32_t>(
+                values.denominator(i - 1))) {
+            // the run length is not known yet, one byte is the estimate.
+            shared_size += VarintSize(deno) + 1;
+        }
+    }
+    bool shared = shared_denominators && shared_size < plain_size;
+    std::size_t header = buffer.size();
+    buffer.resize(header + BinaryBlockHeaderSize);
+    std::size_t numerators = buffer.size();
+    for (std::size_t i = first; i < last; i++) {
+        AppendVarint(buffer, EncodeZigzag(values.numerator(i)));
+    }
+    std::size_t denominators = buffer.size();
+    if (shared) {
+        std::size_t run = first;
+        for (std::size_t i = first + 1; i <= last; i++) {
+            if (i == last || values.denominator(i) != values.denominator(run)) {
+                AppendVarint(buffer, static_cast<std::uint32_t>(i - run));
+                AppendVarint(buffer,
+                        static_cast<std::uint32_t>(values.denominator(run)));
+                run = i;
+            }
+        }
+    } else {
+        for (std::size_t i = first; i < last; i++) {
+            AppendVarint(buffer, static_cast<std::uint32_t>(values.denominator(i)));
+        }
+    }
+    StoreUint32(&buffer[header], static_cast<std::uint32_t>(last - first));
+    StoreUint32(&buffer[header + 4], shared ? BinarySharedDenominators : 0);
+    StoreUint32(&buffer[header + 8],
+            static_cast<std::uint32_t>(denominators - numerators));
+    StoreUint32(&buffer[header + 12],
+            static_cast<std::uint32_t>(buffer.size() - numerators));
+}
+
+/*
+ * Function writes `count` values to the binary file. `values` gives
+ * `numerator(i)` and `denominator(i)`. Blocks are encoded into one
+ * reused buffer, which is written, when it is large enough.
+ */
+template<typename Values>
+static void WriteBinary(const std::string& path, const Values& values,
+        std::size_t count, bool shared_denominators, std::uint32_t block_size) {
+    if (block_size == 0) {
+        throw std::logic_error("Error: block size == 0!");
+    }
+    std::size_t block_count = (count + block_size - 1) / block_size;
+    if (block_count > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::logic_error("Error: too many blocks!");
+    }
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("Error: can not open file `" + path + "`!");
+    }
+    std::vector<unsigned char> buffer(BinaryHeaderSize);
+    std::vector<std::uint64_t> offsets;
+    offsets.reserve(block_count);
+    std::uint64_t written = 0;
+    for (std::size_t first = 0; first < count; first += block_size) {
+        offsets.push_back(written + buffer.size());
+        AppendBlock(buffer, values, first,
+                std::min<std::size_t>(first + block_size, count),
+                shared_denominators);
+        if (buffer.size() >= (1 << 20)) {
+            file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+            written += buffer.size();
+            buffer.clear();
+        }
+    }
+    std::uint64_t index = written + buffer.size();
+    for (std::uint64_t offset : offsets) {
+        AppendUint64(buffer, offset);
+    }
+    file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    buffer.assign(BinaryMagic, BinaryMagic + 8);
+    AppendUint64(buffer, count);
+    AppendUint32(buffer, block_size);
+    AppendUint32(buffer, static_cast<std::uint32_t>(block_count));
+    AppendUint64(buffer, index);
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    file.close();
+    if (!file) {
+        throw std::runtime_error("Error: can not write file `" + path + "`!");
+    }
+}
+
+/*
+ * Access to numerators and denominators of vector and `rational_array`
+ * for `WriteBinary`.
+ */
+struct vector_values {
+    const std::vector<rational>& values;
+
+    int numerator(std::size_t index) const {
+        return values[index].numerator();
+    }
+    int denominator(std::size_t index) const {
+        return values[index].denominator();
+    }
+};
+
+struct array_values {
+    const int* numerators;
+    const int* denominators;
+
+    int numerator(std::size_t index) const {
+        return numerators[index];
+    }
+    int denominator(std::size_t index) const {
+        return denominators[index];
+    }
+};
+
+void WriteRationalBinary(const std::string& path,
+        const std::vector<rational>& values, bool shared_denominators,
+        std::uint32_t block_size) {
+    WriteBinary(path, vector_values{values}, values.size(), shared_denominators,
+            block_size);
+}
+
+void WriteRationalBinary(const std::string& path, const rational_array& values,
+        bool shared_denominators, std::uint32_t block_size) {
+    WriteBinary(path, array_values{values.numerators(), values.denominators()},
+            values.size(), shared_denominators, block_size);
+}
+
+/*
+ * Constructor class. Maps the file, checks header and block index.
+ */
+rational_binary_file::rational_binary_file(const std::string& path)
+    : file(path), path(path), count(0), block_size(0), block_count(0),
+      index(nullptr)
+{
+    const unsigned char* data =
+            reinterpret_cast<const unsigned char*>(file.data());
+    if (file.size() < BinaryHeaderSize ||
+            std::memcmp(data, BinaryMagic, 8) != 0) {
+        RaiseBinaryError(path);
+    }
+    std::uint64_t values = ReadUint64(data + 8);
+    block_size = ReadUint32(data + 16);
+    block_count = ReadUint32(data + 20);
+    std::uint64_t index_offset = ReadUint64(data + 24);
+    // Every value takes at least one byte, so sizes of buffers are
+    // checked before anything is allocated.
+    if (block_size == 0 || values > file.size() ||
+            values / block_size + (values % block_size != 0) != block_count ||
+            index_offset > file.size() ||
+            (file.size() - index_offset) / 8 != block_count ||
+            (file.size() - index_offset) % 8 != 0 ||
+            (block_count != 0 &&
+            index_offset < BinaryHeaderSize + BinaryBlockHeaderSize)) {
+        RaiseBinaryError(path);
+    }
+    count = static_cast<std::size_t>(values);
+    index = data + index_offset;
+    for (std::size_t block = 0; block < block_count; block++) {
+        std::uint64_t offset = ReadUint64(index + 8 * block);
+        std::uint64_t expected = block + 1 < block_count ? block_size
+                : values - static_cast<std::uint64_t>(block) * block_size;
+        if (offset < BinaryHeaderSize ||
+                offset > index_offset - BinaryBlockHeaderSize ||
+                ReadUint32(data + offset) != expected) {
+            RaiseBinaryError(path);
+        }
+    }
+}
+/*
+ * This function returns number of values.
+ */
+std::size_t rational_binary_file::size() const {
+    return count;
+}
+/*
+ * This function returns number of blocks.
+ */
+std::size_t rational_binary_file::blocks() const {
+    return block_count;
+}
+/*
+ * This function returns number of values in the full block.
+ */
+std::size_t rational_binary_file::blockSize() const {
+    return block_size;
+}
+/*
+ * This function decodes block and calls `function(i, value)` for every
+ * value, `i` is index inside the block. Raises runtime error, if block
+ * is wrong: columns do not match header, denominator is not positive.
+ */
+template<typename Function>
+void rational_binary_file::decodeBlock(std::size_t block,
+        Function function) const {
+    const unsigned char* base =
+            reinterpret_cast<const unsigned char*>(file.data());
+    std::uint64_t offset = ReadUint64(index + 8 * block);
+    const unsigned char* header = base + offset;
+    std::size_t values = ReadUint32(header);
+    std::uint32_t flags = ReadUint32(header + 4);
+    std::size_t numerators_size = ReadUint32(header + 8);
+    std::size_t payload_size = ReadUint32(header + 12);
+    std::size_t expected = block + 1 < block_count ? block_size
+            : count - block * block_size;
+    const unsigned char* numerators = header + BinaryBlockHeaderSize;
+    if (values != expected || numerators_size > payload_size ||
+            payload_size > static_cast<std::size_t>(index - numerators)) {
+        RaiseBinaryError(path);
+    }
+    const unsigned char* numerators_end = numerators + numerators_size;
+    const unsigned char* denominators = numerators_end;
+    const unsigned char* last = numerators + payload_size;
+    const std::uint32_t limit = integer_traits<int>::max();
+    std::size_t i = 0;
+    while (i < values) {
+        std::uint32_t run = 1;
+        if (flags & BinarySharedDenominators) {
+            run = ReadVarint(denominators, last, path);
+            if (run == 0 || run > values - i) {
+                RaiseBinaryError(path);
+            }
+        }
+        std::uint32_t deno = ReadVarint(denominators, last, path);
+        if (deno == 0 || deno > limit) {
+            RaiseBinaryError(path);
+        }
+        for (; run != 0; run--, i++) {
+            int num = DecodeZigzag(ReadVarint(numerators, numerators_end, path));
+            function(i, rational(num, static_cast<int>(deno)));
+        }
+    }
+    if (numerators != numerators_end || denominators != last) {
+        RaiseBinaryError(path);
+    }
+}
+/*
+ * This function returns value with index `index`. Raises out of range
+ * error, if there is no such value.
+ */
+rational rational_binary_file::get(std::size_t index) const {
+    if (index >= count) {
+        throw std::out_of_range("Error: index out of range!");
+    }
+    std::size_t position = index % block_size;
+    rational result;
+    decodeBlock(index / block_size, [&](std::size_t i, const rational& value) {
+        if (i == position) {
+            result = value;
+        }
+    });
+    return result;
+}
+/*
+ * This function replaces `values` by values of block `block`. Raises out
+ * of range error, if there is no such block.
+ */
+void rational_binary_file::readBlock(std::size_t block,
+        std::vector<rational>& values) const {
+    if (block >= block_count) {
+        throw std::out_of_range("Error: index out of range!");
+    }
+    std::size_t first = block * block_size;
+    values.resize(std::min(block_size, count - first));
+    decodeBlock(block, [&](std::size_t i, const rational& value) {
+        values[i] = value;
+    });
+}
+/*
+ * This function replaces `values` by all values of the file.
+ */
+void rational_binary_file::read(std::vector<rational>& values) const {
+    values.resize(count);
+    for (std::size_t block = 0; block < block_count; block++) {
+        rational* output = values.data() + block * block_size;
+        decodeBlock(block, [output](std::size_t i, const rational& value) {
+            output[i] = value;
+        });
+    }
+}
+void rational_binary_file::read(rational_array& values) const {
+    values.resize(count);
+    for (std::size_t block = 0; block < block_count; block++) {
+        std::size_t first = block * block_size;
+        decodeBlock(block, [&values, first](std::size_t i,
+                const rational& value) {
+            values.set(first + i, value);
+        });
+    }
+}
+
+void ReadRationalBinary(const std::string& path, std::vector<rational>& values) {
+    rational_binary_file(path).read(values);
+}
+
+void ReadRationalBinary(const std::string& path, rational_array& values) {
+    rational_binary_file(path).read(values);
+}
@@ -0,0 +1,107 @@
+#ifndef RATIONAL_BINARY_H
+#define RATIONAL_BINARY_H
+
+#include "rational.h"
+#include "rational_array.h"
+#include "mapped_file.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * Binary columnar format of `rational` values.
+ *
+ * File:
+ * 1. Header, 32 bytes: magic `RATBIN01`, number of values (8 bytes),
+ * values per block (4 bytes), number of blocks (4 bytes), offset of the
+ * block index (8 bytes).
+ * 2. Blocks of `block size` values (the last block can be smaller).
+ * 3. Block index: offset of every block (8 bytes each), so any block is
+ * found without reading the previous ones.
+ *
+ * Block:
+ * 1. Header, 16 bytes: number of values, flags, size of the numerator
+ * column, size of the whole block without header (4 bytes each).
+ * 2. Numerator column: zigzag varints (LEB128 of `(n << 1) ^ (n >> 31)`),
+ * so small negative numerators take one byte.
+ * 3. Denominator column: varints, denominators are positive. With flag
+ * `BinarySharedDenominators` the column is a list of runs: number of
+ * values and their common denominator.
+ *
+ * All fixed-size numbers are little-endian.
+ */
+const std::uint32_t BinaryBlockSize = 4096;
+const std::uint32_t BinarySharedDenominators = 1;
+
+/*
+ * Functions write values to the binary file, the file is created or
+ * truncated. Raises runtime error, if file can not be written.
+ *
+ * If `shared_denominators` is `true`, block stores runs of equal
+ * denominators, when it makes the block smaller.
+ */
+void WriteRationalBinary(const std::string& path,
+        const std::vector<rational>& values, bool shared_denominators = true,
+        std::uint32_t block_size = BinaryBlockSize);
+void WriteRationalBinary(const std::string& path, const rational_array& values,
+        bool shared_denominators = true,
+        std::uint32_t block_size = BinaryBlockSize);
+
+/*
+ * Class rational_binary_file. Binary file of rationals, mapped into
+ * memory for reading.
+ *
+ * Header and block index are checked, when the file is opened, blocks
+ * are checked, when they are decoded. Wrong file raises runtime error,
+ * decoded values are normalized.
+ *
+ * Public:
+ * 1. `rational_binary_file(path)` - class initializer, maps the file.
+ * 2. `size()` - return number of values.
+ * 3. `blocks()`, `blockSize()` - return number of blocks and values per
+ * block.
+ * 4. `get(index)` - return one value, only its block is decoded.
+ * 5. `readBlock(block, values)` - replace `values` by values of block.
+ * 6. `read(values)` - replace `values` (vector or `rational_array`) by all
+ * values. Memory is allocated once.
+ *
+ * Private:
+ * 1. `file` - mapped file.
+ * 2. `count` - number of values.
+ * 3. `block_size` - values per block.
+ * 4. `block_count` - number of blocks.
+ * 5. `index` - block index inside the mapped file.
+ * 6. `decodeBlock` - call `function(i, value)` for values of block.
+ */
+class rational_binary_file {
+public:
+    explicit rational_binary_file(const std::string& path);
+
+    std::size_t size() const;
+    std::size_t blocks() const;
+    std::size_t blockSize() const;
+    rational get(std::size_t index) const;
+    void readBlock(std::size_t block, std::vector<rational>& values) const;
+    void read(std::vector<rational>& values) const;
+    void read(rational_array& values) const;
+
+private:
+    mapped_file file;
+    std::string path;
+    std::size_t count;
+    std::size_t block_size;
+    std::size_t block_count;
+    const unsigned char* index;
+
+    template<typename Function>
+    void decodeBlock(std::size_t block, Function function) const;
+};
+
+/*
+ * Functions read all values of the binary file.
+ */
+void ReadRationalBinary(const std::string& path, std::vector<rational>& values);
+void ReadRationalBinary(const std::string& path, rational_array& values);
+
+#endif /* RATIONAL_BINARY_H */
@@ -0,0 +1,371 @@
+#include "rational_decimal.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+/*
+ * Numbers below this bound are factorized by trial division only.
+ */
+static const unsigned long long TrialDivisionLimit = 1 << 10;
+
+/*
+ * Function returns `a * b mod modulus` without overflow.
+ */
+static unsigned long long MultiplyModulo(unsigned long long a,
+        unsigned long long b, unsigned long long modulus) {
+    return static_cast<unsigned long long>(
+            static_cast<unsigned __int128>(a) * b % modulus);
+}
+
+/*
+ * Function returns `base^exponent mod modulus` by binary exponentiation.
+ */
+static unsigned long long PowerModulo(unsigned long long base,
+        unsigned long long exponent, unsigned long long modulus) {
+    unsigned long long result = 1 % modulus;
+    base %= modulus;
+    while (exponent) {
+        if (exponent & 1) {
+            result = MultiplyModulo(result, base, modulus);
+        }
+        base = MultiplyModulo(base, base, modulus);
+        exponent >>= 1;
+    }
+    return result;
+}
+
+/*
+ * Function checks, if odd `n > 2` is prime. Miller-Rabin test with the
+ * first 12 primes as bases is exact for all 64-bit numbers.
+ */
+static bool IsPrime(unsigned long long n) {
+    static const unsigned long long bases[] = {2, 3, 5, 7, 11, 13, 17, 19,
+            23, 29, 31, 37};
+    unsigned long long odd = n - 1;
+    int shift = CountTrailingZeros(odd);
+    odd >>= shift;
+    for (unsigned long long base : bases) {
+        if (base % n == 0) {
+            return true;
+        }
+        unsigned long long x = PowerModulo(base, odd, n);
+        if (x == 1 || x == n - 1) {
+            continue;
+        }
+        bool composite = true;
+        for (int i = 1; i < shift && composite; i++) {
+            x = MultiplyModulo(x, x, n);
+            composite = x != n - 1;
+        }
+        if (composite) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Function returns a nontrivial divisor of odd composite `n` by Pollard's
+ * rho algorithm with Brent's cycle detection. Differences are multiplied
+ * in batches, so GCD is computed once per batch.
+ */
+static unsigned long long PollardRho(unsigned long long n) {
+    const unsigned long long batch = 128;
+    for (unsigned long long increment = 1;; increment++) {
+        auto next = [n, increment](unsigned long long x) {
+            return (MultiplyModulo(x, x, n) + increment) % n;
+        };
+        unsigned long long x = 2, y = 2, saved = 2, product = 1, divisor = 1;
+        for (unsigned long long length = 1; divisor == 1; length <<= 1) {
+            x = y;
+            for (unsigned long long i = 0; i < length; i++) {
+                y = next(y);
+            }
+            for (unsigned long long k = 0; k < length && divisor == 1;
+                    k += batch) {
+                saved = y;
+                unsigned long long steps = std::min(batch, length - k);
+                for (unsigned long long i = 0; i < steps; i++) {
+                    y = next(y);
+                    product = MultiplyModulo(product, x > y ? x - y : y - x, n);
+                }
+                divisor = BinaryGreatestCommonDivisor(product, n);
+            }
+        }
+        if (divisor == n) {
+            // The batch passed the cycle, repeat it step by step.
+            do {
+                saved = next(saved);
+                divisor = BinaryGreatestCommonDivisor(x > saved ? x - saved
+                        : saved - x, n);
+            } while (divisor == 1);
+        }
+        if (divisor != n) {
+            return divisor;
+        }
+    }
+}
+
+/*
+ * Function adds prime factors of `n > 1` with multiplicity to `factors`.
+ */
+static void FactorizeLarge(unsigned long long n,
+        std::vector<unsigned long long>& factors) {
+    if (n < TrialDivisionLimit * TrialDivisionLimit || IsPrime(n)) {
+        factors.push_back(n);
+        return;
+    }
+    unsigned long long divisor = PollardRho(n);
+    FactorizeLarge(divisor, factors);
+    FactorizeLarge(n / divisor, factors);
+}
+
+/*
+ * Function returns sorted prime factors of `n` with multiplicity. Small
+ * factors are found by trial division, the rest (which has no factors
+ * below `TrialDivisionLimit`) by `FactorizeLarge`.
+ */
+static std::vector<unsigned long long> Factorize(unsigned long long n) {
+    std::vector<unsigned long long> factors;
+    for (unsigned long long p = 2; p < TrialDivisionLimit && p * p <= n;
+            p += p == 2 ? 1 : 2) {
+        while (n % p == 0) {
+            factors.push_back(p);
+            n /= p;
+        }
+    }
+    if (n > 1) {
+        FactorizeLarge(n, factors);
+    }
+    std::sort(factors.begin(), factors.end());
+    return factors;
+}
+
+unsigned long long MultiplicativeOrder(unsigned long long base,
+        unsigned long long modulus) {
+    if (modulus == 0 || BinaryGreatestCommonDivisor(base, modulus) != 1) {
+        throw std::logic_error("Error: base and modulus are not coprime!");
+    }
+    if (modulus == 1) {
+        return 1;
+    }
+    // Euler's function and its distinct prime factors.
+    std::vector<unsigned long long> factors = Factorize(modulus);
+    unsigned long long totient = 1;
+    std::vector<unsigned long long> primes;
+    for (std::size_t i = 0; i < factors.size(); i++) {
+        if (i > 0 && factors[i] == factors[i - 1]) {
+            totient *= factors[i];
+            primes.push_back(factors[i]);
+        } else {
+            totient *= factors[i] - 1;
+            if (factors[i] > 2) {
+                std::vector<unsigned long long> lower = Factorize(factors[i] - 1);
+                primes.insert(primes.end(), lower.begin(), lower.end());
+            }
+        }
+    }
+    std::sort(primes.begin(), primes.end());
+    primes.erase(std::unique(primes.begin(), primes.end()), primes.end());
+    unsigned long long order = totient;
+    for (unsigned long long prime : primes) {
+        while (order % prime == 0 &&
+                PowerModulo(base, order / prime, modulus) == 1) {
+            order /= prime;
+        }
+    }
+    return order;
+}
+
+void DecimalPeriod(unsigned long long denominator, std::size_t& preperiod,
+        unsigned long long& period) {
+    if (denominator == 0) {
+        throw std::logic_error("Error: denominator == 0!");
+    }
+    std::size_t twos = CountTrailingZeros(denominator);
+    denominator >>= twos;
+    std::size_t fives = 0;
+    while (denominator % 5 == 0) {
+        denominator /= 5;
+        fives++;
+    }
+    preperiod = std::max(twos, fives);
+    period = denominator == 1 ? 0 : MultiplicativeOrder(10, denominator);
+}
+
+/*
+ * Powers of 10 up to `10^19`.
+ */
+static const unsigned long long DecimalPowers[] = {1ULL, 10ULL, 100ULL,
+        1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL,
+        1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+        10000000000000ULL, 100000000000000ULL, 1000000000000000ULL,
+        10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL,
+        10000000000000000000ULL};
+
+/*
+ * Function writes `count` digits of the fraction `remainder/denominator`
+ * (`remainder < denominator`) to `first` by long division, `Chunk` digits
+ * per step: `remainder * 10^Chunk` is computed in `Wide` and divided
+ * once. `remainder` is updated. Returns end of written digits.
+ */
+template<typename Wide, int Chunk>
+static char* FormatFractionDigits(char* first, unsigned long long& remainder,
+        unsigned long long denominator, std::size_t count) {
+    const Wide scale = DecimalPowers[Chunk];
+    Wide current = remainder;
+    for (; count >= Chunk; count -= Chunk) {
+        Wide scaled = current * scale;
+        unsigned long long digits =
+                static_cast<unsigned long long>(scaled / denominator);
+        current = scaled % denominator;
+        first += Chunk;
+        FormatDigits(first, digits, Chunk);
+    }
+    if (count) {
+        Wide scaled = current * DecimalPowers[count];
+        unsigned long long digits =
+                static_cast<unsigned long long>(scaled / denominator);
+        current = scaled % denominator;
+        first += count;
+        FormatDigits(first, digits, static_cast<int>(count));
+    }
+    remainder = static_cast<unsigned long long>(current);
+    return first;
+}
+
+/*
+ * Function selects width of long division: 9 digits in 64 bits, if
+ * `denominator < 2^32`, otherwise 19 digits in `__int128`.
+ */
+static char* FormatFraction(char* first, unsigned long long& remainder,
+        unsigned long long denominator, std::size_t count) {
+    if (denominator >> 32 == 0) {
+        return FormatFractionDigits<unsigned long long, 9>(first, remainder,
+                denominator, count);
+    }
+    return FormatFractionDigits<unsigned __int128, 19>(first, remainder,
+            denominator, count);
+}
+
+/*
+ * Function checks, if the magnitude must be rounded up: `remainder` is
+ * the rest of the division after the last digit, `odd` - parity of the
+ * last digit.
+ */
+static bool RoundUp(rounding_mode rounding, bool negative,
+        unsigned long long remainder, unsigned long long denominator,
+        bool odd) {
+    if (remainder == 0) {
+        return false;
+    }
+    // `remainder / denominator` compared with 1/2 without overflow.
+    unsigned long long rest = denominator - remainder;
+    switch (rounding) {
+    case rounding_mode::half_even:
+        return remainder > rest || (remainder == rest && odd);
+    case rounding_mode::half_away_from_zero:
+        return remainder >= rest;
+    case rounding_mode::toward_zero:
+        return false;
+    case rounding_mode::floor:
+        return negative;
+    case rounding_mode::ceiling:
+        return !negative;
+    }
+    return false;
+}
+
+format_result FormatDecimalMagnitude(char* first, char* last, bool negative,
+        unsigned long long numerator, unsigned long long denominator,
+        std::size_t digits, rounding_mode rounding) {
+    if (denominator == 0) {
+        throw std::logic_error("Error: denominator == 0!");
+    }
+    unsigned long long integer = numerator / denominator;
+    unsigned long long remainder = numerator % denominator;
+    std::size_t length = negative + CountDecimalDigits(integer) +
+            (digits ? digits + 1 : 0);
+    if (static_cast<std::size_t>(last - first) < length) {
+        return {last, std::errc::value_too_large};
+    }
+    char* current = first;
+    if (negative) {
+        *current++ = '-';
+    }
+    char* integer_first = current;
+    current = FormatUnsigned(current, integer);
+    if (digits) {
+        *current++ = '.';
+        current = FormatFraction(current, remainder, denominator, digits);
+    }
+    if (!RoundUp(rounding, negative, remainder, denominator,
+            (current[-1] - '0') & 1)) {
+        return {current, std::errc()};
+    }
+    // Carry from the last digit, the point is skipped.
+    char* digit = current;
+    while (digit != integer_first) {
+        --digit;
+        if (*digit == '.') {
+            continue;
+        }
+        if (*digit != '9') {
+            ++*digit;
+            return {current, std::errc()};
+        }
+        *digit = '0';
+    }
+    // All digits were 9: `99.9` becomes `100.0`.
+    if (current == last) {
+        return {last, std::errc::value_too_large};
+    }
+    std::memmove(integer_first + 1, integer_first, current - integer_first);
+    *integer_first = '1';
+    return {current + 1, std::errc()};
+}
+
+format_result FormatRepeatingDecimalMagnitude(char* first, char* last,
+        bool negative, unsigned long long numerator,
+        unsigned long long denominator) {
+    std::size_t preperiod = 0;
+    unsigned long long period = 0;
+    DecimalPeriod(denominator, preperiod, period);
+    unsigned long long integer = numerator / denominator;
+    unsigned long long remainder = numerator % denominator;
+    if (remainder == 0) {
+        preperiod = 0;
+        period = 0;
+    }
+    std::size_t available = last - first;
+    std::size_t length = negative + CountDecimalDigits(integer);
+    if (preperiod || period) {
+        length += 1 + preperiod;
+    }
+    if (period && (period > available || length + period + 2 > available)) {
+        return {last, std::errc::value_too_large};
+    }
+    if (period) {
+        length += period + 2;
+    }
+    if (length > available) {
+        return {last, std::errc::value_too_large};
+    }
+    char* current = first;
+    if (negative) {
+        *current++ = '-';
+    }
+    current = FormatUnsigned(current, integer);
+    if (preperiod || period) {
+        *current++ = '.';
+        current = FormatFraction(current, remainder, denominator, preperiod);
+    }
+    if (period) {
+        *current++ = '(';
+        current = FormatFraction(current, remainder, denominator,
+                static_cast<std::size_t>(period));
+        *current++ = ')';
+    }
+    return {current, std::errc()};
+}
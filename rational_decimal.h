@@ -0,0 +1,111 @@
+#ifndef RATIONAL_DECIMAL_H
+#define RATIONAL_DECIMAL_H
+
+#include "rational.h"
+#include "rational_io.h"
+#include <cstddef>
+
+/*
+ * Rounding of the last decimal digit.
+ *
+ * `half_even` - to the nearest, ties to even digit.
+ * `half_away_from_zero` - to the nearest, ties away from zero.
+ * `toward_zero` - digits are truncated.
+ * `floor` - toward minus infinity.
+ * `ceiling` - toward plus infinity.
+ */
+enum class rounding_mode {
+    half_even,
+    half_away_from_zero,
+    toward_zero,
+    floor,
+    ceiling,
+};
+
+/*
+ * Function returns the multiplicative order of `base` modulo `modulus`:
+ * the smallest `k > 0` with `base^k = 1 (mod modulus)`. Raises logical
+ * error, if `base` and `modulus` are not coprime or `modulus` is zero.
+ *
+ * The order divides Euler's function of `modulus`, so `modulus` and
+ * `p - 1` of its prime factors are factorized (trial division, then
+ * Miller-Rabin test and Pollard's rho for large factors) and prime
+ * factors are removed from Euler's function, while the power stays 1.
+ */
+unsigned long long MultiplicativeOrder(unsigned long long base,
+        unsigned long long modulus);
+
+/*
+ * Function computes the shape of the decimal expansion of `n/denominator`
+ * (`n` is coprime with `denominator`): `preperiod` digits, which do not
+ * repeat, and length of the repeating part `period` (0, if the expansion
+ * terminates). For `denominator = 2^a * 5^b * m`, `preperiod = max(a, b)`
+ * and `period` is the multiplicative order of 10 modulo `m`.
+ */
+void DecimalPeriod(unsigned long long denominator, std::size_t& preperiod,
+        unsigned long long& period);
+
+/*
+ * Functions format normalized magnitude `numerator/denominator` with
+ * sign, see `FormatDecimal` and `FormatRepeatingDecimal`.
+ */
+format_result FormatDecimalMagnitude(char* first, char* last, bool negative,
+        unsigned long long numerator, unsigned long long denominator,
+        std::size_t digits, rounding_mode rounding);
+format_result FormatRepeatingDecimalMagnitude(char* first, char* last,
+        bool negative, unsigned long long numerator,
+        unsigned long long denominator);
+
+/*
+ * Function writes rational as decimal with exactly `digits` digits after
+ * the point to `[first, last)`, rounded by `rounding`: `2/3` with 3
+ * digits is `0.667`, with 0 digits `1`. Negative values keep the sign,
+ * also if they are rounded to zero (`-0.00`), like `printf`.
+ *
+ * Digits are produced by long division with wide multiplication: 9
+ * digits per step for denominators below `2^32` (64-bit arithmetic),
+ * otherwise 19 digits per step in `__int128`. No terminating zero is
+ * written. Types up to `long long` are supported.
+ */
+template<typename T, typename OverflowPolicy>
+format_result FormatDecimal(char* first, char* last,
+        const basic_rational<T, OverflowPolicy>& value, std::size_t digits,
+        rounding_mode rounding = rounding_mode::half_even)
+{
+    static_assert(sizeof(T) <= sizeof(long long),
+            "decimal format supports types up to long long");
+    typedef typename integer_traits<T>::unsigned_type unsigned_type;
+    unsigned_type magnitude = static_cast<unsigned_type>(value.numerator());
+    if (value.numerator() < 0) {
+        magnitude = ~magnitude + 1;
+    }
+    return FormatDecimalMagnitude(first, last, value.numerator() < 0,
+            magnitude, static_cast<unsigned long long>(value.denominator()),
+            digits, rounding);
+}
+
+/*
+ * Function writes exact decimal expansion of rational to `[first, last)`,
+ * the repeating part is in parentheses: `1/3` is `0.(3)`, `1/6` is
+ * `0.1(6)`, `1/4` is `0.25`, `-22/7` is `-3.(142857)`.
+ *
+ * Length of the expansion is known before digits are produced (see
+ * `DecimalPeriod`), so `std::errc::value_too_large` is returned at once,
+ * if it does not fit. Types up to `long long` are supported.
+ */
+template<typename T, typename OverflowPolicy>
+format_result FormatRepeatingDecimal(char* first, char* last,
+        const basic_rational<T, OverflowPolicy>& value)
+{
+    static_assert(sizeof(T) <= sizeof(long long),
+            "decimal format supports types up to long long");
+    typedef typename integer_traits<T>::unsigned_type unsigned_type;
+    unsigned_type magnitude = static_cast<unsigned_type>(value.numerator());
+    if (value.numerator() < 0) {
+        magnitude = ~magnitude + 1;
+    }
+    return FormatRepeatingDecimalMagnitude(first, last, value.numerator() < 0,
+            magnitude, static_cast<unsigned long long>(value.denominator()));
+}
+
+#endif /* RATIONAL_DECIMAL_H */
@@ -0,0 +1,355 @@
+#ifndef RATIONAL_DOT_H
+#define RATIONAL_DOT_H
+
+#include "rational.h"
+#include "arithmetic.h"
+#include "lazy_rational.h"
+#include "rational_expression.h"
+#include "rational_reduce.h"
+#include "thread_pool.h"
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+/*
+ * Function returns integer `value` as `Rational`. If it does not fit into
+ * `T`, it is built from digits in base `max(T)` (with the sign of
+ * `value`) by eager operators, so overflow policy of `Rational` applies.
+ */
+template<typename Rational>
+Rational FusedInteger(fused_integer value) {
+    typedef typename Rational::value_type value_type;
+    if (FitsFused<value_type>(value)) {
+        return Rational(static_cast<value_type>(value));
+    }
+    typedef unsigned __int128 unsigned_fused;
+    const value_type base = integer_traits<value_type>::max();
+    unsigned_fused magnitude = value < 0
+            ? -static_cast<unsigned_fused>(value)
+            : static_cast<unsigned_fused>(value);
+    value_type digits[8];
+    std::size_t count = 0;
+    for (; magnitude != 0; magnitude /= base) {
+        value_type digit = static_cast<value_type>(magnitude % base);
+        digits[count++] = value < 0 ? -digit : digit;
+    }
+    Rational result(digits[--count]);
+    while (count > 0) {
+        result = result * Rational(base) + Rational(digits[--count]);
+    }
+    return result;
+}
+
+/*
+ * Function returns reduced `n/d` (`d > 0`), which does not fit into `T`,
+ * as `Rational`. The value is expanded into continued fraction
+ * `a0 + 1/(a1 + 1/(a2 + ...))`, which is evaluated from the last term by
+ * eager operators: the result is exact as long as it fits, otherwise
+ * overflow policy of `Rational` applies (overflow error, saturation).
+ */
+template<typename Rational>
+Rational NarrowFused(fused_integer n, fused_integer d) {
+    std::vector<fused_integer> terms;
+    while (d != 0) {
+        fused_integer term = n / d;
+        fused_integer remainder = n % d;
+        if (remainder < 0) {
+            term--;
+            remainder += d;
+        }
+        terms.push_back(term);
+        n = d;
+        d = remainder;
+    }
+    Rational result = FusedInteger<Rational>(terms.back());
+    for (std::size_t i = terms.size() - 1; i > 0; i--) {
+        result = FusedInteger<Rational>(terms[i - 1]) + Rational(1) / result;
+    }
+    return result;
+}
+
+/*
+ * Class rational_accumulator. Sum of products `x * y`, which is kept
+ * unreduced in `__int128`.
+ *
+ * Every product is cross-cancelled (like `MultiplyRational`), so its
+ * numerator and denominator are as small as possible, then it is added
+ * to the accumulator without GCD. Equal denominators (or one dividing
+ * the other) are added without growth. Only if the sum overflows
+ * `__int128`, the accumulator is reduced and the product is added over
+ * the least common denominator. If that still overflows, the step is
+ * done by eager operators of `Rational`, so errors are the same as in
+ * `acc += x * y`.
+ *
+ * Types wider than `long long` are not supported.
+ *
+ * Public:
+ * 1. `rational_accumulator(value)` - class initializer, by default zero.
+ * 2. `fma(x, y)` - add `x * y`.
+ * 3. `add(x)` - add `x`.
+ * 4. `addSquare(x)` - add `x * x`, it is already reduced, so there is no
+ * GCD.
+ * 5. `merge(other)` - add value of other accumulator.
+ * 6. `tryFma(x, y)`, `tryAdd(x)`, `tryAddSquare(x)`, `tryMerge(other)` -
+ * the same without fallback: return `false`, if the sum does not fit into
+ * `__int128` after reduction, the value is not changed then.
+ * 7. `value()` - return reduced sum. If the sum does not fit into `T`,
+ * it is built by eager operators (see `NarrowFused`), so overflow policy
+ * of `Rational` applies like in `acc += x * y`.
+ * 8. `fusedNumerator()`, `fusedDenominator()` - return unreduced sum,
+ * denominator is positive.
+ *
+ * Private:
+ * 1. `numerator_value`, `denominator_value` - unreduced sum.
+ * 2. `accumulate(n, d)` - add unreduced `n/d`, return `false` on overflow.
+ */
+template<typename Rational>
+class rational_accumulator {
+public:
+    typedef Rational rational_type;
+    typedef typename Rational::value_type value_type;
+
+    static_assert(sizeof(value_type) <= sizeof(long long),
+            "accumulator supports types up to long long");
+
+    constexpr rational_accumulator()
+        : numerator_value(0), denominator_value(1) {}
+    constexpr explicit rational_accumulator(const Rational& value)
+        : numerator_value(value.numerator()),
+        denominator_value(value.denominator()) {}
+
+    void fma(const Rational& x, const Rational& y);
+    void add(const Rational& x);
+    void addSquare(const Rational& x);
+    void merge(const rational_accumulator& other);
+    bool tryFma(const Rational& x, const Rational& y);
+    bool tryAdd(const Rational& x);
+    bool tryAddSquare(const Rational& x);
+    bool tryMerge(const rational_accumulator& other);
+    Rational value() const;
+
+    constexpr fused_integer fusedNumerator() const {
+        return numerator_value;
+    }
+    constexpr fused_integer fusedDenominator() const {
+        return denominator_value;
+    }
+
+private:
+    fused_integer numerator_value;
+    fused_integer denominator_value;
+
+    bool accumulate(fused_integer n, fused_integer d);
+};
+
+/*
+ * This function adds `n/d` (`d > 0`) to the accumulator. If the lazy sum
+ * overflows, both values are reduced and added over
+ * `lcm(denominator, d)`. Returns `false`, if it still overflows, the
+ * accumulator is not changed then.
+ */
+template<typename Rational>
+bool rational_accumulator<Rational>::accumulate(fused_integer n,
+        fused_integer d) {
+    checked_arithmetic<fused_integer> arithmetic;
+    fused_integer num = 0, deno = 1;
+    LazyAddRational<false>(arithmetic, numerator_value, denominator_value,
+            n, d, num, deno);
+    if (arithmetic.overflow) {
+        ReduceFused(numerator_value, denominator_value);
+        ReduceFused(n, d);
+        checked_arithmetic<fused_integer> reduced;
+        AddRational<false>(reduced, numerator_value, denominator_value, n, d,
+                num, deno);
+        if (reduced.overflow) {
+            return false;
+        }
+    }
+    numerator_value = num;
+    denominator_value = deno;
+    return true;
+}
+
+/*
+ * This function adds cross-cancelled product `x * y`.
+ */
+template<typename Rational>
+bool rational_accumulator<Rational>::tryFma(const Rational& x,
+        const Rational& y) {
+    value_type gcd1 = GreatestCommonDivisor(x.numerator(), y.denominator());
+    value_type gcd2 = GreatestCommonDivisor(y.numerator(), x.denominator());
+    fused_integer n = static_cast<fused_integer>(x.numerator() / gcd1) *
+            (y.numerator() / gcd2);
+    fused_integer d = static_cast<fused_integer>(x.denominator() / gcd2) *
+            (y.denominator() / gcd1);
+    return accumulate(n, d);
+}
+
+template<typename Rational>
+bool rational_accumulator<Rational>::tryAdd(const Rational& x) {
+    return accumulate(x.numerator(), x.denominator());
+}
+
+template<typename Rational>
+bool rational_accumulator<Rational>::tryAddSquare(const Rational& x) {
+    fused_integer n = static_cast<fused_integer>(x.numerator()) *
+            x.numerator();
+    fused_integer d = static_cast<fused_integer>(x.denominator()) *
+            x.denominator();
+    return accumulate(n, d);
+}
+
+template<typename Rational>
+bool rational_accumulator<Rational>::tryMerge(
+        const rational_accumulator& other) {
+    return accumulate(other.numerator_value, other.denominator_value);
+}
+
+/*
+ * Functions fall back to eager operators of `Rational`, if the sum does
+ * not fit into `__int128`.
+ */
+template<typename Rational>
+void rational_accumulator<Rational>::fma(const Rational& x,
+        const Rational& y) {
+    if (!tryFma(x, y)) {
+        *this = rational_accumulator(value() + x * y);
+    }
+}
+
+template<typename Rational>
+void rational_accumulator<Rational>::add(const Rational& x) {
+    if (!tryAdd(x)) {
+        *this = rational_accumulator(value() + x);
+    }
+}
+
+template<typename Rational>
+void rational_accumulator<Rational>::addSquare(const Rational& x) {
+    if (!tryAddSquare(x)) {
+        *this = rational_accumulator(value() + x * x);
+    }
+}
+
+template<typename Rational>
+void rational_accumulator<Rational>::merge(const rational_accumulator& other) {
+    if (!tryMerge(other)) {
+        *this = rational_accumulator(value() + other.value());
+    }
+}
+
+/*
+ * This function reduces the sum once.
+ */
+template<typename Rational>
+Rational rational_accumulator<Rational>::value() const {
+    fused_integer n = numerator_value, d = denominator_value;
+    if (!FitsFused<value_type>(n) || !FitsFused<value_type>(d)) {
+        ReduceFused(n, d);
+        if (!FitsFused<value_type>(n) || !FitsFused<value_type>(d)) {
+            return NarrowFused<Rational>(n, d);
+        }
+    }
+    return Rational(static_cast<value_type>(n), static_cast<value_type>(d));
+}
+
+/*
+ * Functions of fused multiply-accumulate.
+ *
+ * `RationalFma(accumulator, x, y)` adds `x * y` to the accumulator
+ * without reduction, `RationalFma(a, x, y)` returns `a + x * y` with one
+ * normalization.
+ */
+template<typename Rational>
+void RationalFma(rational_accumulator<Rational>& accumulator,
+        const Rational& x, const Rational& y) {
+    accumulator.fma(x, y);
+}
+
+template<typename T, typename OverflowPolicy>
+basic_rational<T, OverflowPolicy> RationalFma(
+        const basic_rational<T, OverflowPolicy>& a,
+        const basic_rational<T, OverflowPolicy>& x,
+        const basic_rational<T, OverflowPolicy>& y) {
+    rational_accumulator<basic_rational<T, OverflowPolicy>> accumulator(a);
+    accumulator.fma(x, y);
+    return accumulator.value();
+}
+
+/*
+ * Function returns `x[0] * y[0] + ... + x[count-1] * y[count-1]`,
+ * computed by `rational_accumulator` and reduced once.
+ *
+ * The result is equal to the serial `acc += x[i] * y[i]`. Intermediate
+ * values, which do not fit into `T`, do not raise errors, if the result
+ * fits. If the result does not fit, overflow policy applies: overflow
+ * error or saturation.
+ */
+template<typename T, typename OverflowPolicy>
+basic_rational<T, OverflowPolicy> RationalDot(
+        const basic_rational<T, OverflowPolicy>* x,
+        const basic_rational<T, OverflowPolicy>* y, std::size_t count) {
+    rational_accumulator<basic_rational<T, OverflowPolicy>> accumulator;
+    for (std::size_t i = 0; i < count; i++) {
+        accumulator.fma(x[i], y[i]);
+    }
+    return accumulator.value();
+}
+
+/*
+ * Parallel version: chunks of `RationalReduceChunk` products are
+ * accumulated by threads of `pool`, then accumulators are merged in index
+ * order, so the result does not depend on the number of threads.
+ */
+template<typename T, typename OverflowPolicy>
+basic_rational<T, OverflowPolicy> RationalDot(
+        const basic_rational<T, OverflowPolicy>* x,
+        const basic_rational<T, OverflowPolicy>* y, std::size_t count,
+        thread_pool& pool) {
+    typedef rational_accumulator<basic_rational<T, OverflowPolicy>>
+            accumulator_type;
+    if (count <= RationalReduceChunk) {
+        return RationalDot(x, y, count);
+    }
+    std::size_t chunks = (count + RationalReduceChunk - 1) / RationalReduceChunk;
+    std::vector<accumulator_type> partial(chunks);
+    pool.parallelFor(chunks, [&](std::size_t chunk) {
+        std::size_t begin = chunk * RationalReduceChunk;
+        std::size_t end = count - begin < RationalReduceChunk
+                ? count : begin + RationalReduceChunk;
+        for (std::size_t i = begin; i < end; i++) {
+            partial[chunk].fma(x[i], y[i]);
+        }
+    });
+    for (std::size_t chunk = 1; chunk < chunks; chunk++) {
+        partial[0].merge(partial[chunk]);
+    }
+    return partial[0].value();
+}
+
+/*
+ * Overloads for `std::vector`. Raise logical error, if vectors have
+ * different sizes.
+ */
+template<typename T, typename OverflowPolicy>
+basic_rational<T, OverflowPolicy> RationalDot(
+        const std::vector<basic_rational<T, OverflowPolicy>>& x,
+        const std::vector<basic_rational<T, OverflowPolicy>>& y) {
+    if (x.size() != y.size()) {
+        throw std::logic_error("Error: vectors have different sizes!");
+    }
+    return RationalDot(x.data(), y.data(), x.size());
+}
+
+template<typename T, typename OverflowPolicy>
+basic_rational<T, OverflowPolicy> RationalDot(
+        const std::vector<basic_rational<T, OverflowPolicy>>& x,
+        const std::vector<basic_rational<T, OverflowPolicy>>& y,
+        thread_pool& pool) {
+    if (x.size() != y.size()) {
+        throw std::logic_error("Error: vectors have different sizes!");
+    }
+    return RationalDot(x.data(), y.data(), x.size(), pool);
+}
+
+#endif /* RATIONAL_DOT_H */
@@ -0,0 +1,308 @@
+#ifndef RATIONAL_EXPRESSION_H
+#define RATIONAL_EXPRESSION_H
+
+#include "rational.h"
+#include "arithmetic.h"
+#include "lazy_rational.h"
+#include <type_traits>
+
+/*
+ * Expression templates, which evaluate a whole expression with one
+ * normalization.
+ *
+ * `Fuse(a) * b + Fuse(c) * d - e` does not compute anything: it builds a
+ * tree of operations. When the tree is converted to `basic_rational`
+ * (assignment, initialization or `value()`), it is evaluated in `__int128`
+ * by the lazy kernels of `lazy_rational.h` without GCD, and the result
+ * is reduced once. If an intermediate value does not fit into
+ * `__int128`, the operands of this operation are reduced and the
+ * operation is repeated.
+ *
+ * The result is equal to the result of eager operators. If the fused
+ * evaluation fails (the result does not fit into `T`, still overflows
+ * after reduction, or divides by zero), the tree is evaluated by eager
+ * operators, so errors and overflow policy are the same as without
+ * expression templates. The only difference: intermediate values, which
+ * do not fit into `T`, do not raise errors, if the result fits.
+ *
+ * Expression keeps copies of operands, so it can outlive them.
+ * Types wider than `long long` are not supported.
+ */
+
+/*
+ * Wide integer type of fused evaluation.
+ */
+typedef __int128 fused_integer;
+
+/*
+ * Function reduces `n/d` by the greatest common divisor.
+ */
+RATIONAL_INSTRUMENTED_CONSTEXPR
+void ReduceFused(fused_integer& n, fused_integer& d) {
+    fused_integer gcd = GreatestCommonDivisor(n, d);
+    if (gcd > 1) {
+        n /= gcd;
+        d /= gcd;
+    }
+}
+
+/*
+ * Function checks, if fused value fits into `T`.
+ */
+template<typename T>
+constexpr bool FitsFused(fused_integer value) {
+    return value >= integer_traits<T>::min() &&
+            value <= integer_traits<T>::max();
+}
+
+/*
+ * Function runs lazy operation on fused values. If it overflows, the
+ * operands are reduced and the operation is repeated.
+ * Returns `false`, if it still overflows.
+ */
+template<typename LazyOperation>
+constexpr bool FuseOperation(LazyOperation operation, fused_integer n1,
+        fused_integer d1, fused_integer n2, fused_integer d2, fused_integer& n,
+        fused_integer& d) {
+    checked_arithmetic<fused_integer> arithmetic;
+    operation(arithmetic, n1, d1, n2, d2, n, d);
+    if (!arithmetic.overflow) {
+        return true;
+    }
+    ReduceFused(n1, d1);
+    ReduceFused(n2, d2);
+    checked_arithmetic<fused_integer> reduced;
+    operation(reduced, n1, d1, n2, d2, n, d);
+    return !reduced.overflow;
+}
+
+/*
+ * Operations of expression tree.
+ *
+ * `fuse` - unreduced operation on `__int128`, returns `false` on failure.
+ * `eager` - the same operation by `basic_rational` operators.
+ */
+struct fused_add {
+    static constexpr bool fuse(fused_integer n1, fused_integer d1,
+            fused_integer n2, fused_integer d2, fused_integer& n,
+            fused_integer& d) {
+        return FuseOperation(lazy_add_operation(), n1, d1, n2, d2, n, d);
+    }
+    template<typename R>
+    static constexpr R eager(const R& left, const R& right) {
+        return left + right;
+    }
+};
+
+struct fused_subtract {
+    static constexpr bool fuse(fused_integer n1, fused_integer d1,
+            fused_integer n2, fused_integer d2, fused_integer& n,
+            fused_integer& d) {
+        return FuseOperation(lazy_subtract_operation(), n1, d1, n2, d2, n, d);
+    }
+    template<typename R>
+    static constexpr R eager(const R& left, const R& right) {
+        return left - right;
+    }
+};
+
+struct fused_multiply {
+    static constexpr bool fuse(fused_integer n1, fused_integer d1,
+            fused_integer n2, fused_integer d2, fused_integer& n,
+            fused_integer& d) {
+        return FuseOperation(lazy_multiply_operation(), n1, d1, n2, d2, n, d);
+    }
+    template<typename R>
+    static constexpr R eager(const R& left, const R& right) {
+        return left * right;
+    }
+};
+
+struct fused_divide {
+    static constexpr bool fuse(fused_integer n1, fused_integer d1,
+            fused_integer n2, fused_integer d2, fused_integer& n,
+            fused_integer& d) {
+        return n2 != 0 &&
+                FuseOperation(lazy_divide_operation(), n1, d1, n2, d2, n, d);
+    }
+    template<typename R>
+    static constexpr R eager(const R& left, const R& right) {
+        return left / right;
+    }
+};
+
+/*
+ * Class rational_terminal. Leaf of expression tree, keeps one operand.
+ *
+ * Public:
+ * 1. `rational_terminal(value)` - class initializer.
+ * 2. `fuse(n, d)` - write unreduced value.
+ * 3. `eager()`, `value()` - return value, also implicit conversion to
+ * `basic_rational`.
+ */
+template<typename Rational>
+class rational_terminal {
+public:
+    typedef Rational rational_type;
+
+    constexpr explicit rational_terminal(const Rational& value)
+        : operand(value) {}
+
+    constexpr bool fuse(fused_integer& n, fused_integer& d) const {
+        n = operand.numerator();
+        d = operand.denominator();
+        return true;
+    }
+    constexpr Rational eager() const {
+        return operand;
+    }
+    constexpr Rational value() const {
+        return operand;
+    }
+
+    constexpr operator Rational() const {
+        return operand;
+    }
+
+private:
+    Rational operand;
+};
+
+/*
+ * Class rational_expression. Operation of expression tree.
+ *
+ * Public:
+ * 1. `rational_expression(left, right)` - class initializer.
+ * 2. `fuse(n, d)` - write unreduced value, return `false` on failure.
+ * 3. `eager()` - return value computed by eager operators.
+ * 4. `value()` - return value, also implicit conversion to
+ * `basic_rational`.
+ *
+ * Private:
+ * 1. `left`, `right` - operands, expressions or terminals.
+ */
+template<typename Operation, typename Left, typename Right>
+class rational_expression {
+public:
+    typedef typename Left::rational_type rational_type;
+    typedef typename rational_type::value_type value_type;
+
+    static_assert(std::is_same<rational_type,
+            typename Right::rational_type>::value,
+            "operands of expression must have the same type");
+    static_assert(sizeof(value_type) <= sizeof(long long),
+            "expression templates support types up to long long");
+
+    constexpr rational_expression(const Left& left, const Right& right)
+        : left(left), right(right) {}
+
+    constexpr bool fuse(fused_integer& n, fused_integer& d) const {
+        fused_integer n1 = 0, d1 = 1, n2 = 0, d2 = 1;
+        return left.fuse(n1, d1) && right.fuse(n2, d2) &&
+                Operation::fuse(n1, d1, n2, d2, n, d);
+    }
+    constexpr rational_type eager() const {
+        return Operation::eager(left.eager(), right.eager());
+    }
+    constexpr rational_type value() const;
+
+    constexpr operator rational_type() const {
+        return value();
+    }
+
+private:
+    Left left;
+    Right right;
+};
+
+/*
+ * This function evaluates the tree and reduces the result once. If the
+ * unreduced result fits into `T`, it is reduced by the constructor of
+ * `basic_rational`, otherwise it is reduced in `__int128` first.
+ */
+template<typename Operation, typename Left, typename Right>
+constexpr typename rational_expression<Operation, Left, Right>::rational_type
+rational_expression<Operation, Left, Right>::value() const {
+    fused_integer n = 0, d = 1;
+    if (fuse(n, d)) {
+        if (!FitsFused<value_type>(n) || !FitsFused<value_type>(d)) {
+            ReduceFused(n, d);
+        }
+        if (FitsFused<value_type>(n) && FitsFused<value_type>(d)) {
+            return rational_type(static_cast<value_type>(n),
+                    static_cast<value_type>(d));
+        }
+    }
+    return eager();
+}
+
+/*
+ * Type trait, which checks, if type is a node of expression tree.
+ */
+template<typename T>
+struct is_rational_expression : std::false_type {};
+
+template<typename Rational>
+struct is_rational_expression<rational_terminal<Rational>> : std::true_type {};
+
+template<typename Operation, typename Left, typename Right>
+struct is_rational_expression<rational_expression<Operation, Left, Right>>
+    : std::true_type {};
+
+/*
+ * Function starts expression tree: `Fuse(a) * b + c` is evaluated with
+ * one normalization.
+ */
+template<typename T, typename OverflowPolicy>
+constexpr rational_terminal<basic_rational<T, OverflowPolicy>> Fuse(
+        const basic_rational<T, OverflowPolicy>& value) {
+    return rational_terminal<basic_rational<T, OverflowPolicy>>(value);
+}
+
+/*
+ * Function returns expression node of operation.
+ */
+template<typename Operation, typename Left, typename Right>
+constexpr rational_expression<Operation, Left, Right> MakeExpression(
+        const Left& left, const Right& right) {
+    return rational_expression<Operation, Left, Right>(left, right);
+}
+
+/*
+ * Operators `+`, `-`, `*`, `/` with expression operand build expression
+ * tree. Operators of two `basic_rational` stay eager.
+ */
+#define RATIONAL_EXPRESSION_OPERATOR(symbol, operation) \
+template<typename Left, typename Right, typename = typename \
+        std::enable_if<is_rational_expression<Left>::value && \
+        is_rational_expression<Right>::value>::type> \
+constexpr rational_expression<operation, Left, Right> operator symbol( \
+        const Left& left, const Right& right) { \
+    return MakeExpression<operation>(left, right); \
+} \
+template<typename Left, typename = typename \
+        std::enable_if<is_rational_expression<Left>::value>::type> \
+constexpr rational_expression<operation, Left, \
+        rational_terminal<typename Left::rational_type>> operator symbol( \
+        const Left& left, const typename Left::rational_type& right) { \
+    return MakeExpression<operation>(left, \
+            rational_terminal<typename Left::rational_type>(right)); \
+} \
+template<typename Right, typename = typename \
+        std::enable_if<is_rational_expression<Right>::value>::type> \
+constexpr rational_expression<operation, \
+        rational_terminal<typename Right::rational_type>, Right> \
+operator symbol(const typename Right::rational_type& left, \
+        const Right& right) { \
+    return MakeExpression<operation>( \
+            rational_terminal<typename Right::rational_type>(left), right); \
+}
+
+RATIONAL_EXPRESSION_OPERATOR(+, fused_add)
+RATIONAL_EXPRESSION_OPERATOR(-, fused_subtract)
+RATIONAL_EXPRESSION_OPERATOR(*, fused_multiply)
+RATIONAL_EXPRESSION_OPERATOR(/, fused_divide)
+
+#undef RATIONAL_EXPRESSION_OPERATOR
+
+#endif /* RATIONAL_EXPRESSION_H */
@@ -0,0 +1,356 @@
+#ifndef RATIONAL_FAREY_H
+#define RATIONAL_FAREY_H
+
+#include "rational.h"
+#include "arithmetic.h"
+#include "utils.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+/*
+ * Enumeration of reduced fractions.
+ *
+ * Farey sequence `F_N` - all reduced fractions in `[0, 1]` with
+ * denominator up to `N` in ascending order. Two neighbours `a/b < c/d`
+ * satisfy `bc - ad = 1`, so the next term follows from the last two:
+ * `k = (N + b) / d`, next is `(kc - a) / (kd - b)`. Terms are produced
+ * without GCD and without a container.
+ *
+ * Stern-Brocot tree - binary search tree of all positive reduced
+ * fractions: a node is the mediant of its bounds, the left child is
+ * between the left bound and the node, the right child between the node
+ * and the right bound.
+ */
+
+/*
+ * Function checks order of Farey sequence: raises logical error, if it is
+ * not positive, or terms of the recurrence (up to `2 * order`) do not fit
+ * into `T`.
+ */
+template<typename T>
+void CheckFareyOrder(T order) {
+    if (order < 1) {
+        throw std::logic_error(
+                "Error: order of Farey sequence must be positive!");
+    }
+    if (order > integer_traits<T>::max() / 2) {
+        throw std::logic_error("Error: order of Farey sequence is too large!");
+    }
+}
+
+/*
+ * Class farey_sequence. Generator of Farey sequence `F_N`.
+ *
+ * Template parameter `T` - integer type of numerators and denominators.
+ *
+ * Public:
+ * 1. `farey_sequence(order)` - class initializer, the first term is
+ * `0/1`. Raises logical error, if `order` is not positive or too large.
+ * 2. `farey_sequence(order, numerator, denominator)` - the first term is
+ * reduced `numerator/denominator` in `[0, 1]` with denominator up to
+ * `order`, its successor is found by extended Euclidean algorithm.
+ * Raises logical error for other values.
+ * 3. `order()` - return `N`.
+ * 4. `numerator()`, `denominator()` - return the current term, it is
+ * always reduced.
+ * 5. `value()` - return the current term as `basic_rational<T>`.
+ * 6. `next()` - move to the next term, return `false` after `1/1`.
+ *
+ * Private:
+ * 1. `order_value` - `N`.
+ * 2. `current_numerator`, `current_denominator` - the current term.
+ * 3. `next_numerator`, `next_denominator` - the next term.
+ */
+template<typename T = int>
+class farey_sequence {
+public:
+    typedef T value_type;
+
+    explicit farey_sequence(T order);
+    farey_sequence(T order, T numerator, T denominator);
+
+    T order() const {
+        return order_value;
+    }
+    T numerator() const {
+        return current_numerator;
+    }
+    T denominator() const {
+        return current_denominator;
+    }
+    basic_rational<T> value() const {
+        return basic_rational<T>(current_numerator, current_denominator);
+    }
+
+    bool next();
+
+private:
+    T order_value;
+    T current_numerator;
+    T current_denominator;
+    T next_numerator;
+    T next_denominator;
+};
+
+template<typename T>
+farey_sequence<T>::farey_sequence(T order)
+    : order_value(order), current_numerator(0), current_denominator(1),
+    next_numerator(1), next_denominator(order)
+{
+    CheckFareyOrder(order);
+}
+
+/*
+ * The successor `c/d` of `a/b` satisfies `bc - ad = 1` with the largest
+ * `d <= N`: `d = -a^(-1) mod b` is found by extended Euclidean algorithm,
+ * then increased by multiples of `b`.
+ */
+template<typename T>
+farey_sequence<T>::farey_sequence(T order, T numerator, T denominator)
+    : order_value(order), current_numerator(numerator),
+    current_denominator(denominator), next_numerator(0), next_denominator(0)
+{
+    CheckFareyOrder(order);
+    if (denominator < 1 || denominator > order || numerator < 0 ||
+            numerator > denominator ||
+            GreatestCommonDivisor(numerator, denominator) != 1) {
+        throw std::logic_error("Error: fraction is not a term of Farey sequence!");
+    }
+    if (numerator == denominator) {
+        next_denominator = 0;
+        return;
+    }
+    // Inverse of `a` modulo `b`: `old_s * a = old_r (mod b)`.
+    long long old_r = numerator, r = denominator, old_s = 1, s = 0;
+    while (r != 0) {
+        long long quotient = old_r / r;
+        long long t = old_r - quotient * r;
+        old_r = r;
+        r = t;
+        t = old_s - quotient * s;
+        old_s = s;
+        s = t;
+    }
+    long long b = denominator;
+    long long d = ((-old_s) % b + b) % b;
+    if (d == 0) {
+        d = b;
+    }
+    d += (order - d) / b * b;
+    next_denominator = static_cast<T>(d);
+    next_numerator = static_cast<T>((1 + static_cast<__int128>(numerator) * d)
+            / b);
+}
+
+/*
+ * This function moves to the next term by the recurrence, terms of
+ * products are below `2 * order`.
+ */
+template<typename T>
+bool farey_sequence<T>::next() {
+    if (next_denominator == 0) {
+        return false;
+    }
+    T k = (order_value + current_denominator) / next_denominator;
+    T numerator = k * next_numerator - current_numerator;
+    T denominator = k * next_denominator - current_denominator;
+    current_numerator = next_numerator;
+    current_denominator = next_denominator;
+    next_numerator = numerator;
+    next_denominator = current_numerator == current_denominator
+            ? 0 : denominator;
+    return true;
+}
+
+/*
+ * Function returns length of `F_N`: `1 + phi(1) + ... + phi(N)`, where
+ * Euler's function is computed by sieve of `N + 1` entries.
+ */
+template<typename T>
+unsigned long long FareyLength(T order) {
+    CheckFareyOrder(order);
+    std::vector<T> phi(static_cast<std::size_t>(order) + 1);
+    for (std::size_t i = 0; i < phi.size(); i++) {
+        phi[i] = static_cast<T>(i);
+    }
+    unsigned long long length = 1;
+    for (std::size_t i = 1; i < phi.size(); i++) {
+        if (i > 1 && phi[i] == static_cast<T>(i)) {
+            for (std::size_t j = i; j < phi.size(); j += i) {
+                phi[j] -= phi[j] / static_cast<T>(i);
+            }
+        }
+        length += phi[i];
+    }
+    return length;
+}
+
+/*
+ * Function calls `function(numerator, denominator)` for every term of
+ * `F_N` in ascending order.
+ */
+template<typename T, typename Function>
+void ForEachFarey(T order, Function function) {
+    farey_sequence<T> sequence(order);
+    do {
+        function(sequence.numerator(), sequence.denominator());
+    } while (sequence.next());
+}
+
+/*
+ * Function returns number of chunks of `ParallelFarey`: 16 per thread,
+ * but not more than `order`, so every chunk starts at its own `k/chunks`.
+ */
+template<typename T>
+std::size_t FareyChunkCount(T order, const thread_pool& pool) {
+    CheckFareyOrder(order);
+    return std::min<std::size_t>(16 * pool.size(),
+            static_cast<std::size_t>(order));
+}
+
+/*
+ * Parallel version. `[0, 1]` is split at `k/chunks` (terms of `F_N`,
+ * since `chunks <= N`) into `FareyChunkCount(order, pool)` ranges of
+ * about equal length, terms are spread evenly. Threads of `pool` call
+ * `function(chunk, numerator, denominator)` for terms of
+ * `[k/chunks, (k+1)/chunks)` in ascending order, the last chunk also
+ * gets `1/1`. Chunks are called concurrently, so `function` should write
+ * to state of its chunk only.
+ */
+template<typename T, typename Function>
+void ParallelFarey(T order, thread_pool& pool, Function function) {
+    std::size_t chunks = FareyChunkCount(order, pool);
+    pool.parallelFor(chunks, [&](std::size_t chunk) {
+        T first = static_cast<T>(chunk);
+        T last = static_cast<T>(chunks);
+        T gcd = GreatestCommonDivisor(first, last);
+        farey_sequence<T> sequence(order, first / gcd, last / gcd);
+        __int128 bound = static_cast<__int128>(chunk) + 1;
+        do {
+            if (chunk + 1 < chunks &&
+                    static_cast<__int128>(sequence.numerator()) * last >=
+                    bound * sequence.denominator()) {
+                break;
+            }
+            function(chunk, sequence.numerator(), sequence.denominator());
+        } while (sequence.next());
+    });
+}
+
+/*
+ * Class stern_brocot_node. Node of Stern-Brocot tree, the root is `1/1`
+ * with bounds `0/1` and `1/0`.
+ *
+ * Public:
+ * 1. `stern_brocot_node()` - class initializer, the root.
+ * 2. `numerator()`, `denominator()` - return the node, mediant of its
+ * bounds, it is always reduced.
+ * 3. `value()` - return the node as `basic_rational<T>`.
+ * 4. `depth()` - return number of steps from the root.
+ * 5. `goLeft()`, `goRight()` - move to the left (smaller) or right
+ * (larger) child. Raise overflow error, if the child does not fit into
+ * `T`.
+ *
+ * Private:
+ * 1. `left_numerator`, `left_denominator`, `right_numerator`,
+ * `right_denominator` - bounds.
+ * 2. `depth_value` - depth.
+ */
+template<typename T = int>
+class stern_brocot_node {
+public:
+    typedef T value_type;
+
+    constexpr stern_brocot_node()
+        : left_numerator(0), left_denominator(1), right_numerator(1),
+        right_denominator(0), depth_value(0) {}
+
+    constexpr T numerator() const {
+        return left_numerator + right_numerator;
+    }
+    constexpr T denominator() const {
+        return left_denominator + right_denominator;
+    }
+    basic_rational<T> value() const {
+        return basic_rational<T>(numerator(), denominator());
+    }
+    constexpr std::size_t depth() const {
+        return depth_value;
+    }
+
+    void goLeft();
+    void goRight();
+
+private:
+    T left_numerator;
+    T left_denominator;
+    T right_numerator;
+    T right_denominator;
+    std::size_t depth_value;
+};
+
+/*
+ * Functions replace a bound by the node, then the mediant of new bounds
+ * is checked.
+ */
+template<typename T>
+void stern_brocot_node<T>::goLeft() {
+    checked_arithmetic<T> arithmetic;
+    arithmetic.add(left_numerator, numerator());
+    arithmetic.add(left_denominator, denominator());
+    if (arithmetic.overflow) {
+        RaiseOverflowError();
+    }
+    right_numerator = numerator();
+    right_denominator = denominator();
+    depth_value++;
+}
+
+template<typename T>
+void stern_brocot_node<T>::goRight() {
+    checked_arithmetic<T> arithmetic;
+    arithmetic.add(right_numerator, numerator());
+    arithmetic.add(right_denominator, denominator());
+    if (arithmetic.overflow) {
+        RaiseOverflowError();
+    }
+    left_numerator = numerator();
+    left_denominator = denominator();
+    depth_value++;
+}
+
+/*
+ * Function calls `function(numerator, denominator)` for nodes between
+ * bounds `a/b` and `c/d` up to `levels` levels down in ascending order
+ * (in-order traversal).
+ */
+template<typename T, typename Function>
+void SternBrocotInOrder(T a, T b, T c, T d, std::size_t levels,
+        Function& function) {
+    if (levels == 0) {
+        return;
+    }
+    checked_arithmetic<T> arithmetic;
+    T numerator = arithmetic.add(a, c);
+    T denominator = arithmetic.add(b, d);
+    if (arithmetic.overflow) {
+        RaiseOverflowError();
+    }
+    SternBrocotInOrder(a, b, numerator, denominator, levels - 1, function);
+    function(numerator, denominator);
+    SternBrocotInOrder(numerator, denominator, c, d, levels - 1, function);
+}
+
+/*
+ * Function calls `function(numerator, denominator)` for all `2^depth - 1`
+ * nodes of Stern-Brocot tree with depth below `depth` in ascending order.
+ */
+template<typename T, typename Function>
+void ForEachSternBrocot(std::size_t depth, Function function) {
+    SternBrocotInOrder<T>(0, 1, 1, 0, depth, function);
+}
+
+#endif /* RATIONAL_FAREY_H */
@@ -0,0 +1,365 @@
+#ifndef RATIONAL_FLAT_MAP_H
+#define RATIONAL_FLAT_MAP_H
+
+#include "rational.h"
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+ * Storage of mapped values of `basic_rational_flat_map`. Empty types
+ * (the values of `rational_flat_set`) take no memory.
+ */
+template<typename Value, bool Empty = std::is_empty<Value>::value>
+struct flat_map_values {
+    std::vector<Value> values;
+
+    Value& at(std::size_t index) {
+        return values[index];
+    }
+    const Value& at(std::size_t index) const {
+        return values[index];
+    }
+    void reset(std::size_t size) {
+        values.assign(size, Value());
+    }
+};
+
+template<typename Value>
+struct flat_map_values<Value, true> {
+    Value value;
+
+    Value& at(std::size_t) {
+        return value;
+    }
+    const Value& at(std::size_t) const {
+        return value;
+    }
+    void reset(std::size_t) {}
+};
+
+/*
+ * Class basic_rational_flat_map. Hash map with `basic_rational` keys and
+ * open addressing.
+ *
+ * Keys are stored in one array of slots (numerator, denominator), values
+ * in a parallel array, so probing reads only keys. Empty slot has zero
+ * denominator, which is never used by normalized rationals. Collisions
+ * are resolved by linear probing, erased keys are removed by backward
+ * shift, so there are no tombstones. Capacity is a power of two, table
+ * grows, when it is 3/4 full.
+ *
+ * Public:
+ * 1. `basic_rational_flat_map(capacity)` - class initializer, memory for
+ * `capacity` keys is reserved.
+ * 2. `size()`, `empty()` - number of keys.
+ * 3. `insert(key, value)` - add key, returns `false` and does not change
+ * value, if key exists.
+ * 4. `operator[](key)` - return value of key, add key with default value,
+ * if it does not exist.
+ * 5. `find(key)` - return pointer to value or `nullptr`.
+ * 6. `contains(key)` - check, if key exists.
+ * 7. `erase(key)` - remove key, returns `false`, if key does not exist.
+ * 8. `clear()` - remove all keys.
+ * 9. `reserve(count)` - reserve memory for `count` keys.
+ * 10. `forEach(function)` - call `function(key, value)` for every key.
+ *
+ * Private:
+ * 1. `slots` - keys.
+ * 2. `values` - mapped values.
+ * 3. `count` - number of keys.
+ * 4. `findSlot` - return slot of key or of the first empty slot.
+ * 5. `rehash` - move keys to table of new capacity.
+ */
+template<typename Value, typename Rational = rational>
+class basic_rational_flat_map {
+public:
+    typedef Rational key_type;
+    typedef Value mapped_type;
+    typedef typename Rational::value_type integer_type;
+
+    explicit basic_rational_flat_map(std::size_t capacity = 0);
+
+    std::size_t size() const;
+    bool empty() const;
+    bool insert(const key_type& key, const mapped_type& value);
+    mapped_type& operator[](const key_type& key);
+    mapped_type* find(const key_type& key);
+    const mapped_type* find(const key_type& key) const;
+    bool contains(const key_type& key) const;
+    bool erase(const key_type& key);
+    void clear();
+    void reserve(std::size_t keys);
+
+    template<typename Function>
+    void forEach(Function function) const {
+        for (std::size_t i = 0; i < slots.size(); i++) {
+            if (slots[i].denominator != 0) {
+                function(key_type(slots[i].numerator, slots[i].denominator),
+                        values.at(i));
+            }
+        }
+    }
+
+private:
+    struct slot {
+        integer_type numerator;
+        integer_type denominator;
+    };
+
+    std::vector<slot> slots;
+    flat_map_values<Value> values;
+    std::size_t count;
+
+    std::size_t findSlot(integer_type num, integer_type deno) const;
+    void rehash(std::size_t capacity);
+};
+
+/*
+ * Constructor class. Memory for `capacity` keys is reserved.
+ */
+template<typename Value, typename Rational>
+basic_rational_flat_map<Value, Rational>::basic_rational_flat_map(
+        std::size_t capacity)
+    : count(0)
+{
+    reserve(capacity);
+}
+/*
+ * This function returns number of keys.
+ */
+template<typename Value, typename Rational>
+std::size_t basic_rational_flat_map<Value, Rational>::size() const {
+    return count;
+}
+/*
+ * This function checks, if there are no keys.
+ */
+template<typename Value, typename Rational>
+bool basic_rational_flat_map<Value, Rational>::empty() const {
+    return count == 0;
+}
+/*
+ * This function returns index of slot with key `num/deno`, or index of
+ * the empty slot, where the key must be inserted. Table must not be full.
+ */
+template<typename Value, typename Rational>
+std::size_t basic_rational_flat_map<Value, Rational>::findSlot(
+        integer_type num, integer_type deno) const {
+    std::size_t mask = slots.size() - 1;
+    std::size_t index = static_cast<std::size_t>(HashRational(num, deno)) & mask;
+    while (slots[index].denominator != 0 &&
+            (slots[index].numerator != num ||
+            slots[index].denominator != deno)) {
+        index = (index + 1) & mask;
+    }
+    return index;
+}
+/*
+ * This function adds key with value. Returns `false`, if key exists.
+ */
+template<typename Value, typename Rational>
+bool basic_rational_flat_map<Value, Rational>::insert(const key_type& key,
+        const mapped_type& value) {
+    reserve(count + 1);
+    std::size_t index = findSlot(key.numerator(), key.denominator());
+    if (slots[index].denominator != 0) {
+        return false;
+    }
+    slots[index] = {key.numerator(), key.denominator()};
+    values.at(index) = value;
+    count++;
+    return true;
+}
+/*
+ * This function returns value of key. Key with default value is added,
+ * if it does not exist.
+ */
+template<typename Value, typename Rational>
+Value& basic_rational_flat_map<Value, Rational>::operator[](
+        const key_type& key) {
+    reserve(count + 1);
+    std::size_t index = findSlot(key.numerator(), key.denominator());
+    if (slots[index].denominator == 0) {
+        slots[index] = {key.numerator(), key.denominator()};
+        values.at(index) = Value();
+        count++;
+    }
+    return values.at(index);
+}
+/*
+ * This function returns pointer to value of key, or `nullptr`, if key
+ * does not exist.
+ */
+template<typename Value, typename Rational>
+Value* basic_rational_flat_map<Value, Rational>::find(const key_type& key) {
+    if (count == 0) {
+        return nullptr;
+    }
+    std::size_t index = findSlot(key.numerator(), key.denominator());
+    return slots[index].denominator != 0 ? &values.at(index) : nullptr;
+}
+template<typename Value, typename Rational>
+const Value* basic_rational_flat_map<Value, Rational>::find(
+        const key_type& key) const {
+    if (count == 0) {
+        return nullptr;
+    }
+    std::size_t index = findSlot(key.numerator(), key.denominator());
+    return slots[index].denominator != 0 ? &values.at(index) : nullptr;
+}
+/*
+ * This function checks, if key exists.
+ */
+template<typename Value, typename Rational>
+bool basic_rational_flat_map<Value, Rational>::contains(
+        const key_type& key) const {
+    return find(key) != nullptr;
+}
+/*
+ * This function removes key. Returns `false`, if key does not exist.
+ *
+ * Following keys of the same probe sequence are shifted back to the
+ * freed slot, so lookups never stop at it too early.
+ */
+template<typename Value, typename Rational>
+bool basic_rational_flat_map<Value, Rational>::erase(const key_type& key) {
+    if (count == 0) {
+        return false;
+    }
+    std::size_t mask = slots.size() - 1;
+    std::size_t hole = findSlot(key.numerator(), key.denominator());
+    if (slots[hole].denominator == 0) {
+        return false;
+    }
+    std::size_t index = hole;
+    for (;;) {
+        index = (index + 1) & mask;
+        if (slots[index].denominator == 0) {
+            break;
+        }
+        std::size_t home = static_cast<std::size_t>(HashRational(
+                slots[index].numerator, slots[index].denominator)) & mask;
+        // key can be moved, if its home slot is not in (hole, index].
+        if (((index - home) & mask) >= ((index - hole) & mask)) {
+            slots[hole] = slots[index];
+            values.at(hole) = std::move(values.at(index));
+            hole = index;
+        }
+    }
+    slots[hole].denominator = 0;
+    count--;
+    return true;
+}
+/*
+ * This function removes all keys, memory is not released.
+ */
+template<typename Value, typename Rational>
+void basic_rational_flat_map<Value, Rational>::clear() {
+    for (slot& entry : slots) {
+        entry.denominator = 0;
+    }
+    values.reset(slots.size());
+    count = 0;
+}
+/*
+ * This function reserves memory for `count` keys: capacity is the
+ * smallest power of two, which keeps table not more than 3/4 full.
+ */
+template<typename Value, typename Rational>
+void basic_rational_flat_map<Value, Rational>::reserve(std::size_t keys) {
+    std::size_t capacity = slots.empty() ? 8 : slots.size();
+    while (keys > capacity / 4 * 3) {
+        capacity *= 2;
+    }
+    if (capacity != slots.size()) {
+        rehash(capacity);
+    }
+}
+/*
+ * This function moves all keys to table with `capacity` slots.
+ */
+template<typename Value, typename Rational>
+void basic_rational_flat_map<Value, Rational>::rehash(std::size_t capacity) {
+    std::vector<slot> old_slots(capacity, slot{0, 0});
+    old_slots.swap(slots);
+    flat_map_values<Value> old_values = std::move(values);
+    values.reset(capacity);
+    for (std::size_t i = 0; i < old_slots.size(); i++) {
+        if (old_slots[i].denominator != 0) {
+            std::size_t index = findSlot(old_slots[i].numerator,
+                    old_slots[i].denominator);
+            slots[index] = old_slots[i];
+            values.at(index) = std::move(old_values.at(i));
+        }
+    }
+}
+
+/*
+ * Map with `rational` keys.
+ */
+template<typename Value>
+using rational_flat_map = basic_rational_flat_map<Value, rational>;
+
+/*
+ * Class basic_rational_flat_set. Hash set of `basic_rational` with open
+ * addressing, same table as `basic_rational_flat_map` without values.
+ *
+ * Public:
+ * 1. `size()`, `empty()` - number of keys.
+ * 2. `insert(key)` - add key, returns `false`, if key exists.
+ * 3. `contains(key)` - check, if key exists.
+ * 4. `erase(key)` - remove key, returns `false`, if key does not exist.
+ * 5. `clear()`, `reserve(count)` - same as for the map.
+ * 6. `forEach(function)` - call `function(key)` for every key.
+ */
+template<typename Rational = rational>
+class basic_rational_flat_set {
+public:
+    typedef Rational key_type;
+
+    explicit basic_rational_flat_set(std::size_t capacity = 0)
+        : table(capacity) {}
+
+    std::size_t size() const {
+        return table.size();
+    }
+    bool empty() const {
+        return table.empty();
+    }
+    bool insert(const key_type& key) {
+        return table.insert(key, present());
+    }
+    bool contains(const key_type& key) const {
+        return table.contains(key);
+    }
+    bool erase(const key_type& key) {
+        return table.erase(key);
+    }
+    void clear() {
+        table.clear();
+    }
+    void reserve(std::size_t count) {
+        table.reserve(count);
+    }
+    template<typename Function>
+    void forEach(Function function) const {
+        table.forEach([&function](const key_type& key, present) {
+            function(key);
+        });
+    }
+
+private:
+    struct present {};
+
+    basic_rational_flat_map<present, Rational> table;
+};
+
+/*
+ * Set of `rational`.
+ */
+typedef basic_rational_flat_set<rational> rational_flat_set;
+
+#endif /* RATIONAL_FLAT_MAP_H */
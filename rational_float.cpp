@@ -0,0 +1,41 @@
+#include "rational_float.h"
+
+
+void RationalArrayToDouble(const rational_array& values,
+        std::vector<double>& result) {
+    const std::size_t size = values.size();
+    result.resize(size);
+    const int* numerators = values.numerators();
+    const int* denominators = values.denominators();
+    double* output = result.data();
+    for (std::size_t i = 0; i < size; i++) {
+        output[i] = static_cast<double>(numerators[i]) / denominators[i];
+    }
+}
+
+void RationalArrayToFloat(const rational_array& values,
+        std::vector<float>& result) {
+    const std::size_t size = values.size();
+    result.resize(size);
+    const int* numerators = values.numerators();
+    const int* denominators = values.denominators();
+    for (std::size_t i = 0; i < size; i++) {
+        result[i] = FloatingPointQuotient<float>(numerators[i], denominators[i]);
+    }
+}
+
+void RationalArrayFromDouble(const std::vector<double>& values,
+        rational_array& result) {
+    result.resize(values.size());
+    for (std::size_t i = 0; i < values.size(); i++) {
+        result.set(i, RationalFromDouble(values[i]));
+    }
+}
+
+void BestRationalApproximationArray(const std::vector<double>& values,
+        int max_denominator, rational_array& result) {
+    result.resize(values.size());
+    for (std::size_t i = 0; i < values.size(); i++) {
+        result.set(i, BestRationalApproximation(values[i], max_denominator));
+    }
+}
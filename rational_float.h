@@ -0,0 +1,314 @@
+#ifndef RATIONAL_FLOAT_H
+#define RATIONAL_FLOAT_H
+
+#include "rational.h"
+#include "rational_array.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+/*
+ * Function returns number of significant bits of the number.
+ */
+inline int BitLength(unsigned __int128 value) {
+    unsigned long long high = static_cast<unsigned long long>(value >> 64);
+    unsigned long long low = static_cast<unsigned long long>(value);
+    return high ? 128 - __builtin_clzll(high)
+            : low ? 64 - __builtin_clzll(low) : 0;
+}
+
+/*
+ * Function returns `bits + 1` or `bits + 2` leading bits of `a / b`
+ * (`a`, `b` are not zero), so `a / b` is `result * 2^exponent`. The lowest
+ * bit is or-ed with all dropped bits (sticky bit), so rounding of the
+ * result to `bits - 1` or less bits is the same as rounding of `a / b`.
+ */
+inline unsigned long long QuotientBits(unsigned __int128 a, unsigned __int128 b,
+        int bits, int& exponent) {
+    const int a_length = BitLength(a);
+    const int b_length = BitLength(b);
+    // `a * 2^shift / b` is in `[2^bits, 2^(bits+2))`.
+    const int shift = bits + 1 - (a_length - b_length);
+    unsigned __int128 quotient, remainder;
+    if (shift <= 0) {
+        unsigned __int128 divisor = b << -shift;
+        quotient = a / divisor;
+        remainder = a % divisor;
+    } else if (a_length + shift <= 127) {
+        unsigned __int128 dividend = a << shift;
+        quotient = dividend / b;
+        remainder = dividend % b;
+    } else {
+        // `a << shift` does not fit, bits are computed one by one.
+        quotient = a / b;
+        remainder = a % b;
+        for (int i = 0; i < shift; i++) {
+            bool bit = remainder >= b - remainder;
+            quotient = quotient * 2 + bit;
+            remainder = bit ? remainder - (b - remainder) : remainder * 2;
+        }
+    }
+    exponent = -shift;
+    return static_cast<unsigned long long>(quotient) | (remainder != 0);
+}
+
+/*
+ * Functions return value (or `num / deno` with positive `deno`) converted
+ * to floating point type, correctly rounded (to nearest, ties to even).
+ *
+ * If numerator and denominator are exact in `Float`, one division is
+ * enough. For `float` the `double` quotient is used, if it is not a
+ * midpoint. Otherwise the quotient is computed in integers with two
+ * extra bits and sticky bit, so the value is rounded once. Results below
+ * `std::numeric_limits<Float>::min()` (only `float` from
+ * `basic_rational<__int128>`) can be rounded twice.
+ */
+template<typename Float, typename T>
+Float FloatingPointQuotient(T num, T deno) {
+    const int digits = std::numeric_limits<Float>::digits;
+    const unsigned __int128 a = num < 0 ? 0 - static_cast<unsigned __int128>(num)
+            : static_cast<unsigned __int128>(num);
+    const unsigned __int128 b = static_cast<unsigned __int128>(deno);
+    const unsigned __int128 exact = static_cast<unsigned __int128>(1) << digits;
+    const unsigned __int128 double_exact = static_cast<unsigned __int128>(1) <<
+            std::numeric_limits<double>::digits;
+    Float result;
+    if (a < exact && b < exact) {
+        result = static_cast<Float>(static_cast<long long>(a)) /
+                static_cast<Float>(static_cast<long long>(b));
+        return num < 0 ? -result : result;
+    }
+    if (digits < std::numeric_limits<double>::digits && a < double_exact &&
+            b < double_exact) {
+        // Quotient is rounded to `double` and then to `Float`. It is
+        // rounded twice wrong only, if the first rounding gives a midpoint
+        // between two `Float` values: the dropped bits are `100...0`.
+        double quotient = static_cast<double>(static_cast<long long>(a)) /
+                static_cast<double>(static_cast<long long>(b));
+        unsigned long long representation;
+        std::memcpy(&representation, &quotient, sizeof(quotient));
+        const int dropped = std::numeric_limits<double>::digits - digits;
+        const unsigned long long mask = (1ULL << dropped) - 1;
+        if ((representation & mask) != 1ULL << (dropped - 1)) {
+            result = static_cast<Float>(quotient);
+            return num < 0 ? -result : result;
+        }
+    }
+    int exponent = 0;
+    unsigned long long bits = QuotientBits(a, b, digits + 1, exponent);
+    result = std::ldexp(static_cast<Float>(bits), exponent);
+    return num < 0 ? -result : result;
+}
+template<typename Float, typename T, typename OverflowPolicy>
+Float RationalToFloatingPoint(const basic_rational<T, OverflowPolicy>& value) {
+    return FloatingPointQuotient<Float>(value.numerator(), value.denominator());
+}
+
+/*
+ * Functions return value as `double` or `float`, correctly rounded.
+ */
+template<typename T, typename OverflowPolicy>
+double RationalToDouble(const basic_rational<T, OverflowPolicy>& value) {
+    return RationalToFloatingPoint<double>(value);
+}
+template<typename T, typename OverflowPolicy>
+float RationalToFloat(const basic_rational<T, OverflowPolicy>& value) {
+    return RationalToFloatingPoint<float>(value);
+}
+
+/*
+ * Function raises logical error, if value is infinite or NaN.
+ */
+inline void CheckFinite(double value) {
+    if (!std::isfinite(value)) {
+        throw std::logic_error("Error: value is not finite!");
+    }
+}
+
+/*
+ * Function returns exact value of `double` (or `float`) as `Rational`:
+ * `value = mantissa * 2^exponent`, so denominator is a power of two.
+ * Raises overflow error, if value does not fit, and logical error, if
+ * value is infinite or NaN.
+ */
+template<typename Rational = rational>
+Rational RationalFromDouble(double value) {
+    typedef typename Rational::value_type T;
+    CheckFinite(value);
+    if (value == 0) {
+        return Rational();
+    }
+    const int digits = BitLength(static_cast<unsigned __int128>(
+            integer_traits<T>::max()));
+    int exponent = 0;
+    unsigned long long mantissa = static_cast<unsigned long long>(
+            std::ldexp(std::frexp(std::fabs(value), &exponent), 53));
+    exponent -= 53;
+    int zeros = CountTrailingZeros(mantissa);
+    mantissa >>= zeros;
+    exponent += zeros;
+    const int length = BitLength(mantissa);
+    unsigned __int128 num = mantissa, deno = 1;
+    if (exponent >= 0 && length + exponent <= digits) {
+        num <<= exponent;
+    } else if (exponent < 0 && length <= digits && -exponent < digits) {
+        deno <<= -exponent;
+    } else {
+        RaiseOverflowError();
+    }
+    T n = static_cast<T>(num);
+    return Rational(value < 0 ? -n : n, static_cast<T>(deno));
+}
+
+/*
+ * Function compares products `a * b` and `c * d` exactly.
+ * Returns -1, 0 or 1.
+ */
+inline int CompareWideProducts(unsigned __int128 a, unsigned __int128 b,
+        unsigned __int128 c, unsigned __int128 d) {
+    auto multiply = [](unsigned __int128 x, unsigned __int128 y,
+            unsigned __int128& high, unsigned __int128& low) {
+        const unsigned __int128 mask = ~0ULL;
+        unsigned __int128 ll = (x & mask) * (y & mask);
+        unsigned __int128 lh = (x & mask) * (y >> 64);
+        unsigned __int128 hl = (x >> 64) * (y & mask);
+        unsigned __int128 middle = (ll >> 64) + (lh & mask) + (hl & mask);
+        low = (ll & mask) | (middle << 64);
+        high = (x >> 64) * (y >> 64) + (lh >> 64) + (hl >> 64) + (middle >> 64);
+    };
+    unsigned __int128 left_high, left_low, right_high, right_low;
+    multiply(a, b, left_high, left_low);
+    multiply(c, d, right_high, right_low);
+    if (left_high != right_high) {
+        return left_high < right_high ? -1 : 1;
+    }
+    return left_low < right_low ? -1 : left_low > right_low ? 1 : 0;
+}
+
+/*
+ * Function finds fraction `p/q` closest to `fraction` (in `[0, 1)`)
+ * with `q <= max_denominator` (at most `2^63`), the smaller denominator
+ * wins ties.
+ *
+ * `fraction` is exact `n / 2^k`. Its continued fraction is expanded,
+ * while convergents fit, then the last convergent is compared with the
+ * best semiconvergent `(p0 + t*p1) / (q0 + t*q1)`: with the remaining
+ * complete quotient `n/d` it is closer, if `q1*n < (q0 + 2*t*q1)*d`.
+ */
+inline void BestFractionApproximation(double fraction,
+        unsigned __int128 max_denominator, unsigned __int128& p,
+        unsigned __int128& q) {
+    p = 0;
+    q = 1;
+    if (fraction == 0) {
+        return;
+    }
+    int exponent = 0;
+    unsigned long long mantissa = static_cast<unsigned long long>(
+            std::ldexp(std::frexp(fraction, &exponent), 53));
+    int power = 53 - exponent;
+    int zeros = CountTrailingZeros(mantissa);
+    mantissa >>= zeros;
+    power -= zeros;
+    // Fraction is less than `2^-74`, so `0/1` is closer than `1/q`.
+    if (power > 127) {
+        return;
+    }
+    unsigned __int128 n = mantissa;
+    unsigned __int128 d = static_cast<unsigned __int128>(1) << power;
+    if (n * 2 * max_denominator <= d) {
+        return;
+    }
+    unsigned __int128 p0 = 0, q0 = 1, p1 = 1, q1 = 0;
+    while (true) {
+        unsigned __int128 a = n / d;
+        if (q1 != 0 && a > (max_denominator - q0) / q1) {
+            break;
+        }
+        unsigned __int128 p2 = p0 + a * p1, q2 = q0 + a * q1;
+        p0 = p1;
+        q0 = q1;
+        p1 = p2;
+        q1 = q2;
+        unsigned __int128 remainder = n - a * d;
+        n = d;
+        d = remainder;
+        if (d == 0) {
+            p = p1;
+            q = q1;
+            return;
+        }
+    }
+    unsigned __int128 t = (max_denominator - q0) / q1;
+    if (CompareWideProducts(q1, n, q0 + 2 * t * q1, d) < 0) {
+        p = p0 + t * p1;
+        q = q0 + t * q1;
+    } else {
+        p = p1;
+        q = q1;
+    }
+}
+
+/*
+ * Function returns `Rational` closest to `value` with denominator not
+ * more than `max_denominator`, the smaller denominator wins ties (like
+ * `Fraction.limit_denominator` of Python). The integer part is split,
+ * the fractional part is approximated by continued fraction in exact
+ * integer arithmetic.
+ *
+ * Raises logical error, if value is infinite or NaN, or if
+ * `max_denominator < 1`, and overflow error, if result does not fit.
+ * Types wider than `long long` are not supported.
+ */
+template<typename Rational = rational>
+Rational BestRationalApproximation(double value,
+        typename Rational::value_type max_denominator) {
+    typedef typename Rational::value_type T;
+    static_assert(sizeof(T) <= sizeof(long long),
+            "BestRationalApproximation supports types up to long long");
+    CheckFinite(value);
+    if (max_denominator < 1) {
+        throw std::logic_error("Error: max denominator < 1!");
+    }
+    const int digits = BitLength(static_cast<unsigned __int128>(
+            integer_traits<T>::max()));
+    double magnitude = std::fabs(value);
+    double whole = std::floor(magnitude);
+    if (whole >= std::ldexp(1.0, digits)) {
+        RaiseOverflowError();
+    }
+    unsigned __int128 p = 0, q = 1;
+    BestFractionApproximation(magnitude - whole,
+            static_cast<unsigned __int128>(max_denominator), p, q);
+    unsigned __int128 num = static_cast<unsigned __int128>(whole) * q + p;
+    if (num > static_cast<unsigned __int128>(integer_traits<T>::max())) {
+        RaiseOverflowError();
+    }
+    T n = static_cast<T>(num);
+    return Rational(value < 0 ? -n : n, static_cast<T>(q));
+}
+
+/*
+ * Batch conversions of arrays, `result` is resized.
+ *
+ * `RationalArrayToDouble` - correctly rounded, `int` values are exact in
+ * `double`, so it is one division per value, which is vectorized.
+ * `RationalArrayToFloat` - correctly rounded.
+ * `RationalArrayFromDouble` - exact values.
+ * `BestRationalApproximationArray` - closest values with denominator not
+ * more than `max_denominator`.
+ * Errors are the same as for single values. If error is raised, part of
+ * `result` can be already changed.
+ */
+void RationalArrayToDouble(const rational_array& values,
+        std::vector<double>& result);
+void RationalArrayToFloat(const rational_array& values,
+        std::vector<float>& result);
+void RationalArrayFromDouble(const std::vector<double>& values,
+        rational_array& result);
+void BestRationalApproximationArray(const std::vector<double>& values,
+        int max_denominator, rational_array& result);
+
+#endif /* RATIONAL_FLOAT_H */
@@ -0,0 +1,86 @@
+#include "rational_instrumentation.h"
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+
+/*
+ * Counters of all running threads and totals of finished threads.
+ */
+struct counters_registry {
+    std::mutex mutex;
+    std::vector<thread_counters*> threads;
+    instrumentation_snapshot finished;
+};
+
+/*
+ * Function returns the registry. It is created, when the first thread
+ * registers, so it is destroyed after counters of the main thread.
+ */
+static counters_registry& Registry() {
+    static counters_registry registry{};
+    return registry;
+}
+
+/*
+ * Constructor class. Counters are zero, they are registered for
+ * snapshots.
+ */
+thread_counters::thread_counters() {
+    reset();
+    counters_registry& registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.threads.push_back(this);
+}
+/*
+ * Destructor class. Counters are added to totals of finished threads.
+ */
+thread_counters::~thread_counters() {
+    counters_registry& registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    read(registry.finished);
+    registry.threads.erase(std::find(registry.threads.begin(),
+            registry.threads.end(), this));
+}
+/*
+ * This function adds counters to snapshot.
+ */
+void thread_counters::read(instrumentation_snapshot& snapshot) const {
+    for (std::size_t i = 0; i < RationalEventCount; i++) {
+        snapshot.events[i] += events[i].load(std::memory_order_relaxed);
+    }
+    for (std::size_t i = 0; i < RationalOperandBuckets; i++) {
+        snapshot.operand_bits[i] +=
+                operand_bits[i].load(std::memory_order_relaxed);
+    }
+}
+/*
+ * This function sets counters to zero.
+ */
+void thread_counters::reset() {
+    for (std::atomic<unsigned long long>& counter : events) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+    for (std::atomic<unsigned long long>& counter : operand_bits) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+}
+
+instrumentation_snapshot InstrumentationSnapshot() {
+    counters_registry& registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    instrumentation_snapshot snapshot = registry.finished;
+    for (const thread_counters* counters : registry.threads) {
+        counters->read(snapshot);
+    }
+    return snapshot;
+}
+
+void ResetInstrumentation() {
+    counters_registry& registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.finished = instrumentation_snapshot{{}, {}};
+    for (thread_counters* counters : registry.threads) {
+        counters->reset();
+    }
+}
@@ -0,0 +1,195 @@
+#ifndef RATIONAL_INSTRUMENTATION_H
+#define RATIONAL_INSTRUMENTATION_H
+
+#include <atomic>
+#include <cstddef>
+
+/*
+ * Events, which are counted by instrumentation.
+ *
+ * `normalization` - `updateRational` (constructor and setters).
+ * `operation` - checked operation of `basic_rational`, including
+ * normalizations.
+ * `gcd`, `gcd_iteration` - calls of `GreatestCommonDivisor` and
+ * iterations of the binary GCD loop.
+ * `gcd_table` - calls of `GreatestCommonDivisor`, answered by the
+ * small-operand table.
+ * `lcd` - calls of `LeastCommonDenominator`.
+ * `comparison`, `comparison_step` - calls of `compareRational` and steps
+ * of `CompareContinuedFraction`.
+ * `overflow` - operation overflowed and overflow policy was called.
+ * `exception` - overflow or zero denominator error was raised.
+ */
+enum class rational_event {
+    normalization,
+    operation,
+    gcd,
+    gcd_iteration,
+    gcd_table,
+    lcd,
+    comparison,
+    comparison_step,
+    overflow,
+    exception,
+};
+
+const std::size_t RationalEventCount = 10;
+
+/*
+ * Number of buckets of operand size histogram: bucket `i` counts
+ * operations, whose largest operand has `i` significant bits (0 to 128).
+ */
+const std::size_t RationalOperandBuckets = 129;
+
+/*
+ * Counters of all threads at some moment.
+ *
+ * `count(event)` - return number of events.
+ * `operand_bits` - histogram of operand sizes.
+ */
+struct instrumentation_snapshot {
+    unsigned long long events[RationalEventCount];
+    unsigned long long operand_bits[RationalOperandBuckets];
+
+    unsigned long long count(rational_event event) const {
+        return events[static_cast<std::size_t>(event)];
+    }
+};
+
+/*
+ * Class thread_counters. Counters of one thread.
+ *
+ * Only the owning thread changes them, so increments are relaxed loads
+ * and stores without locked instructions. Counters are atomic, so other
+ * threads read them for snapshot. Counters register themselves, when
+ * the thread counts the first event, and are added to the totals of
+ * finished threads, when the thread exits.
+ *
+ * Public:
+ * 1. `add(event, value)` - count event.
+ * 2. `addOperand(bits)` - count operation with operand of `bits` bits.
+ * 3. `read(snapshot)` - add counters to snapshot.
+ * 4. `reset()` - set counters to zero.
+ */
+class thread_counters {
+public:
+    thread_counters();
+    ~thread_counters();
+    thread_counters(const thread_counters&) = delete;
+    thread_counters& operator=(const thread_counters&) = delete;
+
+    void add(rational_event event, unsigned long long value) {
+        increment(events[static_cast<std::size_t>(event)], value);
+    }
+    void addOperand(int bits) {
+        increment(operand_bits[bits], 1);
+    }
+    void read(instrumentation_snapshot& snapshot) const;
+    void reset();
+
+private:
+    std::atomic<unsigned long long> events[RationalEventCount];
+    std::atomic<unsigned long long> operand_bits[RationalOperandBuckets];
+
+    static void increment(std::atomic<unsigned long long>& counter,
+            unsigned long long value) {
+        counter.store(counter.load(std::memory_order_relaxed) + value,
+                std::memory_order_relaxed);
+    }
+};
+
+/*
+ * Function returns counters of the calling thread.
+ */
+inline thread_counters& ThreadCounters() {
+    thread_local thread_counters counters;
+    return counters;
+}
+
+/*
+ * Function counts `value` events of the calling thread.
+ */
+inline void CountRationalEvent(rational_event event,
+        unsigned long long value = 1) {
+    ThreadCounters().add(event, value);
+}
+
+/*
+ * Function returns magnitude of the operand, so operands of every type
+ * (including the minimal value) are measured the same way.
+ */
+template<typename T>
+unsigned __int128 OperandMagnitude(T value) {
+    return value < 0 ? 0 - static_cast<unsigned __int128>(value)
+            : static_cast<unsigned __int128>(value);
+}
+
+/*
+ * Function counts operation in the operand size histogram.
+ * `magnitudes` - bitwise or of magnitudes of all operands, it has the
+ * same number of significant bits as the largest operand.
+ */
+inline void CountRationalOperands(unsigned __int128 magnitudes) {
+    unsigned long long high = static_cast<unsigned long long>(magnitudes >> 64);
+    unsigned long long low = static_cast<unsigned long long>(magnitudes);
+    int bits = high ? 128 - __builtin_clzll(high)
+            : low ? 64 - __builtin_clzll(low) : 0;
+    ThreadCounters().addOperand(bits);
+}
+
+/*
+ * Functions return sum of counters of all threads (finished threads
+ * included) and set all counters to zero. Events, which are counted by
+ * other threads during reset, can be lost.
+ */
+instrumentation_snapshot InstrumentationSnapshot();
+void ResetInstrumentation();
+
+/*
+ * Instrumentation of `rational` hot paths, compiled out by default.
+ *
+ * Build with `-DRATIONAL_INSTRUMENTATION` to count events. The macro must
+ * be the same for all files of the program. Instrumented functions stay
+ * `constexpr`: events are not counted during constant evaluation. This
+ * needs `__builtin_is_constant_evaluated` (GCC 9+, Clang 9+). With older
+ * compilers (g++ 7 and 8) instrumented functions are declared with
+ * `RATIONAL_INSTRUMENTED_CONSTEXPR`, which is `inline` then: events are
+ * counted, but rationals can not be computed at compile time, and
+ * `RATIONAL_CONSTANT_EVALUATION` is 0.
+ */
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define RATIONAL_HAS_CONSTANT_EVALUATED
+#endif
+#elif defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 9
+#define RATIONAL_HAS_CONSTANT_EVALUATED
+#endif
+
+#if !defined(RATIONAL_INSTRUMENTATION)
+#define RATIONAL_INSTRUMENT(expression) static_cast<void>(0)
+#define RATIONAL_INSTRUMENTED_CONSTEXPR constexpr
+#define RATIONAL_CONSTANT_EVALUATION 1
+#elif defined(RATIONAL_HAS_CONSTANT_EVALUATED)
+#define RATIONAL_INSTRUMENT(expression) \
+    (__builtin_is_constant_evaluated() ? static_cast<void>(0) \
+            : static_cast<void>(expression))
+#define RATIONAL_INSTRUMENTED_CONSTEXPR constexpr
+#define RATIONAL_CONSTANT_EVALUATION 1
+#else
+#define RATIONAL_INSTRUMENT(expression) static_cast<void>(expression)
+#define RATIONAL_INSTRUMENTED_CONSTEXPR inline
+#define RATIONAL_CONSTANT_EVALUATION 0
+#endif
+
+/*
+ * Function checks, if instrumentation is compiled in.
+ */
+constexpr bool IsInstrumentationEnabled() {
+#ifdef RATIONAL_INSTRUMENTATION
+    return true;
+#else
+    return false;
+#endif
+}
+
+#endif /* RATIONAL_INSTRUMENTATION_H */
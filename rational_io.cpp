@@ -0,0 +1,254 @@
+#include "rational_io.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+/*
+ * Minimal size of chunk for parallel parsing, smaller texts are parsed
+ * by the calling thread.
+ */
+static const std::size_t ParseChunkSize = 1 << 20;
+
+/*
+ * Constructor class.
+ */
+rational_parse_error::rational_parse_error(std::errc code, std::size_t offset,
+        std::size_t line, std::size_t column)
+    : std::runtime_error("Error: can not parse rational at line " +
+            std::to_string(line) + ", column " + std::to_string(column) +
+            "!"),
+      error_code(code), error_offset(offset), error_line(line),
+      error_column(column)
+{
+}
+/*
+ * This function returns reason of the error.
+ */
+std::errc rational_parse_error::code() const {
+    return error_code;
+}
+/*
+ * This function returns offset of the wrong character.
+ */
+std::size_t rational_parse_error::offset() const {
+    return error_offset;
+}
+/*
+ * This function returns line of the wrong character, from 1.
+ */
+std::size_t rational_parse_error::line() const {
+    return error_line;
+}
+/*
+ * This function returns column of the wrong character, from 1.
+ */
+std::size_t rational_parse_error::column() const {
+    return error_column;
+}
+
+/*
+ * Function checks, if character separates rationals.
+ */
+static bool IsSeparator(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+/*
+ * Function raises `rational_parse_error` for character `position` of
+ * text, which starts at `base`. Lines are counted only here, so parsing
+ * does not track them.
+ */
+[[noreturn]] static void RaiseParseError(const char* base,
+        const char* position, std::errc code) {
+    std::size_t line = 1 + std::count(base, position, '\n');
+    const char* start = position;
+    while (start != base && start[-1] != '\n') {
+        --start;
+    }
+    throw rational_parse_error(code, position - base, line,
+            position - start + 1);
+}
+
+/*
+ * Function parses all rationals from `[first, last)` and appends them to
+ * `values`. `base` is the beginning of the whole text, for positions of
+ * errors.
+ */
+static void ParseChunk(const char* base, const char* first, const char* last,
+        std::vector<rational>& values) {
+    const char* current = first;
+    for (;;) {
+        while (current != last && IsSeparator(*current)) {
+            ++current;
+        }
+        if (current == last) {
+            return;
+        }
+        rational value;
+        parse_result result = ParseRational(current, last, value);
+        if (result.ec == std::errc() && result.ptr != last &&
+                !IsSeparator(*result.ptr)) {
+            result.ec = std::errc::invalid_argument;
+        }
+        if (result.ec != std::errc()) {
+            RaiseParseError(base, result.ptr, result.ec);
+        }
+        values.push_back(value);
+        current = result.ptr;
+    }
+}
+
+void ParseRationalText(const char* first, const char* last,
+        std::vector<rational>& values, thread_pool* pool) {
+    values.clear();
+    std::size_t size = last - first;
+    std::size_t chunks = pool == nullptr ? 1
+            : std::min(pool->size() * 4, size / ParseChunkSize);
+    if (chunks <= 1) {
+        ParseChunk(first, first, last, values);
+        return;
+    }
+    // chunk borders are moved to the beginning of the next line.
+    std::vector<const char*> borders(chunks + 1, last);
+    borders[0] = first;
+    for (std::size_t i = 1; i < chunks; i++) {
+        const char* border = std::max(first + size / chunks * i, borders[i - 1]);
+        const char* end = static_cast<const char*>(
+                std::memchr(border, '\n', last - border));
+        borders[i] = end == nullptr ? last : end + 1;
+    }
+    std::vector<std::vector<rational>> parts(chunks);
+    pool->parallelFor(chunks, [&](std::size_t i) {
+        parts[i].reserve((borders[i + 1] - borders[i]) / 8);
+        ParseChunk(first, borders[i], borders[i + 1], parts[i]);
+    });
+    std::size_t total = 0;
+    for (const std::vector<rational>& part : parts) {
+        total += part.size();
+    }
+    values.reserve(total);
+    for (const std::vector<rational>& part : parts) {
+        values.insert(values.end(), part.begin(), part.end());
+    }
+}
+
+void ParseRationalText(const char* first, const char* last,
+        rational_array& values, thread_pool* pool) {
+    std::vector<rational> parsed;
+    ParseRationalText(first, last, parsed, pool);
+    values = rational_array(parsed);
+}
+
+void ParseRationalFile(const std::string& path, std::vector<rational>& values,
+        thread_pool* pool) {
+    mapped_file file(path);
+    ParseRationalText(file.data(), file.data() + file.size(), values, pool);
+}
+
+void ParseRationalFile(const std::string& path, rational_array& values,
+        thread_pool* pool) {
+    mapped_file file(path);
+    ParseRationalText(file.data(), file.data() + file.size(), values, pool);
+}
+
+/*
+ * Constructor class. Creates or truncates file.
+ */
+rational_writer::rational_writer(const std::string& path, std::size_t capacity)
+    : path(path), descriptor(-1), output(nullptr),
+      buffer(std::max<std::size_t>(capacity, 256)), used(0)
+{
+    descriptor = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (descriptor < 0) {
+        throw std::runtime_error("Error: can not open file `" + path + "`!");
+    }
+}
+/*
+ * Constructor class. Rationals are written to the stream.
+ */
+rational_writer::rational_writer(std::ostream& stream, std::size_t capacity)
+    : descriptor(-1), output(&stream),
+      buffer(std::max<std::size_t>(capacity, 256)), used(0)
+{
+}
+/*
+ * Destructor class. Flushes the buffer and closes the file.
+ */
+rational_writer::~rational_writer() {
+    try {
+        flush();
+    } catch (std::runtime_error const& err) {
+    }
+    if (descriptor >= 0) {
+        ::close(descriptor);
+    }
+}
+/*
+ * This function returns free space of `length` characters in the buffer,
+ * the buffer is flushed, if there is not enough space.
+ */
+char* rational_writer::reserve(std::size_t length) {
+    if (buffer.size() - used < length) {
+        flush();
+    }
+    return buffer.data() + used;
+}
+/*
+ * This function adds all rationals of vector.
+ */
+void rational_writer::write(const std::vector<rational>& values) {
+    for (const rational& value : values) {
+        write(value);
+    }
+}
+/*
+ * This function adds all rationals of `rational_array`. Numerators and
+ * denominators are read from buffers without creating rationals.
+ */
+void rational_writer::write(const rational_array& values) {
+    const int* numerators = values.numerators();
+    const int* denominators = values.denominators();
+    for (std::size_t i = 0; i < values.size(); i++) {
+        char* end = reserve(MaxFormattedLength<int>() * 2 + 2);
+        end = FormatInteger(end, numerators[i]);
+        *end++ = '/';
+        end = FormatInteger(end, denominators[i]);
+        *end++ = '\n';
+        used = end - buffer.data();
+    }
+}
+/*
+ * This function writes the buffer to the file or stream. Partial writes
+ * and interrupted calls are repeated.
+ */
+void rational_writer::flush() {
+    if (used == 0) {
+        return;
+    }
+    if (output != nullptr) {
+        output->write(buffer.data(), used);
+        used = 0;
+        if (!*output) {
+            throw std::runtime_error("Error: can not write rationals!");
+        }
+        return;
+    }
+    const char* current = buffer.data();
+    std::size_t left = used;
+    used = 0;
+    while (left != 0) {
+        ssize_t written = ::write(descriptor, current, left);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("Error: can not write file `" + path + "`!");
+        }
+        current += written;
+        left -= written;
+    }
+}
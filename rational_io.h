@@ -0,0 +1,253 @@
+#ifndef RATIONAL_IO_H
+#define RATIONAL_IO_H
+
+#include "rational.h"
+#include "rational_array.h"
+#include "thread_pool.h"
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+/*
+ * Result of parsing, like `std::from_chars_result` of C++17.
+ *
+ * `ptr` - first character, which is not parsed. On error it points to
+ * the wrong character (or past the number, which does not fit).
+ * `ec` - `std::errc()` on success, otherwise:
+ * `std::errc::invalid_argument` - there is no number or no `/`;
+ * `std::errc::result_out_of_range` - value does not fit into the type;
+ * `std::errc::argument_out_of_domain` - denominator is zero.
+ */
+struct parse_result {
+    const char* ptr;
+    std::errc ec;
+};
+
+/*
+ * Function parses decimal integer with optional `-` from `[first, last)`.
+ * Leading whitespaces and `+` are not accepted, like `std::from_chars`.
+ * Does not depend on locale.
+ */
+template<typename T>
+parse_result ParseInteger(const char* first, const char* last, T& value) {
+    typedef typename integer_traits<T>::unsigned_type unsigned_type;
+    const char* current = first;
+    bool negative = current != last && *current == '-';
+    if (negative) {
+        ++current;
+    }
+    const char* digits = current;
+    unsigned_type magnitude = 0;
+    bool overflow = false;
+    for (; current != last; ++current) {
+        unsigned digit = static_cast<unsigned char>(*current) - '0';
+        if (digit > 9) {
+            break;
+        }
+        overflow |= __builtin_mul_overflow(magnitude, 10, &magnitude);
+        overflow |= __builtin_add_overflow(magnitude, digit, &magnitude);
+    }
+    if (current == digits) {
+        return {first, std::errc::invalid_argument};
+    }
+    const unsigned_type limit =
+            static_cast<unsigned_type>(integer_traits<T>::max()) + negative;
+    if (overflow || magnitude > limit) {
+        return {current, std::errc::result_out_of_range};
+    }
+    value = negative ? static_cast<T>(~magnitude + 1) : static_cast<T>(magnitude);
+    return {current, std::errc()};
+}
+
+/*
+ * Function parses rational in the format `n/d` from `[first, last)`.
+ *
+ * Checks are the same as in `setRational`: zero denominator is an error,
+ * unless numerator is zero. Value is normalized. If normalized value
+ * does not fit into the type (for example, `-2147483648/-1` for `int`),
+ * `std::errc::result_out_of_range` is returned instead of raising the
+ * error. `value` is changed only on success.
+ */
+template<typename T, typename OverflowPolicy>
+parse_result ParseRational(const char* first, const char* last,
+        basic_rational<T, OverflowPolicy>& value)
+{
+    T num = 0, deno = 0;
+    parse_result result = ParseInteger(first, last, num);
+    if (result.ec != std::errc()) {
+        return result;
+    }
+    if (result.ptr == last || *result.ptr != '/') {
+        return {result.ptr, std::errc::invalid_argument};
+    }
+    const char* denominator = result.ptr + 1;
+    result = ParseInteger(denominator, last, deno);
+    if (result.ec != std::errc()) {
+        return result;
+    }
+    if (num != 0 && deno == 0) {
+        return {denominator, std::errc::argument_out_of_domain};
+    }
+    if (deno < 0 && (num == integer_traits<T>::min() ||
+            deno == integer_traits<T>::min())) {
+        try {
+            value.setRational(num, deno);
+        } catch (std::overflow_error const& err) {
+            return {result.ptr, std::errc::result_out_of_range};
+        }
+        return result;
+    }
+    value.setRational(num, deno);
+    return result;
+}
+
+/*
+ * Class rational_parse_error. Error of bulk parsing.
+ *
+ * Public:
+ * 1. `code()` - reason, see `parse_result`.
+ * 2. `offset()` - offset of the wrong character from the beginning of text.
+ * 3. `line()`, `column()` - position of the wrong character, from 1.
+ */
+class rational_parse_error : public std::runtime_error {
+public:
+    rational_parse_error(std::errc code, std::size_t offset, std::size_t line,
+            std::size_t column);
+
+    std::errc code() const;
+    std::size_t offset() const;
+    std::size_t line() const;
+    std::size_t column() const;
+
+private:
+    std::errc error_code;
+    std::size_t error_offset;
+    std::size_t error_line;
+    std::size_t error_column;
+};
+
+/*
+ * Functions parse all rationals from text or memory-mapped file.
+ *
+ * Rationals are in the format `n/d`, separated by whitespaces (usually
+ * one per line). `values` is replaced by the result. Raises
+ * `rational_parse_error` with position of the first error.
+ *
+ * If `pool` is given, text is split into chunks on line boundaries and
+ * chunks are parsed in parallel. Result and errors do not depend on it.
+ */
+void ParseRationalText(const char* first, const char* last,
+        std::vector<rational>& values, thread_pool* pool = nullptr);
+void ParseRationalText(const char* first, const char* last,
+        rational_array& values, thread_pool* pool = nullptr);
+void ParseRationalFile(const std::string& path, std::vector<rational>& values,
+        thread_pool* pool = nullptr);
+void ParseRationalFile(const std::string& path, rational_array& values,
+        thread_pool* pool = nullptr);
+
+/*
+ * Result of formatting, like `std::to_chars_result` of C++17.
+ *
+ * `ptr` - end of written characters.
+ * `ec` - `std::errc()` on success, `std::errc::value_too_large`, if
+ * there is not enough space. Then `ptr` is `last` and contents of the
+ * range are unspecified.
+ */
+struct format_result {
+    char* ptr;
+    std::errc ec;
+};
+
+/*
+ * Function writes rational in the format `n/d` to `[first, last)`.
+ * Characters are the same as of `operator<<` with default flags, no
+ * terminating zero is written. Does not depend on locale.
+ */
+template<typename T, typename OverflowPolicy>
+format_result FormatRational(char* first, char* last,
+        const basic_rational<T, OverflowPolicy>& value)
+{
+    const std::size_t length = MaxFormattedLength<T>() * 2 + 1;
+    if (static_cast<std::size_t>(last - first) >= length) {
+        char* end = FormatInteger(first, value.numerator());
+        *end++ = '/';
+        return {FormatInteger(end, value.denominator()), std::errc()};
+    }
+    char buffer[length];
+    char* end = FormatInteger(buffer, value.numerator());
+    *end++ = '/';
+    end = FormatInteger(end, value.denominator());
+    if (end - buffer > last - first) {
+        return {last, std::errc::value_too_large};
+    }
+    std::memcpy(first, buffer, end - buffer);
+    return {first + (end - buffer), std::errc()};
+}
+
+/*
+ * Class rational_writer. Buffered writer of rationals to file or stream.
+ *
+ * Rationals are written in the format `n/d`, one per line, so the text
+ * is read back by `ParseRationalText`. They are formatted into the
+ * buffer, which is reused, and the buffer is written by large `write`
+ * calls, when it is full.
+ *
+ * Public:
+ * 1. `rational_writer(path, capacity)` - class initializer, creates or
+ * truncates file. Raises runtime error, if file can not be opened.
+ * 2. `rational_writer(stream, capacity)` - class initializer, rationals
+ * are written to the stream.
+ * 3. `write(value)`, `write(values)` - add rational, all rationals of
+ * vector or `rational_array`.
+ * 4. `flush()` - write the buffer. Raises runtime error, if the file or
+ * stream fails.
+ * Destructor flushes the buffer, errors are ignored there, so call
+ * `flush()` to check them.
+ *
+ * Private:
+ * 1. `path` - name of file, for errors.
+ * 2. `descriptor` - file descriptor, -1 for stream.
+ * 3. `output` - stream, `nullptr` for file.
+ * 4. `buffer` - formatted characters.
+ * 5. `used` - number of characters in the buffer.
+ */
+class rational_writer {
+public:
+    static const std::size_t DefaultCapacity = 1 << 20;
+
+    explicit rational_writer(const std::string& path,
+            std::size_t capacity = DefaultCapacity);
+    explicit rational_writer(std::ostream& stream,
+            std::size_t capacity = DefaultCapacity);
+    ~rational_writer();
+    rational_writer(const rational_writer&) = delete;
+    rational_writer& operator=(const rational_writer&) = delete;
+
+    template<typename T, typename OverflowPolicy>
+    void write(const basic_rational<T, OverflowPolicy>& value) {
+        char* end = reserve(MaxFormattedLength<T>() * 2 + 2);
+        end = FormatInteger(end, value.numerator());
+        *end++ = '/';
+        end = FormatInteger(end, value.denominator());
+        *end++ = '\n';
+        used = end - buffer.data();
+    }
+    void write(const std::vector<rational>& values);
+    void write(const rational_array& values);
+    void flush();
+
+private:
+    std::string path;
+    int descriptor;
+    std::ostream* output;
+    std::vector<char> buffer;
+    std::size_t used;
+
+    char* reserve(std::size_t length);
+};
+
+#endif /* RATIONAL_IO_H */
@@ -0,0 +1,426 @@
+#include "rational_matrix.h"
+#include "big_integer.h"
+#include "big_rational.h"
+#include <algorithm>
+#include <stdexcept>
+
+
+/*
+ * Number of columns, which are updated in all rows before the next
+ * columns, so the part of the pivot row stays in cache.
+ */
+static const std::size_t MatrixBlockColumns = 128;
+
+/*
+ * Minimal number of rows for parallel update and number of rows, which
+ * are updated by one task.
+ */
+static const std::size_t MatrixParallelRows = 64;
+static const std::size_t MatrixTaskRows = 16;
+
+/*
+ * Constructor class. All values are zero.
+ */
+rational_matrix::rational_matrix(std::size_t rows, std::size_t columns)
+    : row_count(rows), column_count(columns), values(rows * columns)
+{
+}
+/*
+ * Constructor class from nested list. Raises logical error, if rows
+ * have different sizes.
+ */
+rational_matrix::rational_matrix(
+        std::initializer_list<std::initializer_list<rational>> rows)
+    : row_count(rows.size()), column_count(rows.size() ? rows.begin()->size() : 0)
+{
+    values.reserve(row_count * column_count);
+    for (const std::initializer_list<rational>& row : rows) {
+        if (row.size() != column_count) {
+            throw std::logic_error("Error: matrix sizes do not match!");
+        }
+        values.insert(values.end(), row.begin(), row.end());
+    }
+}
+/*
+ * This function returns identity matrix `size x size`.
+ */
+rational_matrix rational_matrix::identity(std::size_t size) {
+    rational_matrix result(size, size);
+    for (std::size_t i = 0; i < size; i++) {
+        result(i, i) = 1;
+    }
+    return result;
+}
+/*
+ * This function returns number of rows.
+ */
+std::size_t rational_matrix::rows() const {
+    return row_count;
+}
+/*
+ * This function returns number of columns.
+ */
+std::size_t rational_matrix::columns() const {
+    return column_count;
+}
+/*
+ * This function returns value in row `row` and column `column`.
+ */
+rational& rational_matrix::operator()(std::size_t row, std::size_t column) {
+    return values[row * column_count + column];
+}
+const rational& rational_matrix::operator()(std::size_t row,
+        std::size_t column) const {
+    return values[row * column_count + column];
+}
+/*
+ * This function returns buffer of values.
+ */
+rational* rational_matrix::data() {
+    return values.data();
+}
+const rational* rational_matrix::data() const {
+    return values.data();
+}
+
+bool operator==(const rational_matrix& left, const rational_matrix& right) {
+    return left.row_count == right.row_count &&
+            left.column_count == right.column_count &&
+            left.values == right.values;
+}
+
+bool operator!=(const rational_matrix& left, const rational_matrix& right) {
+    return !(left == right);
+}
+
+/*
+ * Function converts exact fraction to `rational`. Raises overflow error,
+ * if reduced fraction does not fit.
+ */
+static rational ToRational(const big_rational& value) {
+    rational result;
+    if (!value.toRational(result)) {
+        RaiseOverflowError();
+    }
+    return result;
+}
+
+rational_matrix operator*(const rational_matrix& left,
+        const rational_matrix& right) {
+    if (left.columns() != right.rows()) {
+        throw std::logic_error("Error: matrix sizes do not match!");
+    }
+    rational_matrix result(left.rows(), right.columns());
+    for (std::size_t i = 0; i < left.rows(); i++) {
+        for (std::size_t j = 0; j < right.columns(); j++) {
+            big_rational sum;
+            for (std::size_t k = 0; k < left.columns(); k++) {
+                big_rational product = left(i, k);
+                product *= right(k, j);
+                sum += product;
+            }
+            result(i, j) = ToRational(sum);
+        }
+    }
+    return result;
+}
+
+std::ostream& operator<<(std::ostream& stream, const rational_matrix& matrix) {
+    for (std::size_t i = 0; i < matrix.rows(); i++) {
+        for (std::size_t j = 0; j < matrix.columns(); j++) {
+            stream << (j ? " " : "") << matrix(i, j);
+        }
+        stream << "\n";
+    }
+    return stream;
+}
+
+/*
+ * Checked operations of elimination. Return `false`, if result does not
+ * fit into the type, `big_integer` never overflows.
+ */
+static bool MultiplyChecked(__int128 a, __int128 b, __int128& result) {
+    return !__builtin_mul_overflow(a, b, &result);
+}
+static bool MultiplyChecked(const big_integer& a, const big_integer& b,
+        big_integer& result) {
+    result = a * b;
+    return true;
+}
+static bool SubtractChecked(__int128 a, __int128 b, __int128& result) {
+    return !__builtin_sub_overflow(a, b, &result);
+}
+static bool SubtractChecked(const big_integer& a, const big_integer& b,
+        big_integer& result) {
+    result = a - b;
+    return true;
+}
+static bool IsZero(__int128 value) {
+    return value == 0;
+}
+static bool IsZero(const big_integer& value) {
+    return value.isZero();
+}
+
+/*
+ * Integer matrix of elimination, row-major.
+ */
+template<typename Integer>
+struct integer_matrix {
+    std::size_t rows;
+    std::size_t columns;
+    std::vector<Integer> values;
+
+    Integer* row(std::size_t index) {
+        return values.data() + index * columns;
+    }
+};
+
+/*
+ * Function builds integer matrix `[left | right]` (`right` can be
+ * `nullptr`): every row is multiplied by the least common multiple of
+ * its denominators. Product of multipliers is written to `scale`.
+ * Returns `false`, if values do not fit into `Integer`.
+ */
+template<typename Integer>
+static bool ScaleRows(const rational_matrix& left, const rational_matrix* right,
+        integer_matrix<Integer>& matrix, big_integer& scale) {
+    std::size_t extra = right ? right->columns() : 0;
+    matrix.rows = left.rows();
+    matrix.columns = left.columns() + extra;
+    matrix.values.assign(matrix.rows * matrix.columns, Integer(0));
+    scale = 1;
+    for (std::size_t i = 0; i < matrix.rows; i++) {
+        const rational* parts[2] = {left.data() + i * left.columns(),
+                right ? right->data() + i * extra : nullptr};
+        const std::size_t sizes[2] = {left.columns(), extra};
+        Integer multiple = 1;
+        for (int part = 0; part < 2; part++) {
+            for (std::size_t j = 0; j < sizes[part]; j++) {
+                Integer deno = parts[part][j].denominator();
+                Integer gcd = GreatestCommonDivisor(multiple, deno);
+                if (!MultiplyChecked(Integer(multiple / gcd), deno, multiple)) {
+                    return false;
+                }
+            }
+        }
+        Integer* row = matrix.row(i);
+        for (int part = 0; part < 2; part++) {
+            for (std::size_t j = 0; j < sizes[part]; j++) {
+                const rational& value = parts[part][j];
+                if (!MultiplyChecked(Integer(multiple /
+                        Integer(value.denominator())),
+                        Integer(value.numerator()), *row++)) {
+                    return false;
+                }
+            }
+        }
+        scale *= big_integer(multiple);
+    }
+    return true;
+}
+
+/*
+ * Function runs Bareiss elimination on the first `pivot_columns` columns.
+ *
+ * Step with pivot `a[k][c]` updates other rows:
+ * `a[i][j] = (a[k][c] * a[i][j] - a[i][c] * a[k][j]) / previous pivot`,
+ * division is exact. Columns without pivot are skipped. Without
+ * `jordan` only rows below the pivot are updated (echelon form), with
+ * `jordan` all rows, then for nonsingular matrix the left part is
+ * `det * I`.
+ *
+ * Writes rank and sign of row permutation. Returns `false`, if values
+ * do not fit into `Integer`.
+ */
+template<typename Integer>
+static bool Eliminate(integer_matrix<Integer>& matrix, std::size_t pivot_columns,
+        bool jordan, thread_pool* pool, std::size_t& rank, int& sign) {
+    const std::size_t columns = matrix.columns;
+    Integer previous = 1;
+    std::vector<Integer> factors(matrix.rows);
+    rank = 0;
+    sign = 1;
+    for (std::size_t column = 0; column < pivot_columns && rank < matrix.rows;
+            column++) {
+        std::size_t pivot = rank;
+        while (pivot < matrix.rows && IsZero(matrix.row(pivot)[column])) {
+            pivot++;
+        }
+        if (pivot == matrix.rows) {
+            continue;
+        }
+        if (pivot != rank) {
+            std::swap_ranges(matrix.row(pivot), matrix.row(pivot) + columns,
+                    matrix.row(rank));
+            sign = -sign;
+        }
+        const Integer* pivot_row = matrix.row(rank);
+        const Integer pivot_value = pivot_row[column];
+        const std::size_t first_row = jordan ? 0 : rank + 1;
+        const std::size_t first_column = jordan ? 0 : column;
+        for (std::size_t i = first_row; i < matrix.rows; i++) {
+            factors[i] = matrix.row(i)[column];
+        }
+        auto update = [&](std::size_t begin, std::size_t end) {
+            Integer left, right;
+            for (std::size_t block = first_column; block < columns;
+                    block += MatrixBlockColumns) {
+                std::size_t block_end = std::min(block + MatrixBlockColumns,
+                        columns);
+                for (std::size_t i = begin; i < end; i++) {
+                    if (i == rank) {
+                        continue;
+                    }
+                    Integer* row = matrix.row(i);
+                    for (std::size_t j = block; j < block_end; j++) {
+                        if (!MultiplyChecked(pivot_value, row[j], left) ||
+                                !MultiplyChecked(factors[i], pivot_row[j],
+                                right) || !SubtractChecked(left, right, left)) {
+                            return false;
+                        }
+                        row[j] = left / previous;
+                    }
+                }
+            }
+            return true;
+        };
+        std::size_t count = matrix.rows - first_row;
+        if (pool == nullptr || count < MatrixParallelRows) {
+            if (!update(first_row, matrix.rows)) {
+                return false;
+            }
+        } else {
+            std::size_t tasks = (count + MatrixTaskRows - 1) / MatrixTaskRows;
+            std::vector<char> fits(tasks);
+            pool->parallelFor(tasks, [&](std::size_t task) {
+                std::size_t begin = first_row + task * MatrixTaskRows;
+                fits[task] = update(begin,
+                        std::min(begin + MatrixTaskRows, matrix.rows));
+            });
+            if (std::find(fits.begin(), fits.end(), 0) != fits.end()) {
+                return false;
+            }
+        }
+        previous = pivot_value;
+        rank++;
+    }
+    return true;
+}
+
+/*
+ * Function raises logical error, if matrix is not square.
+ */
+static void CheckSquare(const rational_matrix& matrix) {
+    if (matrix.rows() != matrix.columns()) {
+        throw std::logic_error("Error: matrix is not square!");
+    }
+}
+
+/*
+ * Functions compute results with `Integer` elimination. Return `false`,
+ * if values do not fit, then they are computed with `big_integer`.
+ */
+template<typename Integer>
+static bool DeterminantWith(const rational_matrix& matrix, thread_pool* pool,
+        rational& result) {
+    integer_matrix<Integer> integers;
+    big_integer scale;
+    std::size_t rank = 0;
+    int sign = 1;
+    if (!ScaleRows(matrix, nullptr, integers, scale) ||
+            !Eliminate(integers, matrix.columns(), false, pool, rank, sign)) {
+        return false;
+    }
+    if (rank < matrix.rows()) {
+        result = 0;
+        return true;
+    }
+    big_integer determinant(integers.row(rank - 1)[rank - 1]);
+    result = ToRational(big_rational(sign < 0 ? -determinant : determinant,
+            scale));
+    return true;
+}
+
+template<typename Integer>
+static bool RankWith(const rational_matrix& matrix, thread_pool* pool,
+        std::size_t& rank) {
+    integer_matrix<Integer> integers;
+    big_integer scale;
+    int sign = 1;
+    return ScaleRows(matrix, nullptr, integers, scale) &&
+            Eliminate(integers, matrix.columns(), false, pool, rank, sign);
+}
+
+template<typename Integer>
+static bool SolveWith(const rational_matrix& a, const rational_matrix& b,
+        thread_pool* pool, rational_matrix& result) {
+    integer_matrix<Integer> integers;
+    big_integer scale;
+    std::size_t rank = 0;
+    int sign = 1;
+    if (!ScaleRows(a, &b, integers, scale) ||
+            !Eliminate(integers, a.columns(), true, pool, rank, sign)) {
+        return false;
+    }
+    if (rank < a.rows()) {
+        throw std::logic_error("Error: matrix is singular!");
+    }
+    const std::size_t size = a.rows();
+    result = rational_matrix(size, b.columns());
+    for (std::size_t i = 0; i < size; i++) {
+        const Integer* row = integers.row(i);
+        big_integer diagonal(row[i]);
+        for (std::size_t j = 0; j < b.columns(); j++) {
+            result(i, j) = ToRational(big_rational(big_integer(row[size + j]),
+                    diagonal));
+        }
+    }
+    return true;
+}
+
+rational MatrixDeterminant(const rational_matrix& matrix, thread_pool* pool) {
+    CheckSquare(matrix);
+    rational result = 1;
+    if (matrix.rows() != 0 && !DeterminantWith<__int128>(matrix, pool, result)) {
+        DeterminantWith<big_integer>(matrix, pool, result);
+    }
+    return result;
+}
+
+std::size_t MatrixRank(const rational_matrix& matrix, thread_pool* pool) {
+    std::size_t rank = 0;
+    if (!RankWith<__int128>(matrix, pool, rank)) {
+        RankWith<big_integer>(matrix, pool, rank);
+    }
+    return rank;
+}
+
+rational_matrix MatrixInverse(const rational_matrix& matrix,
+        thread_pool* pool) {
+    CheckSquare(matrix);
+    return SolveLinearSystem(matrix, rational_matrix::identity(matrix.rows()),
+            pool);
+}
+
+rational_matrix SolveLinearSystem(const rational_matrix& a,
+        const rational_matrix& b, thread_pool* pool) {
+    CheckSquare(a);
+    if (b.rows() != a.rows()) {
+        throw std::logic_error("Error: matrix sizes do not match!");
+    }
+    rational_matrix result;
+    if (!SolveWith<__int128>(a, b, pool, result)) {
+        SolveWith<big_integer>(a, b, pool, result);
+    }
+    return result;
+}
+
+std::vector<rational> SolveLinearSystem(const rational_matrix& a,
+        const std::vector<rational>& b, thread_pool* pool) {
+    rational_matrix column(b.size(), 1);
+    std::copy(b.begin(), b.end(), column.data());
+    rational_matrix solution = SolveLinearSystem(a, column, pool);
+    return std::vector<rational>(solution.data(),
+            solution.data() + solution.rows());
+}
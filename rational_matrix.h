@@ -0,0 +1,100 @@
+#ifndef RATIONAL_MATRIX_H
+#define RATIONAL_MATRIX_H
+
+#include "rational.h"
+#include "thread_pool.h"
+#include <cstddef>
+#include <initializer_list>
+#include <ostream>
+#include <vector>
+
+/*
+ * Class rational_matrix. Dense matrix of `rational` in row-major order,
+ * all values are in one contiguous buffer.
+ *
+ * Public:
+ * 1. `rational_matrix(rows, columns)` - class initializer, all values are
+ * zero. Also can be created from nested list: `{{1, 2}, {3, 4}}`.
+ * 2. `identity(size)` - return identity matrix.
+ * 3. `rows()`, `columns()` - return size.
+ * 4. `operator()(row, column)` - return value.
+ * 5. `data()` - return buffer, row `i` starts at `data() + i * columns()`.
+ *
+ * Also operators: `==`, `!=`, `*`, `<<`.
+ *
+ * Private:
+ * 1. `row_count`, `column_count` - size.
+ * 2. `values` - buffer of values.
+ */
+class rational_matrix {
+public:
+    explicit rational_matrix(std::size_t rows = 0, std::size_t columns = 0);
+    rational_matrix(std::initializer_list<std::initializer_list<rational>> rows);
+
+    static rational_matrix identity(std::size_t size);
+
+    std::size_t rows() const;
+    std::size_t columns() const;
+    rational& operator()(std::size_t row, std::size_t column);
+    const rational& operator()(std::size_t row, std::size_t column) const;
+    rational* data();
+    const rational* data() const;
+
+    friend bool operator==(const rational_matrix& left,
+            const rational_matrix& right);
+
+private:
+    std::size_t row_count;
+    std::size_t column_count;
+    std::vector<rational> values;
+};
+
+bool operator!=(const rational_matrix& left, const rational_matrix& right);
+
+/*
+ * Product of matrices. Every value is accumulated exactly, so only the
+ * result must fit into `rational`, otherwise overflow error is raised.
+ * Raises logical error, if sizes do not match.
+ */
+rational_matrix operator*(const rational_matrix& left,
+        const rational_matrix& right);
+
+/*
+ * Output matrix by rows, values are separated by spaces.
+ */
+std::ostream& operator<<(std::ostream& stream, const rational_matrix& matrix);
+
+/*
+ * Exact linear algebra by Bareiss fraction-free elimination.
+ *
+ * Every row is multiplied by the least common multiple of its
+ * denominators, so elimination works with integers and divisions by
+ * the previous pivot are exact. Integers are `__int128` first; if they
+ * overflow, elimination is repeated with `big_integer`. Results are
+ * reduced once and must fit into `rational`, otherwise overflow error is
+ * raised.
+ *
+ * Rows are updated by blocks of columns, so the pivot row stays in
+ * cache. With `pool` the rows of large matrices are updated in parallel,
+ * the result does not depend on it.
+ *
+ * `MatrixDeterminant` - determinant of square matrix.
+ * `MatrixRank` - rank of any matrix.
+ * `MatrixInverse` - inverse of square matrix.
+ * `SolveLinearSystem` - solution `x` of `a * x = b` for square `a` and
+ * matrix or vector `b`.
+ * Raise logical error, if matrix is not square or sizes do not match,
+ * or if matrix is singular (for inverse and solution).
+ */
+rational MatrixDeterminant(const rational_matrix& matrix,
+        thread_pool* pool = nullptr);
+std::size_t MatrixRank(const rational_matrix& matrix,
+        thread_pool* pool = nullptr);
+rational_matrix MatrixInverse(const rational_matrix& matrix,
+        thread_pool* pool = nullptr);
+rational_matrix SolveLinearSystem(const rational_matrix& a,
+        const rational_matrix& b, thread_pool* pool = nullptr);
+std::vector<rational> SolveLinearSystem(const rational_matrix& a,
+        const std::vector<rational>& b, thread_pool* pool = nullptr);
+
+#endif /* RATIONAL_MATRIX_H */
@@ -0,0 +1,441 @@
+#include "rational_polynomial.h"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+
+/*
+ * Minimal number of coefficients, for which Karatsuba multiplication is
+ * used, smaller polynomials are multiplied by the schoolbook method.
+ */
+static const std::size_t KaratsubaThreshold = 16;
+
+/*
+ * Number of points, which are evaluated by one task of thread pool.
+ */
+static const std::size_t PolynomialTaskPoints = 1024;
+
+/*
+ * Constructor class from coefficients, lowest degree first.
+ * Numerators are brought to the least common multiple of denominators.
+ */
+rational_polynomial::rational_polynomial(std::initializer_list<rational> values)
+    : rational_polynomial(std::vector<rational>(values))
+{
+}
+rational_polynomial::rational_polynomial(const std::vector<rational>& values)
+    : common_denominator(1)
+{
+    for (const rational& value : values) {
+        big_integer deno = value.denominator();
+        common_denominator *= deno /
+                GreatestCommonDivisor(common_denominator, deno);
+    }
+    coefficients.reserve(values.size());
+    for (const rational& value : values) {
+        coefficients.push_back(big_integer(value.numerator()) *
+                (common_denominator / big_integer(value.denominator())));
+    }
+    normalize();
+}
+/*
+ * Constructor class from numerators over common denominator.
+ * Raises logical error, if denominator is zero.
+ */
+rational_polynomial::rational_polynomial(std::vector<big_integer> numerators,
+        const big_integer& denominator)
+    : coefficients(std::move(numerators)), common_denominator(denominator)
+{
+    if (common_denominator.isZero()) {
+        RaiseZeroDenominatorError();
+    }
+    normalize();
+}
+/*
+ * This function removes leading zero coefficients, makes denominator
+ * positive and divides all values by their greatest common divisor.
+ */
+void rational_polynomial::normalize() {
+    while (!coefficients.empty() && coefficients.back().isZero()) {
+        coefficients.pop_back();
+    }
+    if (coefficients.empty()) {
+        common_denominator = 1;
+        return;
+    }
+    if (common_denominator.sign() < 0) {
+        common_denominator = -common_denominator;
+        for (big_integer& value : coefficients) {
+            value = -value;
+        }
+    }
+    big_integer gcd = common_denominator;
+    const big_integer one = 1;
+    for (const big_integer& value : coefficients) {
+        if (gcd == one) {
+            return;
+        }
+        gcd = GreatestCommonDivisor(gcd, value);
+    }
+    if (gcd != one) {
+        common_denominator /= gcd;
+        for (big_integer& value : coefficients) {
+            value /= gcd;
+        }
+    }
+}
+/*
+ * This function returns degree, -1 for zero polynomial.
+ */
+int rational_polynomial::degree() const {
+    return static_cast<int>(coefficients.size()) - 1;
+}
+/*
+ * This function returns number of coefficients.
+ */
+std::size_t rational_polynomial::size() const {
+    return coefficients.size();
+}
+/*
+ * This function returns coefficient of `x^index`.
+ */
+big_rational rational_polynomial::coefficient(std::size_t index) const {
+    if (index >= coefficients.size()) {
+        return big_rational();
+    }
+    return big_rational(coefficients[index], common_denominator);
+}
+/*
+ * This function returns numerators of coefficients.
+ */
+const std::vector<big_integer>& rational_polynomial::numerators() const {
+    return coefficients;
+}
+/*
+ * This function returns common denominator.
+ */
+const big_integer& rational_polynomial::denominator() const {
+    return common_denominator;
+}
+/*
+ * This function returns value at point `x = p/q` by Horner's scheme in
+ * integers: `s = a[n]`, `s = s * p + a[i] * q^(n-i)`, value is
+ * `s / (denominator * q^n)`, it is reduced once.
+ */
+big_rational rational_polynomial::evaluate(const big_rational& x) const {
+    if (coefficients.empty()) {
+        return big_rational();
+    }
+    const big_integer p = x.numerator();
+    const big_integer q = x.denominator();
+    big_integer sum = coefficients.back();
+    big_integer power = 1;
+    for (std::size_t i = coefficients.size() - 1; i-- > 0;) {
+        power *= q;
+        sum *= p;
+        sum += coefficients[i] * power;
+    }
+    return big_rational(sum, common_denominator * power);
+}
+
+/*
+ * Function adds or subtracts numerators over the least common multiple
+ * of denominators: `a/d1 + b/d2 = (a*(d2/g) + b*(d1/g)) / (d1*d2/g)`.
+ */
+static void AddPolynomial(std::vector<big_integer>& left,
+        big_integer& left_denominator, const std::vector<big_integer>& right,
+        const big_integer& right_denominator, bool subtract) {
+    big_integer gcd = GreatestCommonDivisor(left_denominator,
+            right_denominator);
+    const big_integer left_factor = right_denominator / gcd;
+    const big_integer right_factor = left_denominator / gcd;
+    const big_integer one = 1;
+    if (left.size() < right.size()) {
+        left.resize(right.size());
+    }
+    for (std::size_t i = 0; i < left.size(); i++) {
+        if (left_factor != one) {
+            left[i] *= left_factor;
+        }
+        if (i < right.size()) {
+            big_integer value = right[i] * right_factor;
+            if (subtract) {
+                left[i] -= value;
+            } else {
+                left[i] += value;
+            }
+        }
+    }
+    left_denominator *= left_factor;
+}
+
+rational_polynomial& rational_polynomial::operator+=(
+        const rational_polynomial& right) {
+    AddPolynomial(coefficients, common_denominator, right.coefficients,
+            right.common_denominator, false);
+    normalize();
+    return *this;
+}
+
+rational_polynomial& rational_polynomial::operator-=(
+        const rational_polynomial& right) {
+    AddPolynomial(coefficients, common_denominator, right.coefficients,
+            right.common_denominator, true);
+    normalize();
+    return *this;
+}
+
+/*
+ * Function adds product `a * b` to `result`:
+ * `result[i + j] += a[i] * b[j]`.
+ */
+static void MultiplySchoolbook(const big_integer* a, std::size_t a_size,
+        const big_integer* b, std::size_t b_size, big_integer* result) {
+    for (std::size_t i = 0; i < a_size; i++) {
+        if (a[i].isZero()) {
+            continue;
+        }
+        for (std::size_t j = 0; j < b_size; j++) {
+            result[i + j] += a[i] * b[j];
+        }
+    }
+}
+
+/*
+ * Function adds product of two polynomials of `size` coefficients to
+ * `result` (`2 * size - 1` coefficients) by Karatsuba method:
+ * `(a0 + a1 x^h)(b0 + b1 x^h) = z0 + (z1 - z0 - z2) x^h + z2 x^2h`, where
+ * `z0 = a0 b0`, `z2 = a1 b1`, `z1 = (a0 + a1)(b0 + b1)`, so three
+ * products of half size are computed instead of four.
+ */
+static void MultiplyKaratsuba(const big_integer* a, const big_integer* b,
+        std::size_t size, big_integer* result) {
+    if (size < KaratsubaThreshold) {
+        MultiplySchoolbook(a, size, b, size, result);
+        return;
+    }
+    const std::size_t low = size / 2;
+    const std::size_t high = size - low;
+    std::vector<big_integer> z0(2 * low - 1), z1(2 * high - 1),
+            z2(2 * high - 1);
+    MultiplyKaratsuba(a, b, low, z0.data());
+    MultiplyKaratsuba(a + low, b + low, high, z2.data());
+    std::vector<big_integer> a_sum(a + low, a + size), b_sum(b + low, b + size);
+    for (std::size_t i = 0; i < low; i++) {
+        a_sum[i] += a[i];
+        b_sum[i] += b[i];
+    }
+    MultiplyKaratsuba(a_sum.data(), b_sum.data(), high, z1.data());
+    for (std::size_t i = 0; i < z0.size(); i++) {
+        result[i] += z0[i];
+        z1[i] -= z0[i];
+    }
+    for (std::size_t i = 0; i < z2.size(); i++) {
+        result[i + 2 * low] += z2[i];
+        z1[i] -= z2[i];
+    }
+    for (std::size_t i = 0; i < z1.size(); i++) {
+        result[i + low] += z1[i];
+    }
+}
+
+/*
+ * Function returns product of two integer polynomials. The longer one
+ * is split into parts of the size of the shorter one, parts are
+ * multiplied by Karatsuba method.
+ */
+static std::vector<big_integer> MultiplyNumerators(
+        const std::vector<big_integer>& left,
+        const std::vector<big_integer>& right) {
+    if (left.empty() || right.empty()) {
+        return std::vector<big_integer>();
+    }
+    const std::vector<big_integer>& longer =
+            left.size() >= right.size() ? left : right;
+    const std::vector<big_integer>& shorter =
+            left.size() >= right.size() ? right : left;
+    std::vector<big_integer> result(longer.size() + shorter.size() - 1);
+    const std::size_t size = shorter.size();
+    if (size < KaratsubaThreshold) {
+        MultiplySchoolbook(longer.data(), longer.size(), shorter.data(), size,
+                result.data());
+        return result;
+    }
+    std::vector<big_integer> part(size), product(2 * size - 1);
+    for (std::size_t first = 0; first < longer.size(); first += size) {
+        std::size_t count = std::min(size, longer.size() - first);
+        std::copy(longer.begin() + first, longer.begin() + first + count,
+                part.begin());
+        std::fill(part.begin() + count, part.end(), big_integer());
+        std::fill(product.begin(), product.end(), big_integer());
+        MultiplyKaratsuba(part.data(), shorter.data(), size, product.data());
+        for (std::size_t i = 0; i < product.size() &&
+                first + i < result.size(); i++) {
+            result[first + i] += product[i];
+        }
+    }
+    return result;
+}
+
+rational_polynomial& rational_polynomial::operator*=(
+        const rational_polynomial& right) {
+    coefficients = MultiplyNumerators(coefficients, right.coefficients);
+    common_denominator *= right.common_denominator;
+    normalize();
+    return *this;
+}
+
+bool operator==(const rational_polynomial& left,
+        const rational_polynomial& right) {
+    return left.common_denominator == right.common_denominator &&
+            left.coefficients == right.coefficients;
+}
+
+bool operator!=(const rational_polynomial& left,
+        const rational_polynomial& right) {
+    return !(left == right);
+}
+
+rational_polynomial operator+(rational_polynomial left,
+        const rational_polynomial& right) {
+    left += right;
+    return left;
+}
+
+rational_polynomial operator-(rational_polynomial left,
+        const rational_polynomial& right) {
+    left -= right;
+    return left;
+}
+
+rational_polynomial operator*(const rational_polynomial& left,
+        const rational_polynomial& right) {
+    rational_polynomial result = left;
+    result *= right;
+    return result;
+}
+
+std::ostream& operator<<(std::ostream& stream,
+        const rational_polynomial& polynomial) {
+    stream << polynomial.coefficient(0);
+    for (std::size_t i = 1; i < polynomial.size(); i++) {
+        stream << " " << polynomial.coefficient(i);
+    }
+    return stream;
+}
+
+/*
+ * Pseudo-division of integer polynomials `a` and `b` (degree `n`,
+ * leading value `c`): `c^(m-n+1) * a = q * b + r`. Every step multiplies
+ * quotient and remainder by `c` and removes the leading value of the
+ * remainder, so no fractions appear.
+ */
+void PolynomialDivide(const rational_polynomial& dividend,
+        const rational_polynomial& divisor, rational_polynomial& quotient,
+        rational_polynomial& remainder) {
+    if (divisor.size() == 0) {
+        throw std::logic_error("Error: division by zero polynomial!");
+    }
+    const std::vector<big_integer>& b = divisor.numerators();
+    const std::size_t n = b.size() - 1;
+    if (dividend.size() <= n) {
+        remainder = dividend;
+        quotient = rational_polynomial();
+        return;
+    }
+    const big_integer& leading = b.back();
+    const bool scale = leading != big_integer(1);
+    std::vector<big_integer> r = dividend.numerators();
+    std::vector<big_integer> q(r.size() - n);
+    big_integer power = 1;
+    for (std::size_t k = q.size(); k-- > 0;) {
+        const big_integer top = r[n + k];
+        if (scale) {
+            for (std::size_t j = k + 1; j < q.size(); j++) {
+                q[j] *= leading;
+            }
+            for (std::size_t i = 0; i < n + k; i++) {
+                r[i] *= leading;
+            }
+            power *= leading;
+        }
+        q[k] = top;
+        if (!top.isZero()) {
+            for (std::size_t i = 0; i < n; i++) {
+                r[k + i] -= top * b[i];
+            }
+        }
+        r[n + k] = 0;
+    }
+    r.resize(n);
+    // `dividend = a / da`, `divisor = b / db`, so
+    // `quotient = q * db / (c^e * da)`, `remainder = r / (c^e * da)`.
+    const big_integer denominator = power * dividend.denominator();
+    for (big_integer& value : q) {
+        value *= divisor.denominator();
+    }
+    quotient = rational_polynomial(std::move(q), denominator);
+    remainder = rational_polynomial(std::move(r), denominator);
+}
+
+/*
+ * Function computes Horner's scheme at `p/q` in `__int128`.
+ * Returns `false`, if values overflow.
+ */
+static bool EvaluateChecked(const std::vector<__int128>& coefficients,
+        __int128 p, __int128 q, __int128& sum, __int128& power) {
+    sum = coefficients.back();
+    power = 1;
+    for (std::size_t i = coefficients.size() - 1; i-- > 0;) {
+        __int128 term;
+        if (__builtin_mul_overflow(power, q, &power) ||
+                __builtin_mul_overflow(sum, p, &sum) ||
+                __builtin_mul_overflow(coefficients[i], power, &term) ||
+                __builtin_add_overflow(sum, term, &sum)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<big_rational> EvaluatePolynomial(
+        const rational_polynomial& polynomial,
+        const std::vector<rational>& points, thread_pool* pool) {
+    std::vector<big_rational> results(points.size());
+    const std::vector<big_integer>& numerators = polynomial.numerators();
+    if (numerators.empty()) {
+        return results;
+    }
+    std::vector<__int128> small(numerators.size());
+    __int128 denominator = 0;
+    bool fits = polynomial.denominator().toInt128(denominator);
+    for (std::size_t i = 0; i < numerators.size() && fits; i++) {
+        fits = numerators[i].toInt128(small[i]);
+    }
+    auto evaluate = [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; i++) {
+            const rational& x = points[i];
+            __int128 sum, power;
+            if (fits && EvaluateChecked(small, x.numerator(), x.denominator(),
+                    sum, power) &&
+                    !__builtin_mul_overflow(power, denominator, &power)) {
+                // Value is reduced in `__int128` without big integers.
+                results[i] = basic_rational<__int128>(sum, power);
+            } else {
+                results[i] = polynomial.evaluate(x);
+            }
+        }
+    };
+    const std::size_t tasks = (points.size() + PolynomialTaskPoints - 1) /
+            PolynomialTaskPoints;
+    if (pool == nullptr || tasks < 2) {
+        evaluate(0, points.size());
+    } else {
+        pool->parallelFor(tasks, [&](std::size_t task) {
+            std::size_t first = task * PolynomialTaskPoints;
+            evaluate(first, std::min(first + PolynomialTaskPoints,
+                    points.size()));
+        });
+    }
+    return results;
+}
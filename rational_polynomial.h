@@ -0,0 +1,113 @@
+#ifndef RATIONAL_POLYNOMIAL_H
+#define RATIONAL_POLYNOMIAL_H
+
+#include "big_integer.h"
+#include "big_rational.h"
+#include "rational.h"
+#include "thread_pool.h"
+#include <cstddef>
+#include <initializer_list>
+#include <ostream>
+#include <vector>
+
+/*
+ * Class rational_polynomial. Polynomial with rational coefficients.
+ *
+ * Coefficients are stored as integer numerators over one common
+ * denominator, lowest degree first. Operations work with integers and
+ * the result is normalized once: the denominator is positive, the
+ * greatest common divisor of all numerators and the denominator is 1 and
+ * the leading numerator is not zero. Zero polynomial has no coefficients.
+ *
+ * Public:
+ * 1. `rational_polynomial(coefficients)` - class initializer, coefficients
+ * are lowest degree first: `{1, 0, rational(1, 2)}` is `1 + x^2/2`. By
+ * default zero polynomial. Also can be created from integer numerators
+ * and common denominator.
+ * 2. `degree()` - return degree, -1 for zero polynomial.
+ * 3. `size()` - return number of coefficients.
+ * 4. `coefficient(index)` - return coefficient of `x^index`.
+ * 5. `numerators()`, `denominator()` - return normalized representation.
+ * 6. `evaluate(x)` - return value at point `x`.
+ *
+ * Also operators: `+`, `-`, `*`, `+=`, `-=`, `*=`, `==`, `!=`, `<<`.
+ *
+ * Private:
+ * 1. `coefficients` - numerators of coefficients.
+ * 2. `common_denominator` - denominator of all coefficients.
+ * 3. `normalize()` - bring to normalized representation.
+ */
+class rational_polynomial {
+public:
+    rational_polynomial() : common_denominator(1) {}
+    rational_polynomial(std::initializer_list<rational> values);
+    explicit rational_polynomial(const std::vector<rational>& values);
+    rational_polynomial(std::vector<big_integer> numerators,
+            const big_integer& denominator);
+
+    int degree() const;
+    std::size_t size() const;
+    big_rational coefficient(std::size_t index) const;
+    const std::vector<big_integer>& numerators() const;
+    const big_integer& denominator() const;
+    big_rational evaluate(const big_rational& x) const;
+
+    rational_polynomial& operator+=(const rational_polynomial& right);
+    rational_polynomial& operator-=(const rational_polynomial& right);
+    rational_polynomial& operator*=(const rational_polynomial& right);
+
+    friend bool operator==(const rational_polynomial& left,
+            const rational_polynomial& right);
+
+private:
+    std::vector<big_integer> coefficients;
+    big_integer common_denominator;
+
+    void normalize();
+};
+
+/*
+ * Operators:
+ * `+`, `-` - sum and difference of two polynomials.
+ * `*` - product of two polynomials, Karatsuba multiplication of
+ * numerators for large polynomials.
+ * `!=` - check if two polynomials are not equal.
+ */
+rational_polynomial operator+(rational_polynomial left,
+        const rational_polynomial& right);
+rational_polynomial operator-(rational_polynomial left,
+        const rational_polynomial& right);
+rational_polynomial operator*(const rational_polynomial& left,
+        const rational_polynomial& right);
+bool operator!=(const rational_polynomial& left,
+        const rational_polynomial& right);
+
+/*
+ * Output coefficients lowest degree first, separated by spaces.
+ */
+std::ostream& operator<<(std::ostream& stream,
+        const rational_polynomial& polynomial);
+
+/*
+ * Function divides `dividend` by `divisor` with remainder:
+ * `dividend = quotient * divisor + remainder`, degree of remainder is
+ * less than degree of divisor. Integer pseudo-division is used, so
+ * quotient and remainder are normalized once. Raises logical error, if
+ * divisor is zero.
+ */
+void PolynomialDivide(const rational_polynomial& dividend,
+        const rational_polynomial& divisor, rational_polynomial& quotient,
+        rational_polynomial& remainder);
+
+/*
+ * Function evaluates polynomial at every point by Horner's scheme in
+ * integers: at `p/q` it computes `sum(a[i] * p^i * q^(n-i))` and reduces
+ * only the value. Coefficients are prepared once for all points. Values
+ * are computed in `__int128`, while they fit, otherwise in
+ * `big_integer`. With `pool` the points are evaluated in parallel.
+ */
+std::vector<big_rational> EvaluatePolynomial(
+        const rational_polynomial& polynomial,
+        const std::vector<rational>& points, thread_pool* pool = nullptr);
+
+#endif /* RATIONAL_POLYNOMIAL_H */
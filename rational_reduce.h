@@ -0,0 +1,118 @@
+#ifndef RATIONAL_REDUCE_H
+#define RATIONAL_REDUCE_H
+
+#include "rational.h"
+#include "thread_pool.h"
+#include <cstddef>
+#include <vector>
+
+/*
+ * Number of values, which are reduced by one task. Chunks do not depend
+ * on the number of threads, so the order of operations (and overflow
+ * errors) is the same for every thread pool.
+ */
+const std::size_t RationalReduceChunk = 4096;
+
+/*
+ * Function reduces `count` values (`count > 0`) with balanced pairwise
+ * tree: both halves are reduced, then the two results are combined.
+ *
+ * Operands of a chained reduction `((a + b) + c) + ...` grow with every
+ * step, operands of the tree grow only with its depth, `log2(count)`.
+ */
+template<typename Value, typename Operation>
+Value PairwiseReduce(const Value* values, std::size_t count,
+        Operation operation)
+{
+    if (count == 1) {
+        return values[0];
+    }
+    if (count == 2) {
+        return operation(values[0], values[1]);
+    }
+    std::size_t half = count / 2;
+    return operation(PairwiseReduce(values, half, operation),
+            PairwiseReduce(values + half, count - half, operation));
+}
+
+/*
+ * Function reduces `count` values with pairwise tree over chunks of
+ * `RationalReduceChunk` values. Chunks are reduced in parallel by `pool`,
+ * then their results are reduced in index order, so the result is
+ * deterministic. Returns `identity` for empty range.
+ */
+template<typename Value, typename Operation>
+Value ParallelReduce(const Value* values, std::size_t count, Value identity,
+        Operation operation, thread_pool& pool)
+{
+    if (count == 0) {
+        return identity;
+    }
+    if (count <= RationalReduceChunk) {
+        return PairwiseReduce(values, count, operation);
+    }
+    std::size_t chunks = (count + RationalReduceChunk - 1) / RationalReduceChunk;
+    std::vector<Value> partial(chunks);
+    pool.parallelFor(chunks, [&](std::size_t chunk) {
+        std::size_t begin = chunk * RationalReduceChunk;
+        std::size_t size = count - begin < RationalReduceChunk
+                ? count - begin : RationalReduceChunk;
+        partial[chunk] = PairwiseReduce(values + begin, size, operation);
+    });
+    return PairwiseReduce(partial.data(), chunks, operation);
+}
+
+/*
+ * Functions return sum and product of `count` rationals, starting at
+ * `values`. Work is split between threads of `pool` (by default
+ * `DefaultThreadPool()`).
+ *
+ * Rational arithmetic is exact, so the result is equal to the serial
+ * `a[0] + a[1] + ...`. Raises the same errors as `rational` operators,
+ * if some partial result does not fit into the type. Sum of empty range
+ * is `0/1`, product of empty range is `1/1`.
+ */
+template<typename T, typename OverflowPolicy>
+basic_rational<T, OverflowPolicy> RationalSum(
+        const basic_rational<T, OverflowPolicy>* values, std::size_t count,
+        thread_pool& pool = DefaultThreadPool())
+{
+    typedef basic_rational<T, OverflowPolicy> value_type;
+    return ParallelReduce(values, count, value_type(0, 1),
+            [](const value_type& left, const value_type& right) {
+        return left + right;
+    }, pool);
+}
+
+template<typename T, typename OverflowPolicy>
+basic_rational<T, OverflowPolicy> RationalProduct(
+        const basic_rational<T, OverflowPolicy>* values, std::size_t count,
+        thread_pool& pool = DefaultThreadPool())
+{
+    typedef basic_rational<T, OverflowPolicy> value_type;
+    return ParallelReduce(values, count, value_type(1, 1),
+            [](const value_type& left, const value_type& right) {
+        return left * right;
+    }, pool);
+}
+
+/*
+ * Overloads for `std::vector`.
+ */
+template<typename T, typename OverflowPolicy>
+basic_rational<T, OverflowPolicy> RationalSum(
+        const std::vector<basic_rational<T, OverflowPolicy>>& values,
+        thread_pool& pool = DefaultThreadPool())
+{
+    return RationalSum(values.data(), values.size(), pool);
+}
+
+template<typename T, typename OverflowPolicy>
+basic_rational<T, OverflowPolicy> RationalProduct(
+        const std::vector<basic_rational<T, OverflowPolicy>>& values,
+        thread_pool& pool = DefaultThreadPool())
+{
+    return RationalProduct(values.data(), values.size(), pool);
+}
+
+#endif /* RATIONAL_REDUCE_H */
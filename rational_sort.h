@@ -0,0 +1,273 @@
+#ifndef RATIONAL_SORT_H
+#define RATIONAL_SORT_H
+
+#include "rational.h"
+#include "rational_float.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+/*
+ * Sorting of rationals by floating point keys.
+ *
+ * Key of `n/d` is the nearest double. Rounding is monotonic: if
+ * `a < b`, then `key(a) <= key(b)`, so values sorted by keys are in
+ * order, except runs of equal keys. Only these runs are sorted again by
+ * exact comparison. Keys are mapped to unsigned integers with the same
+ * order and sorted by radix sort, so most comparisons of rationals are
+ * replaced by a few passes over the array.
+ *
+ * For `int` numerator and denominator are exact doubles and one division
+ * is the correctly rounded key. Wider types use `RationalToDouble`.
+ */
+
+/*
+ * Arrays shorter than this are sorted by `std::sort` with exact
+ * comparison.
+ */
+const std::size_t RationalSortThreshold = 256;
+
+/*
+ * Parallel sort is used for arrays of at least this size, smaller arrays
+ * are sorted serially.
+ */
+const std::size_t RationalParallelSortThreshold = 1 << 16;
+
+/*
+ * Struct rational_sort_entry. Value with its sort key.
+ */
+template<typename Rational>
+struct rational_sort_entry {
+    unsigned long long key;
+    Rational value;
+};
+
+/*
+ * Function maps double to unsigned integer with the same order: sign bit
+ * is inverted for positive values, all bits for negative values.
+ */
+inline unsigned long long OrderedDoubleBits(double value) {
+    unsigned long long bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits >> 63 ? ~bits : bits | (1ULL << 63);
+}
+
+/*
+ * Functions return the correctly rounded double of rational: by one
+ * division for `int` and by `RationalToDouble` for wider types.
+ */
+template<typename T, typename OverflowPolicy>
+double RationalSortDouble(const basic_rational<T, OverflowPolicy>& value,
+        std::true_type) {
+    return static_cast<double>(value.numerator()) / value.denominator();
+}
+template<typename T, typename OverflowPolicy>
+double RationalSortDouble(const basic_rational<T, OverflowPolicy>& value,
+        std::false_type) {
+    return RationalToDouble(value);
+}
+
+/*
+ * Function returns sort key of rational.
+ */
+template<typename T, typename OverflowPolicy>
+unsigned long long RationalSortKey(
+        const basic_rational<T, OverflowPolicy>& value) {
+    return OrderedDoubleBits(RationalSortDouble(value,
+            std::integral_constant<bool, sizeof(T) <= sizeof(int)>()));
+}
+
+/*
+ * Function sorts entries by keys with LSD radix sort by 11-bit digits
+ * (6 passes), `scratch` must have `count` entries. Histograms of all
+ * digits are counted in one pass, digits, which are equal in all keys,
+ * are skipped. Returns pointer to sorted entries (`entries` or
+ * `scratch`).
+ */
+template<typename Entry>
+Entry* RadixSortEntries(Entry* entries, Entry* scratch, std::size_t count) {
+    const int bits = 11;
+    const int passes = (64 + bits - 1) / bits;
+    const unsigned long long mask = (1ULL << bits) - 1;
+    std::vector<std::size_t> histogram(passes << bits);
+    for (std::size_t i = 0; i < count; i++) {
+        unsigned long long key = entries[i].key;
+        for (int pass = 0; pass < passes; pass++) {
+            histogram[(pass << bits) + ((key >> (bits * pass)) & mask)]++;
+        }
+    }
+    for (int pass = 0; pass < passes; pass++) {
+        std::size_t* counts = &histogram[pass << bits];
+        if (counts[(entries[0].key >> (bits * pass)) & mask] == count) {
+            continue;
+        }
+        std::size_t offset = 0;
+        for (std::size_t digit = 0; digit <= mask; digit++) {
+            std::size_t size = counts[digit];
+            counts[digit] = offset;
+            offset += size;
+        }
+        for (std::size_t i = 0; i < count; i++) {
+            scratch[counts[(entries[i].key >> (bits * pass)) & mask]++] =
+                    entries[i];
+        }
+        std::swap(entries, scratch);
+    }
+    return entries;
+}
+
+/*
+ * Function sorts runs of equal keys by exact comparison.
+ */
+template<typename Entry>
+void ResolveSortTies(Entry* entries, std::size_t count) {
+    std::size_t begin = 0;
+    while (begin < count) {
+        std::size_t end = begin + 1;
+        while (end < count && entries[end].key == entries[begin].key) {
+            end++;
+        }
+        if (end - begin > 1) {
+            std::sort(entries + begin, entries + end,
+                    [](const Entry& left, const Entry& right) {
+                return left.value < right.value;
+            });
+        }
+        begin = end;
+    }
+}
+
+/*
+ * Function sorts `count` entries with keys and writes values to
+ * `values`.
+ */
+template<typename Rational>
+void SortRationalEntries(rational_sort_entry<Rational>* entries,
+        rational_sort_entry<Rational>* scratch, std::size_t count,
+        Rational* values) {
+    if (count == 0) {
+        return;
+    }
+    rational_sort_entry<Rational>* sorted =
+            RadixSortEntries(entries, scratch, count);
+    ResolveSortTies(sorted, count);
+    for (std::size_t i = 0; i < count; i++) {
+        values[i] = sorted[i].value;
+    }
+}
+
+/*
+ * Function sorts `count` rationals, starting at `values`, in ascending
+ * order. The result is the same as `std::sort`.
+ */
+template<typename T, typename OverflowPolicy>
+void RationalSort(basic_rational<T, OverflowPolicy>* values,
+        std::size_t count) {
+    typedef basic_rational<T, OverflowPolicy> value_type;
+    if (count < RationalSortThreshold) {
+        std::sort(values, values + count);
+        return;
+    }
+    std::vector<rational_sort_entry<value_type>> entries(count), scratch(count);
+    for (std::size_t i = 0; i < count; i++) {
+        entries[i].key = RationalSortKey(values[i]);
+        entries[i].value = values[i];
+    }
+    SortRationalEntries(entries.data(), scratch.data(), count, values);
+}
+
+/*
+ * Parallel version, sample sort with threads of `pool`.
+ *
+ * Keys of every 64th entry are sorted and split into buckets of equal
+ * size, so equal keys are always in one bucket. Chunks of the array
+ * count and scatter their entries to buckets in parallel, then buckets
+ * are sorted in parallel, every one by radix sort and exact comparison
+ * of ties.
+ */
+template<typename T, typename OverflowPolicy>
+void RationalSort(basic_rational<T, OverflowPolicy>* values,
+        std::size_t count, thread_pool& pool) {
+    typedef rational_sort_entry<basic_rational<T, OverflowPolicy>> entry;
+    if (count < RationalParallelSortThreshold || pool.size() < 2) {
+        RationalSort(values, count);
+        return;
+    }
+    const std::size_t chunk_size = 1 << 14;
+    std::size_t chunks = (count + chunk_size - 1) / chunk_size;
+    std::vector<entry> entries(count), buckets(count);
+    pool.parallelFor(chunks, [&](std::size_t chunk) {
+        std::size_t end = std::min(count, (chunk + 1) * chunk_size);
+        for (std::size_t i = chunk * chunk_size; i < end; i++) {
+            entries[i].key = RationalSortKey(values[i]);
+            entries[i].value = values[i];
+        }
+    });
+
+    std::size_t bucket_count = 4 * pool.size();
+    std::vector<unsigned long long> samples;
+    for (std::size_t i = 0; i < count; i += 64) {
+        samples.push_back(entries[i].key);
+    }
+    std::sort(samples.begin(), samples.end());
+    std::vector<unsigned long long> splitters(bucket_count - 1);
+    for (std::size_t i = 1; i < bucket_count; i++) {
+        splitters[i - 1] = samples[i * samples.size() / bucket_count];
+    }
+    auto bucket_of = [&splitters](unsigned long long key) {
+        return static_cast<std::size_t>(std::upper_bound(splitters.begin(),
+                splitters.end(), key) - splitters.begin());
+    };
+
+    // `offsets[chunk * bucket_count + bucket]` - where the chunk writes
+    // its entries of the bucket.
+    std::vector<std::size_t> offsets(chunks * bucket_count);
+    pool.parallelFor(chunks, [&](std::size_t chunk) {
+        std::size_t end = std::min(count, (chunk + 1) * chunk_size);
+        std::size_t* counts = &offsets[chunk * bucket_count];
+        for (std::size_t i = chunk * chunk_size; i < end; i++) {
+            counts[bucket_of(entries[i].key)]++;
+        }
+    });
+    std::vector<std::size_t> bucket_begin(bucket_count + 1);
+    std::size_t offset = 0;
+    for (std::size_t bucket = 0; bucket < bucket_count; bucket++) {
+        bucket_begin[bucket] = offset;
+        for (std::size_t chunk = 0; chunk < chunks; chunk++) {
+            std::size_t size = offsets[chunk * bucket_count + bucket];
+            offsets[chunk * bucket_count + bucket] = offset;
+            offset += size;
+        }
+    }
+    bucket_begin[bucket_count] = count;
+    pool.parallelFor(chunks, [&](std::size_t chunk) {
+        std::size_t end = std::min(count, (chunk + 1) * chunk_size);
+        std::size_t* next = &offsets[chunk * bucket_count];
+        for (std::size_t i = chunk * chunk_size; i < end; i++) {
+            buckets[next[bucket_of(entries[i].key)]++] = entries[i];
+        }
+    });
+    pool.parallelFor(bucket_count, [&](std::size_t bucket) {
+        std::size_t begin = bucket_begin[bucket];
+        SortRationalEntries(buckets.data() + begin, entries.data() + begin,
+                bucket_begin[bucket + 1] - begin, values + begin);
+    });
+}
+
+/*
+ * Overloads for `std::vector`.
+ */
+template<typename T, typename OverflowPolicy>
+void RationalSort(std::vector<basic_rational<T, OverflowPolicy>>& values) {
+    RationalSort(values.data(), values.size());
+}
+
+template<typename T, typename OverflowPolicy>
+void RationalSort(std::vector<basic_rational<T, OverflowPolicy>>& values,
+        thread_pool& pool) {
+    RationalSort(values.data(), values.size(), pool);
+}
+
+#endif /* RATIONAL_SORT_H */
@@ -0,0 +1,362 @@
+#ifndef RATIONAL_STATISTICS_H
+#define RATIONAL_STATISTICS_H
+
+#include "rational.h"
+#include "big_rational.h"
+#include "rational_dot.h"
+#include "rational_reduce.h"
+#include "thread_pool.h"
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+/*
+ * Exact statistics of rational streams.
+ *
+ * Sums are kept by `exact_accumulator`: unreduced in `__int128` by
+ * `rational_accumulator`, they are reduced only when the next term
+ * overflows. If the reduced sum does not fit into `__int128` (for
+ * example, denominators are large coprime numbers), it is moved to a
+ * `big_rational` partial sum. Results (mean, variance) are computed once
+ * per query in `big_rational`, so they are exact for every stream and
+ * policy, `Rational` results raise overflow error, if they do not fit.
+ * Accumulators of chunks, threads or shards are combined by `merge`, the
+ * result does not depend on the order of values.
+ */
+
+/*
+ * Function returns unreduced sum of accumulator as `big_rational`.
+ */
+template<typename Rational>
+big_rational ExactAccumulatorValue(
+        const rational_accumulator<Rational>& accumulator) {
+    return big_rational(big_integer(accumulator.fusedNumerator()),
+            big_integer(accumulator.fusedDenominator()));
+}
+
+/*
+ * Class exact_accumulator. Exact sum of a stream: terms are added to
+ * `rational_accumulator`, when its sum does not fit into `__int128`, the
+ * sum is moved to `big_rational` and the accumulator starts from zero.
+ *
+ * Public:
+ * 1. `exact_accumulator()` - class initializer, zero.
+ * 2. `add(x)`, `addSquare(x)`, `fma(x, y)` - add `x`, `x * x`, `x * y`.
+ * 3. `merge(other)` - add other sum.
+ * 4. `value()` - return the sum as `big_rational`.
+ *
+ * Private:
+ * 1. `fused` - sum of the last terms.
+ * 2. `spilled` - sum of the earlier terms.
+ * 3. `accumulate(term)` - call `term(fused)`, which returns `false`, if
+ * the sum does not fit, then spill and repeat it.
+ */
+template<typename Rational>
+class exact_accumulator {
+public:
+    void add(const Rational& x) {
+        accumulate([&](rational_accumulator<Rational>& sum) {
+            return sum.tryAdd(x);
+        });
+    }
+    void addSquare(const Rational& x) {
+        accumulate([&](rational_accumulator<Rational>& sum) {
+            return sum.tryAddSquare(x);
+        });
+    }
+    void fma(const Rational& x, const Rational& y) {
+        accumulate([&](rational_accumulator<Rational>& sum) {
+            return sum.tryFma(x, y);
+        });
+    }
+    void merge(const exact_accumulator& other);
+    big_rational value() const;
+
+private:
+    rational_accumulator<Rational> fused;
+    big_rational spilled;
+
+    template<typename Term>
+    void accumulate(Term term);
+};
+
+/*
+ * One term always fits into empty accumulator, so the second call
+ * succeeds.
+ */
+template<typename Rational>
+template<typename Term>
+void exact_accumulator<Rational>::accumulate(Term term) {
+    if (!term(fused)) {
+        spilled += ExactAccumulatorValue(fused);
+        fused = rational_accumulator<Rational>();
+        term(fused);
+    }
+}
+
+template<typename Rational>
+void exact_accumulator<Rational>::merge(const exact_accumulator& other) {
+    spilled += other.spilled;
+    if (!fused.tryMerge(other.fused)) {
+        spilled += ExactAccumulatorValue(other.fused);
+    }
+}
+
+template<typename Rational>
+big_rational exact_accumulator<Rational>::value() const {
+    big_rational result = spilled;
+    result += ExactAccumulatorValue(fused);
+    return result;
+}
+
+/*
+ * Function converts exact statistic to `Rational`. Raises overflow
+ * error, if it does not fit.
+ */
+template<typename Rational>
+Rational NarrowStatistic(const big_rational& value) {
+    Rational result;
+    if (!value.toRational(result)) {
+        RaiseOverflowError();
+    }
+    return result;
+}
+
+/*
+ * Class rational_statistics. Count, sum and sum of squares of a stream,
+ * mean and variance are computed from them.
+ *
+ * Template parameter `Rational` - type of values, up to
+ * `basic_rational<long long>`.
+ *
+ * Public:
+ * 1. `rational_statistics()` - class initializer, empty stream.
+ * 2. `add(x)` - add value.
+ * 3. `merge(other)` - add all values of other statistics.
+ * 4. `count()` - return number of values.
+ * 5. `sum()`, `sumOfSquares()` - return sums.
+ * 6. `mean()` - return `sum / count`.
+ * 7. `variance()` - return population variance
+ * `(sumOfSquares - sum^2 / count) / count`.
+ * 8. `sampleVariance()` - return the same divided by `count - 1`.
+ * 9. `exactMean()`, `exactVariance()`, `exactSampleVariance()` - return
+ * the same as `big_rational`: denominator of variance grows as
+ * `count^2`, so it often does not fit into `Rational`.
+ *
+ * Results raise overflow error, if they do not fit into `Rational`, and
+ * logical error, if there are not enough values (one for mean and
+ * variance, two for sample variance).
+ *
+ * Private:
+ * 1. `count_value` - number of values.
+ * 2. `sum_value`, `square_value` - exact sums.
+ * 3. `centered` - return `sumOfSquares - sum^2 / count` exactly.
+ */
+template<typename Rational>
+class rational_statistics {
+public:
+    typedef Rational rational_type;
+    typedef typename Rational::value_type value_type;
+
+    rational_statistics() : count_value(0) {}
+
+    void add(const Rational& x) {
+        count_value++;
+        sum_value.add(x);
+        square_value.addSquare(x);
+    }
+    void merge(const rational_statistics& other) {
+        count_value += other.count_value;
+        sum_value.merge(other.sum_value);
+        square_value.merge(other.square_value);
+    }
+
+    unsigned long long count() const {
+        return count_value;
+    }
+    Rational sum() const {
+        return NarrowStatistic<Rational>(sum_value.value());
+    }
+    Rational sumOfSquares() const {
+        return NarrowStatistic<Rational>(square_value.value());
+    }
+    Rational mean() const {
+        return NarrowStatistic<Rational>(exactMean());
+    }
+    Rational variance() const {
+        return NarrowStatistic<Rational>(exactVariance());
+    }
+    Rational sampleVariance() const {
+        return NarrowStatistic<Rational>(exactSampleVariance());
+    }
+    big_rational exactMean() const;
+    big_rational exactVariance() const;
+    big_rational exactSampleVariance() const;
+
+private:
+    unsigned long long count_value;
+    exact_accumulator<Rational> sum_value;
+    exact_accumulator<Rational> square_value;
+
+    big_rational centered() const;
+};
+
+template<typename Rational>
+big_rational rational_statistics<Rational>::exactMean() const {
+    if (count_value == 0) {
+        throw std::logic_error("Error: statistics of empty stream!");
+    }
+    big_rational result = sum_value.value();
+    result /= big_rational(big_integer(count_value), big_integer(1));
+    return result;
+}
+
+template<typename Rational>
+big_rational rational_statistics<Rational>::centered() const {
+    big_rational sum = sum_value.value();
+    big_rational correction = sum;
+    correction *= sum;
+    correction /= big_rational(big_integer(count_value), big_integer(1));
+    big_rational result = square_value.value();
+    result -= correction;
+    return result;
+}
+
+template<typename Rational>
+big_rational rational_statistics<Rational>::exactVariance() const {
+    if (count_value == 0) {
+        throw std::logic_error("Error: statistics of empty stream!");
+    }
+    big_rational result = centered();
+    result /= big_rational(big_integer(count_value), big_integer(1));
+    return result;
+}
+
+template<typename Rational>
+big_rational rational_statistics<Rational>::exactSampleVariance() const {
+    if (count_value < 2) {
+        throw std::logic_error("Error: sample variance needs two values!");
+    }
+    big_rational result = centered();
+    result /= big_rational(big_integer(count_value - 1), big_integer(1));
+    return result;
+}
+
+/*
+ * Class rational_weighted_mean. Weighted mean `sum(w * x) / sum(w)` of a
+ * stream.
+ *
+ * Public:
+ * 1. `rational_weighted_mean()` - class initializer, empty stream.
+ * 2. `add(x, weight)` - add value with weight, products are
+ * cross-cancelled by `rational_accumulator::fma`.
+ * 3. `merge(other)` - add all values of other mean.
+ * 4. `totalWeight()`, `weightedSum()` - return sums.
+ * 5. `value()` - return weighted mean. Raises logical error, if total
+ * weight is zero, and overflow error, if the mean does not fit.
+ * 6. `exactValue()` - return weighted mean as `big_rational`.
+ *
+ * Private:
+ * 1. `weight_value`, `product_value` - exact sums of weights and
+ * products.
+ */
+template<typename Rational>
+class rational_weighted_mean {
+public:
+    typedef Rational rational_type;
+
+    void add(const Rational& x, const Rational& weight) {
+        weight_value.add(weight);
+        product_value.fma(weight, x);
+    }
+    void merge(const rational_weighted_mean& other) {
+        weight_value.merge(other.weight_value);
+        product_value.merge(other.product_value);
+    }
+
+    Rational totalWeight() const {
+        return NarrowStatistic<Rational>(weight_value.value());
+    }
+    Rational weightedSum() const {
+        return NarrowStatistic<Rational>(product_value.value());
+    }
+    Rational value() const {
+        return NarrowStatistic<Rational>(exactValue());
+    }
+    big_rational exactValue() const;
+
+private:
+    exact_accumulator<Rational> weight_value;
+    exact_accumulator<Rational> product_value;
+};
+
+template<typename Rational>
+big_rational rational_weighted_mean<Rational>::exactValue() const {
+    big_rational weight = weight_value.value();
+    if (!static_cast<bool>(weight)) {
+        throw std::logic_error("Error: total weight is zero!");
+    }
+    big_rational result = product_value.value();
+    result /= weight;
+    return result;
+}
+
+/*
+ * Function returns statistics of `count` values, starting at `values`.
+ */
+template<typename T, typename OverflowPolicy>
+rational_statistics<basic_rational<T, OverflowPolicy>> RationalStatistics(
+        const basic_rational<T, OverflowPolicy>* values, std::size_t count) {
+    rational_statistics<basic_rational<T, OverflowPolicy>> statistics;
+    for (std::size_t i = 0; i < count; i++) {
+        statistics.add(values[i]);
+    }
+    return statistics;
+}
+
+/*
+ * Parallel version: chunks of `RationalReduceChunk` values are collected
+ * by threads of `pool`, then merged in index order.
+ */
+template<typename T, typename OverflowPolicy>
+rational_statistics<basic_rational<T, OverflowPolicy>> RationalStatistics(
+        const basic_rational<T, OverflowPolicy>* values, std::size_t count,
+        thread_pool& pool) {
+    typedef rational_statistics<basic_rational<T, OverflowPolicy>>
+            statistics_type;
+    if (count <= RationalReduceChunk) {
+        return RationalStatistics(values, count);
+    }
+    std::size_t chunks = (count + RationalReduceChunk - 1) / RationalReduceChunk;
+    std::vector<statistics_type> partial(chunks);
+    pool.parallelFor(chunks, [&](std::size_t chunk) {
+        std::size_t begin = chunk * RationalReduceChunk;
+        std::size_t end = count - begin < RationalReduceChunk
+                ? count : begin + RationalReduceChunk;
+        for (std::size_t i = begin; i < end; i++) {
+            partial[chunk].add(values[i]);
+        }
+    });
+    for (std::size_t chunk = 1; chunk < chunks; chunk++) {
+        partial[0].merge(partial[chunk]);
+    }
+    return partial[0];
+}
+
+/*
+ * Overloads for `std::vector`.
+ */
+template<typename T, typename OverflowPolicy>
+rational_statistics<basic_rational<T, OverflowPolicy>> RationalStatistics(
+        const std::vector<basic_rational<T, OverflowPolicy>>& values) {
+    return RationalStatistics(values.data(), values.size());
+}
+
+template<typename T, typename OverflowPolicy>
+rational_statistics<basic_rational<T, OverflowPolicy>> RationalStatistics(
+        const std::vector<basic_rational<T, OverflowPolicy>>& values,
+        thread_pool& pool) {
+    return RationalStatistics(values.data(), values.size(), pool);
+}
+
+#endif /* RATIONAL_STATISTICS_H */
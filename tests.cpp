@@ -1,15 +1,55 @@
 #include "rational.h"
+#include "big_rational.h"
+#include "lazy_rational.h"
+#include "rational_array.h"
+#include "rational_reduce.h"
+#include "rational_flat_map.h"
+#include "rational_io.h"
+#include "rational_binary.h"
+#include "rational_matrix.h"
+#include "rational_polynomial.h"
+#include "rational_float.h"
+#include "rational_expression.h"
+#include "rational_dot.h"
+#include "rational_sort.h"
+#include "fixed_rational.h"
+#include "rational_decimal.h"
+#include "rational_farey.h"
+#include "rational_statistics.h"
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
 #include <set>
 #include <vector> 
 #include <map>
+#include <unordered_set>
 #include <functional>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <unistd.h>
+#include <limits>
+#include <random>
+#include <iomanip>
+#include <iterator>
+#include <thread>
+#include <cmath>
 
 
 using namespace std;
 
+/*
+ * Values, which are computed at compile time. Instrumentation with old
+ * compilers counts events of `constexpr` functions at runtime, then they
+ * are constants only (see `RATIONAL_CONSTANT_EVALUATION`).
+ */
+#if RATIONAL_CONSTANT_EVALUATION
+#define TEST_CONSTEXPR constexpr
+#else
+#define TEST_CONSTEXPR const
+#endif
+
 /*
  * Variables.
  */
@@ -99,9 +139,24 @@ void PrintError(const string& file, const int& line,
     cerr << string(50, '*') << "\n";
 }
 
+/*
+ * Print error, which was raised by the tested code and not caught by the
+ * test, and count it as failure.
+ */
+void ReportUnexpectedError(const string& what) {
+    TestErrors.UpdateError();
+    ostringstream os;
+    os << "unexpected error: " << what;
+    PrintError(__FILE__, __LINE__, "RunTests", os);
+}
+
 /*
  * Run all group tests. Catch `runtime_error`, if error exists.
  * Print test result and update global errors. 
+ *
+ * Failed assertions count the error and raise `runtime_error` to stop
+ * the test. Other errors (for example, `overflow_error` of the tested
+ * code) are not counted yet, so they are counted here as failures.
  */
 void RunTests(const vector<function<void()>> functions) {
     function<void()> f;
@@ -114,10 +169,18 @@ void RunTests(const vector<function<void()>> functions) {
             TestErrors.UpdateGlobalError();
             PrintResultTest();
         } catch (runtime_error& e) {
+            if (TestErrors.GetError() == 0) {
+                ReportUnexpectedError(e.what());
+            }
             TestErrors.UpdateGlobalError();
             PrintResultTest();
             continue;
-        } 
+        } catch (exception& e) {
+            ReportUnexpectedError(e.what());
+            TestErrors.UpdateGlobalError();
+            PrintResultTest();
+            continue;
+        }
     } 
 }
 
@@ -375,6 +438,41 @@ void TestComparsion() {
         rational r1(0, 1);
         AssertFalse(!r1);
     }
+    
+    {
+        // least common denominator of these values does not fit into `int`.
+        const int max = numeric_limits<int>::max();
+        rational r1(max - 1, max);
+        rational r2(max - 2, max - 1);
+        AssertTrue(r1 > r2 && r2 < r1 && r1 >= r2 && r2 <= r1 && r1 != r2);
+        AssertTrue(rational(-max, 3) < rational(max, 7));
+#if RATIONAL_CONSTANT_EVALUATION
+        static_assert(rational(1, 3) < rational(1, 2), "constexpr comparison");
+#endif
+    }
+    
+    {
+        // `__int128` has no wider type, it is compared by continued fractions.
+        typedef basic_rational<__int128> rational128;
+        const __int128 max = integer_traits<__int128>::max();
+        AssertTrue(rational128(max - 1, max) > rational128(max - 2, max - 1));
+        AssertTrue(rational128(-max, max - 1) > rational128(-max + 1, max - 2));
+        AssertTrue(rational128(max, 3) >= rational128(max, 3));
+        mt19937_64 generator(3);
+        for (int i = 0; i < 1000; i++) {
+            __int128 values[4];
+            for (__int128& value : values) {
+                value = static_cast<__int128>(generator()) << (generator() % 64);
+                value = generator() % 2 ? -value : value;
+            }
+            rational128 r1(values[0], values[1] == 0 ? 1 : values[1]);
+            rational128 r2(values[2], values[3] == 0 ? 1 : values[3]);
+            bool less = big_rational(r1) < big_rational(r2);
+            bool equal = big_rational(r1) == big_rational(r2);
+            AssertTrue((r1 < r2) == less && (r1 == r2) == equal);
+            AssertTrue((r1 > r2) == (!less && !equal));
+        }
+    }
 }
 
 /* 
@@ -541,13 +639,2142 @@ void TestCatchError() {
         }
     }
 }
+/* 
+ * Test function, check `basic_rational` with other integer widths and 
+ * evaluation at compile time.
+ */
+void TestWidths() {
+    {
+        TEST_CONSTEXPR rational r = rational(8, 12) + rational(1, 3);
+#if RATIONAL_CONSTANT_EVALUATION
+        static_assert(r.numerator() == 1 && r.denominator() == 1, 
+                "rational must be evaluated at compile time");
+#endif
+        AssertEqual(r, rational(1, 1));
+    }
+    
+    {
+        TEST_CONSTEXPR rational r(-4, -6);
+        AssertOutputEqual(r, "2/3");
+    }
+    
+    {
+        const basic_rational<long long> a(3000000000LL, 7);
+        const basic_rational<long long> b(1, 3);
+        AssertTrue(a + b == basic_rational<long long>(9000000007LL, 21));
+        AssertTrue(a > b);
+    }
+    
+    {
+        const __int128 big = static_cast<__int128>(1) << 100;
+        basic_rational<__int128> a(big, 3);
+        ostringstream output;
+        output << a;
+        AssertTrue(output.str() == "1267650600228229401496703205376/3");
+        
+        istringstream input(output.str());
+        basic_rational<__int128> b;
+        input >> b;
+        AssertTrue(a == b);
+    }
+}
+
+/* 
+ * Test function, check `GreatestCommonDivisor` and `LeastCommonDenominator`.
+ */
+void TestGreatestCommonDivisor() {
+    {
+#if RATIONAL_CONSTANT_EVALUATION
+        static_assert(GreatestCommonDivisor(12, 18) == 6, 
+                "gcd must be evaluated at compile time");
+#endif
+        AssertTrue(GreatestCommonDivisor(0, 5) == 5);
+        AssertTrue(GreatestCommonDivisor(5, 0) == 5);
+        AssertTrue(GreatestCommonDivisor(-12, 18) == 6);
+        AssertTrue(GreatestCommonDivisor(7919, 7907) == 1);
+        AssertTrue(GreatestCommonDivisor(1 << 30, 3 << 20) == 1 << 20);
+    }
+    
+    {
+        const __int128 a = static_cast<__int128>(1) << 100;
+        const __int128 b = static_cast<__int128>(3) << 64;
+        AssertTrue(GreatestCommonDivisor(a, b) == static_cast<__int128>(1) << 64);
+        AssertTrue(GreatestCommonDivisor(1LL << 40, 6LL) == 2);
+    }
+    
+    {
+        AssertTrue(LeastCommonDenominator(4, 6) == 12);
+        AssertTrue(LeastCommonDenominator(7919, 7907) == 62615533);
+        AssertEqual(rational(1, 7919) + rational(1, 7907), 
+                rational(15826, 62615533));
+    }
+    
+    {
+        // Small-operand table agrees with binary GCD.
+#if RATIONAL_CONSTANT_EVALUATION
+        static_assert(GreatestCommonDivisor(100, 1000000) == 100,
+                "gcd must be evaluated at compile time");
+#endif
+#if RATIONAL_GCD_TABLE_BITS > 0
+        bool same = true;
+        for (unsigned a = 0; a < GreatestCommonDivisorTableSize; a++) {
+            for (unsigned b = 0; b < 4096; b++) {
+                same = same && TableGreatestCommonDivisor(a, b) ==
+                        BinaryGreatestCommonDivisor(a, b) &&
+                        TableGreatestCommonDivisor(b, a) ==
+                        BinaryGreatestCommonDivisor(b, a);
+            }
+        }
+        AssertTrue(same);
+#endif
+        AssertTrue(GreatestCommonDivisor(-100, 1000000) == 100);
+        AssertTrue(GreatestCommonDivisor(-2147483647 - 1, 64) == 64);
+        const long long min = integer_traits<long long>::min();
+        AssertTrue(GreatestCommonDivisor(min, 0LL) == min);
+        AssertEqual(rational(123456, 192), rational(643, 1));
+    }
+}
+
+/* 
+ * Test function, check overflow policies of `basic_rational`.
+ * `(2^31 - 1)/2 + 1/2` overflows `int`, but reduced result `2^30` fits.
+ */
+void TestOverflow() {
+    const int max = numeric_limits<int>::max();
+    
+    {
+        try {
+            rational a = rational(max, 1) + rational(1, 1);
+            ostringstream os;
+            os << "do not catch overflow_error! Result: " << a;
+            PrintError(__FILE__, __LINE__, "TestOverflow", os);
+            TestErrors.UpdateError();
+        } 
+        catch (overflow_error const& err) {
+            AssertEqual(rational(max, 1) * rational(1, max), rational(1, 1));
+        }
+    }
+    
+    {
+        // Sums overflow before they are divided by the GCD, results fit.
+        AssertEqual(rational(429496729, 6) + rational(3, 10),
+                rational(1073741827, 15));
+        AssertEqual(rational(max, 2) + rational(max, 2), rational(max));
+        AssertEqual(rational(max, 2) + rational(1, 2), rational(1 << 30));
+        AssertEqual(rational(-max, 2) - rational(max, 2), rational(-max));
+        typedef basic_rational<long long> long_rational;
+        const long long long_max = integer_traits<long long>::max();
+        AssertTrue(long_rational(long_max, 6) + long_rational(long_max, 3) ==
+                long_rational(long_max, 2));
+    }
+
+    {
+        typedef basic_rational<int, overflow_promote> promoted;
+        promoted a = promoted(max, 2) + promoted(1, 2);
+        AssertTrue(a.numerator() == 1 << 30 && a.denominator() == 1);
+        
+        promoted b = promoted(max - 1, max) * promoted(max, 2);
+        AssertTrue(b == promoted((max - 1) / 2, 1));
+    }
+    
+    {
+        typedef basic_rational<int, overflow_saturate> saturated;
+        saturated a = saturated(max, 3) + saturated(max, 3);
+        AssertTrue(a.numerator() == max && a.denominator() == 3);
+        
+        saturated b = saturated(max, 1) * saturated(-2, 1);
+        AssertTrue(b.numerator() == numeric_limits<int>::min());
+    }
+    
+    {
+        try {
+            basic_rational<__int128, overflow_promote> a(
+                    integer_traits<__int128>::max(), 1);
+            a += a;
+            ostringstream os;
+            os << "do not catch overflow_error!";
+            PrintError(__FILE__, __LINE__, "TestOverflow", os);
+            TestErrors.UpdateError();
+        } 
+        catch (overflow_error const& err) {
+        }
+    }
+}
+
+/* 
+ * Test function, check `big_rational` and `big_integer`.
+ */
+void TestBigRational() {
+    {
+        big_integer a, b;
+        AssertTrue(big_integer::fromString("-123456789012345678901234567890", a));
+        AssertTrue(big_integer::fromString("987654321098765432109876543210", b));
+        AssertTrue((a * b).toString() == 
+                "-121932631137021795226185032733622923332237463801111263526900");
+        AssertTrue((a * b) / b == a);
+        AssertTrue((b % a).toString() == "9000000000900000000090");
+        AssertTrue(GreatestCommonDivisor(a * 6, b * 4).toString() == 
+                "18000000001800000000180");
+    }
+    
+    {
+        // harmonic number H(60) does not fit into 64 bits.
+        big_rational sum;
+        for (int k = 1; k <= 60; k++) {
+            sum += rational(1, k);
+        }
+        AssertFalse(sum.isSmall());
+        AssertTrue(sum > big_rational(4, 1) && sum < big_rational(5, 1));
+        for (int k = 60; k >= 2; k--) {
+            sum -= big_rational(1, k);
+        }
+        AssertTrue(sum.isSmall());
+        AssertTrue(sum == rational(1, 1));
+    }
+    
+    {
+        big_rational a = big_rational(1LL << 62, 3) * big_rational(1LL << 62, 5);
+        ostringstream output;
+        output << a;
+        AssertTrue(output.str() == "21267647932558653966460912964485513216/15");
+        
+        istringstream input(output.str());
+        big_rational b;
+        input >> b;
+        AssertTrue(a == b);
+        
+        b /= big_rational(1LL << 62, 1);
+        AssertTrue(b.isSmall() && b == big_rational(1LL << 62, 15));
+        rational r;
+        AssertFalse(b.toRational(r));
+        AssertTrue((b / (1LL << 61)).toRational(r));
+        AssertEqual(r, rational(2, 15));
+    }
+    
+    {
+        big_rational a = rational(1, 3) + big_rational(1, 6);
+        AssertTrue(a == rational(1, 2));
+        AssertTrue(rational(2, 3) > a);
+    }
+    
+    {
+        // zero denominator is handled like in `rational`.
+        AssertTrue(big_rational(0, 0) == rational(0, 0));
+        big_rational a(1, 2);
+        a.setRational(big_integer(0), big_integer(0));
+        AssertTrue(a == big_rational() && a.denominator() == big_integer(1));
+        try {
+            a.setRational(big_integer(1), big_integer(0));
+            ostringstream os;
+            os << "do not catch logic_error! Result: " << a;
+            PrintError(__FILE__, __LINE__, "TestBigRational", os);
+            TestErrors.UpdateError();
+        } 
+        catch (logic_error const& err) {
+        }
+        try {
+            big_rational b(-1, 0);
+            ostringstream os;
+            os << "do not catch logic_error! Result: " << b;
+            PrintError(__FILE__, __LINE__, "TestBigRational", os);
+            TestErrors.UpdateError();
+        } 
+        catch (logic_error const& err) {
+        }
+    }
+}
+
+/* 
+ * Test function, check `lazy_rational` gives the same values and the same
+ * overflow errors as eager `rational`.
+ */
+void TestLazyRational() {
+    {
+        lazy_rational sum;
+        for (int k = 1; k <= 100; k++) {
+            sum += rational(k, 100);
+        }
+        AssertFalse(sum.isNormalized());
+        AssertEqual(sum.value(), rational(101, 2));
+        AssertTrue(sum.isNormalized());
+        AssertTrue(sum.numerator() == 101 && sum.denominator() == 2);
+    }
+    
+    {
+        mt19937 generator(7);
+        uniform_int_distribution<int> values(-50, 50);
+        rational eager;
+        lazy_rational lazy;
+        for (int step = 0; step < 20000; step++) {
+            int num = values(generator);
+            int deno = values(generator);
+            if (deno == 0 || num == 0) {
+                continue;
+            }
+            rational operand(num, deno);
+            int operation = generator() % 8;
+            bool eagerError = false, lazyError = false;
+            try {
+                if (operation < 5) {
+                    eager += operand;
+                } else if (operation == 5) {
+                    eager -= operand;
+                } else if (operation == 6) {
+                    eager *= operand;
+                } else {
+                    eager /= operand;
+                }
+            } catch (overflow_error const& err) {
+                eagerError = true;
+            }
+            try {
+                if (operation < 5) {
+                    lazy += operand;
+                } else if (operation == 5) {
+                    lazy -= operand;
+                } else if (operation == 6) {
+                    lazy *= operand;
+                } else {
+                    lazy /= operand;
+                }
+            } catch (overflow_error const& err) {
+                lazyError = true;
+            }
+            AssertTrue(eagerError == lazyError);
+            if (step % 16 == 0) {
+                AssertTrue(lazy == eager);
+            }
+        }
+        AssertEqual(lazy.value(), eager);
+    }
+}
+
 /* 
  * Function run all defauls tests for class rational.
  */
+void TestRationalArray() {
+    {
+        rational_array values({rational(1, 2), rational(2, 3)});
+        values.push_back(rational(-3, 4));
+        AssertTrue(values.size() == 3);
+        AssertEqual(values.get(2), rational(-3, 4));
+        AssertTrue(reinterpret_cast<size_t>(values.numerators()) % 64 == 0);
+        AssertTrue(reinterpret_cast<size_t>(values.denominators()) % 64 == 0);
+        AddRationalArray(values, values, values);
+        AssertEqual(values.get(0), rational(1, 1));
+        AssertEqual(values.get(2), rational(-3, 2));
+    }
+    
+    {
+        rational_kernel active = GetRationalKernel();
+        mt19937 generator(11);
+        const int limits[] = {10, 1000, 1 << 16, integer_traits<int>::max()};
+        for (rational_kernel kernel : {rational_kernel::scalar, 
+                rational_kernel::avx2, rational_kernel::avx512}) {
+            if (!IsRationalKernelSupported(kernel)) {
+                continue;
+            }
+            SetRationalKernel(kernel);
+            for (int limit : limits) {
+                uniform_int_distribution<int> values(-limit, limit);
+                vector<rational> left, right;
+                // size is not a multiple of vector width.
+                for (int i = 0; i < 203; i++) {
+                    int deno1 = values(generator);
+                    int deno2 = values(generator);
+                    left.push_back(rational(values(generator), 
+                            deno1 == 0 ? 1 : deno1));
+                    right.push_back(rational(i % 9 == 0 ? 0 : values(generator),
+                            deno2 == 0 ? 1 : deno2));
+                }
+                rational_array a(left), b(right), result;
+                for (int operation = 0; operation < 4; operation++) {
+                    bool arrayError = false, scalarError = false;
+                    try {
+                        if (operation == 0) {
+                            AddRationalArray(a, b, result);
+                        } else if (operation == 1) {
+                            SubtractRationalArray(a, b, result);
+                        } else if (operation == 2) {
+                            MultiplyRationalArray(a, b, result);
+                        } else {
+                            DivideRationalArray(a, b, result);
+                        }
+                    } catch (exception const& err) {
+                        arrayError = true;
+                    }
+                    for (size_t i = 0; i < left.size() && !arrayError; i++) {
+                        rational expected;
+                        try {
+                            if (operation == 0) {
+                                expected = left[i] + right[i];
+                            } else if (operation == 1) {
+                                expected = left[i] - right[i];
+                            } else if (operation == 2) {
+                                expected = left[i] * right[i];
+                            } else {
+                                expected = left[i] / right[i];
+                            }
+                        } catch (exception const& err) {
+                            scalarError = true;
+                            break;
+                        }
+                        AssertEqual(result.get(i), expected);
+                    }
+                    if (!arrayError) {
+                        AssertFalse(scalarError);
+                    }
+                }
+                vector<signed char> order;
+                CompareRationalArray(a, b, order);
+                for (size_t i = 0; i < left.size(); i++) {
+                    long long lhs = 1LL * left[i].numerator() * 
+                            right[i].denominator();
+                    long long rhs = 1LL * right[i].numerator() * 
+                            left[i].denominator();
+                    AssertTrue(order[i] == (lhs > rhs) - (lhs < rhs));
+                }
+            }
+            
+            rational_array big(16), zero(16), result;
+            for (size_t i = 0; i < big.size(); i++) {
+                big.set(i, rational(integer_traits<int>::max() - i, 1));
+            }
+            try {
+                AddRationalArray(big, big, result);
+                ostringstream os;
+                os << "do not catch overflow_error!";
+                PrintError(__FILE__, __LINE__, "TestRationalArray", os);
+                TestErrors.UpdateError();
+            } 
+            catch (overflow_error const& err) {
+            }
+            try {
+                DivideRationalArray(big, zero, result);
+                ostringstream os;
+                os << "do not catch logic_error!";
+                PrintError(__FILE__, __LINE__, "TestRationalArray", os);
+                TestErrors.UpdateError();
+            } 
+            catch (logic_error const& err) {
+            }
+            MultiplyRationalArray(big, zero, result);
+            AssertEqual(result.get(15), rational(0, 1));
+        }
+        SetRationalKernel(active);
+    }
+    
+    {
+        // All kernels agree with `rational` near `INT_MAX`: Knuth's
+        // intermediate sum overflows, while the result fits (or not).
+        const int max = integer_traits<int>::max();
+        const rational pairs[][2] = {
+            {rational(max, 2), rational(max, 2)},
+            {rational(429496729, 6), rational(3, 10)},
+            {rational(-max, 2), rational(max, 2)},
+            {rational(max, max - 1), rational(max - 2, max - 1)},
+            {rational(max - 1, max), rational(max - 2, max - 1)},
+            {rational(max, 3), rational(max, 6)},
+            {rational(max), rational(1)},
+            {rational(2), rational(-max - 1)},
+        };
+        rational_kernel active = GetRationalKernel();
+        for (const auto& pair : pairs) {
+            for (int operation = 0; operation < 4; operation++) {
+                bool scalarError = false;
+                rational expected;
+                try {
+                    if (operation == 0) {
+                        expected = pair[0] + pair[1];
+                    } else if (operation == 1) {
+                        expected = pair[0] - pair[1];
+                    } else if (operation == 2) {
+                        expected = pair[0] * pair[1];
+                    } else {
+                        expected = pair[0] / pair[1];
+                    }
+                } catch (overflow_error const& err) {
+                    scalarError = true;
+                }
+                for (rational_kernel kernel : {rational_kernel::scalar,
+                        rational_kernel::avx2, rational_kernel::avx512}) {
+                    if (!IsRationalKernelSupported(kernel)) {
+                        continue;
+                    }
+                    SetRationalKernel(kernel);
+                    // 16 values, so vector blocks are used.
+                    rational_array a(vector<rational>(16, pair[0]));
+                    rational_array b(vector<rational>(16, pair[1]));
+                    rational_array result;
+                    bool arrayError = false;
+                    try {
+                        if (operation == 0) {
+                            AddRationalArray(a, b, result);
+                        } else if (operation == 1) {
+                            SubtractRationalArray(a, b, result);
+                        } else if (operation == 2) {
+                            MultiplyRationalArray(a, b, result);
+                        } else {
+                            DivideRationalArray(a, b, result);
+                        }
+                    } catch (overflow_error const& err) {
+                        arrayError = true;
+                    }
+                    AssertTrue(arrayError == scalarError);
+                    if (!arrayError) {
+                        AssertEqual(result.get(0), expected);
+                        AssertEqual(result.get(15), expected);
+                    }
+                }
+            }
+        }
+        SetRationalKernel(active);
+    }
+}
+
+void TestRationalReduce() {
+    typedef basic_rational<long long> rational64;
+    
+    {
+        AssertEqual(RationalSum(vector<rational>()), rational(0, 1));
+        AssertEqual(RationalProduct(vector<rational>()), rational(1, 1));
+        vector<rational> values = {rational(1, 2), rational(1, 3)};
+        AssertEqual(RationalSum(values), rational(5, 6));
+        AssertEqual(RationalProduct(values), rational(1, 6));
+    }
+    
+    {
+        // 1/(1*2) + 1/(2*3) + ... = n/(n+1), (2/1) * (3/2) * ... = n+1.
+        const long long n = 100000;
+        vector<rational64> terms, factors;
+        for (long long k = 1; k <= n; k++) {
+            terms.push_back(rational64(1, k * (k + 1)));
+            factors.push_back(rational64(k + 1, k));
+        }
+        rational64 serial;
+        for (const rational64& term : terms) {
+            serial += term;
+        }
+        thread_pool single(1), several(4);
+        rational64 sum = RationalSum(terms, several);
+        AssertTrue(sum == serial && sum == rational64(n, n + 1));
+        AssertTrue(RationalSum(terms, single) == sum);
+        AssertTrue(RationalSum(terms) == sum);
+        AssertTrue(RationalProduct(factors, several) == rational64(n + 1, 1));
+    }
+    
+    {
+        vector<rational> values(20000, rational(1, 1));
+        values[15000] = rational(numeric_limits<int>::max(), 1);
+        try {
+            thread_pool pool(3);
+            rational sum = RationalSum(values, pool);
+            ostringstream os;
+            os << "do not catch overflow_error! Result: " << sum;
+            PrintError(__FILE__, __LINE__, "TestRationalReduce", os);
+            TestErrors.UpdateError();
+        } 
+        catch (overflow_error const& err) {
+        }
+    }
+}
+
+void TestRationalHash() {
+    {
+        hash<rational> hasher;
+        AssertTrue(hasher(rational(2, 4)) == hasher(rational(-3, -6)));
+        AssertTrue(hasher(rational(1, 2)) != hasher(rational(2, 1)));
+        unordered_set<rational> values = {rational(1, 2), rational(2, 4), 
+                rational(1, 3)};
+        AssertTrue(values.size() == 2 && values.count(rational(3, 6)) == 1);
+    }
+    
+    {
+        rational_flat_map<int> flat;
+        map<rational, int> tree;
+        mt19937 generator(5);
+        uniform_int_distribution<int> values(-40, 40);
+        for (int step = 0; step < 50000; step++) {
+            int deno = values(generator);
+            rational key(values(generator), deno == 0 ? 1 : deno);
+            int operation = generator() % 4;
+            if (operation == 0) {
+                AssertTrue(flat.erase(key) == (tree.erase(key) == 1));
+            } else if (operation == 1) {
+                AssertTrue(flat.insert(key, step) == 
+                        tree.insert(make_pair(key, step)).second);
+            } else if (operation == 2) {
+                flat[key] += 1;
+                tree[key] += 1;
+            } else {
+                const int* value = flat.find(key);
+                auto it = tree.find(key);
+                AssertTrue((value == nullptr) == (it == tree.end()));
+                AssertTrue(value == nullptr || *value == it->second);
+            }
+            AssertTrue(flat.size() == tree.size());
+        }
+        size_t visited = 0;
+        flat.forEach([&](const rational& key, int value) {
+            AssertTrue(tree.at(key) == value);
+            visited++;
+        });
+        AssertTrue(visited == tree.size());
+        flat.clear();
+        AssertTrue(flat.empty() && !flat.contains(rational(0, 1)));
+    }
+    
+    {
+        typedef basic_rational<__int128> rational128;
+        basic_rational_flat_set<rational128> keys;
+        const __int128 max = integer_traits<__int128>::max();
+        AssertTrue(keys.insert(rational128(max, 3)));
+        AssertFalse(keys.insert(rational128(max, 3)));
+        AssertTrue(keys.insert(rational128(1, 3)));
+        AssertTrue(keys.contains(rational128(2, 6)));
+        AssertTrue(keys.erase(rational128(max, 3)) && keys.size() == 1);
+    }
+}
+
+void TestParseRational() {
+    {
+        rational r;
+        const char text[] = "-6/8 tail";
+        parse_result result = ParseRational(text, text + strlen(text), r);
+        AssertTrue(result.ec == errc() && result.ptr == text + 4);
+        AssertEqual(r, rational(-3, 4));
+        const char zero[] = "0/0";
+        result = ParseRational(zero, zero + 3, r);
+        AssertTrue(result.ec == errc());
+        AssertEqual(r, rational(0, 1));
+    }
+    
+    {
+        const char* wrong[] = {"1/0", "x/2", "1/", "1-2", "+1/2", " 1/2", 
+                "2147483648/1", "-2147483648/-1"};
+        const errc codes[] = {errc::argument_out_of_domain, 
+                errc::invalid_argument, errc::invalid_argument, 
+                errc::invalid_argument, errc::invalid_argument, 
+                errc::invalid_argument, errc::result_out_of_range, 
+                errc::result_out_of_range};
+        const size_t positions[] = {2, 0, 2, 1, 0, 0, 10, 14};
+        for (size_t i = 0; i < 8; i++) {
+            rational r(5, 7);
+            parse_result result = ParseRational(wrong[i], 
+                    wrong[i] + strlen(wrong[i]), r);
+            AssertTrue(result.ec == codes[i]);
+            AssertTrue(result.ptr == wrong[i] + positions[i]);
+            AssertEqual(r, rational(5, 7));
+        }
+        basic_rational<__int128> big;
+        const char text[] = "-170141183460469231731687303715884105728/3";
+        AssertTrue(ParseRational(text, text + strlen(text), big).ec == errc());
+        AssertTrue(big.numerator() == integer_traits<__int128>::min());
+    }
+    
+    {
+        const string text = "1/2 3/4\n\n-5/10\n7/0\n";
+        vector<rational> values;
+        try {
+            ParseRationalText(text.data(), text.data() + text.size(), values);
+            ostringstream os;
+            os << "do not catch rational_parse_error!";
+            PrintError(__FILE__, __LINE__, "TestParseRational", os);
+            TestErrors.UpdateError();
+        } 
+        catch (rational_parse_error const& err) {
+            AssertTrue(err.code() == errc::argument_out_of_domain);
+            AssertTrue(err.line() == 4 && err.column() == 3);
+            AssertTrue(err.offset() == 17);
+        }
+    }
+    
+    {
+        // text of several megabytes is split between threads.
+        mt19937 generator(9);
+        uniform_int_distribution<int> numbers(-1000000, 1000000);
+        string text;
+        vector<rational> expected;
+        while (text.size() < (5 << 20)) {
+            int deno = numbers(generator);
+            int num = numbers(generator);
+            text += to_string(num) + "/" + to_string(deno == 0 ? 1 : deno) + "\n";
+            expected.push_back(rational(num, deno == 0 ? 1 : deno));
+        }
+        char path[] = "/tmp/rational_parse_XXXXXX";
+        int descriptor = mkstemp(path);
+        AssertTrue(descriptor >= 0);
+        {
+            ofstream file(path, ios::binary);
+            file << text;
+        }
+        thread_pool pool(4);
+        vector<rational> serial, parallel;
+        ParseRationalFile(path, serial);
+        ParseRationalFile(path, parallel, &pool);
+        AssertTrue(serial == expected && parallel == expected);
+        rational_array array;
+        ParseRationalFile(path, array, &pool);
+        AssertTrue(array.size() == expected.size());
+        AssertEqual(array.get(array.size() - 1), expected.back());
+        
+        text[text.size() / 2 + 1] = '?';
+        {
+            ofstream file(path, ios::binary);
+            file << text;
+        }
+        size_t line = 1 + count(text.begin(), text.begin() + text.size() / 2 + 1, 
+                '\n');
+        try {
+            ParseRationalFile(path, parallel, &pool);
+            ostringstream os;
+            os << "do not catch rational_parse_error!";
+            PrintError(__FILE__, __LINE__, "TestParseRational", os);
+            TestErrors.UpdateError();
+        } 
+        catch (rational_parse_error const& err) {
+            AssertTrue(err.line() == line && err.offset() == text.size() / 2 + 1);
+        }
+        close(descriptor);
+        remove(path);
+    }
+}
+
+void TestFormatRational() {
+    {
+        // characters are the same as of `to_string`.
+        mt19937_64 generator(11);
+        char buffer[64];
+        for (int i = 0; i < 10000; i++) {
+            long long num = static_cast<long long>(generator()) >> (i % 63);
+            long long deno = static_cast<long long>(generator() >> (i % 63 + 1));
+            basic_rational<long long> r(num, deno == 0 ? 1 : deno);
+            format_result result = FormatRational(buffer, buffer + 64, r);
+            AssertTrue(result.ec == errc());
+            AssertTrue(string(buffer, result.ptr) == to_string(r.numerator()) + 
+                    "/" + to_string(r.denominator()));
+        }
+        basic_rational<long long> low(integer_traits<long long>::min(), 1);
+        format_result result = FormatRational(buffer, buffer + 64, low);
+        AssertTrue(string(buffer, result.ptr) == "-9223372036854775808/1");
+        basic_rational<__int128> big(integer_traits<__int128>::min(), 3);
+        result = FormatRational(buffer, buffer + 64, big);
+        AssertTrue(string(buffer, result.ptr) == 
+                "-170141183460469231731687303715884105728/3");
+        big.setRational(integer_traits<__int128>::max(), 
+                static_cast<__int128>(10000000000000000000ULL));
+        result = FormatRational(buffer, buffer + 64, big);
+        AssertTrue(string(buffer, result.ptr) == 
+                "170141183460469231731687303715884105727/10000000000000000000");
+    }
+    
+    {
+        char buffer[9];
+        rational r(-123, 4567);
+        format_result result = FormatRational(buffer, buffer + 9, r);
+        AssertTrue(result.ec == errc() && string(buffer, result.ptr) == "-123/4567");
+        result = FormatRational(buffer, buffer + 9, rational(-1234, 4567));
+        AssertTrue(result.ec == errc::value_too_large && result.ptr == buffer + 9);
+        result = FormatRational(buffer, buffer + 3, rational(0));
+        AssertTrue(result.ec == errc() && string(buffer, result.ptr) == "0/1");
+    }
+    
+    {
+        // flags of the stream are still respected.
+        ostringstream os;
+        os << rational(-3, 4) << " " << hex << rational(31, 16) << " " << dec 
+                << showpos << rational(1, 2) << " " << noshowpos << setw(4) 
+                << rational(5, 6);
+        AssertTrue(os.str() == "-3/4 1f/10 +1/+2    5/6");
+    }
+    
+    {
+        mt19937 generator(12);
+        uniform_int_distribution<int> numbers(-1000000000, 1000000000);
+        vector<rational> values;
+        string expected;
+        for (int i = 0; i < 100000; i++) {
+            int deno = numbers(generator);
+            values.push_back(rational(numbers(generator), deno == 0 ? 1 : deno));
+            expected += to_string(values.back().numerator()) + "/" + 
+                    to_string(values.back().denominator()) + "\n";
+        }
+        ostringstream os;
+        {
+            rational_writer writer(os, 1000);
+            writer.write(values);
+        }
+        AssertTrue(os.str() == expected);
+        
+        char path[] = "/tmp/rational_write_XXXXXX";
+        int descriptor = mkstemp(path);
+        AssertTrue(descriptor >= 0);
+        rational_array array(values);
+        {
+            rational_writer writer(path);
+            writer.write(array);
+            writer.write(rational(7, 9));
+            writer.flush();
+        }
+        vector<rational> parsed;
+        ParseRationalFile(path, parsed);
+        AssertTrue(parsed.size() == values.size() + 1);
+        AssertTrue(equal(values.begin(), values.end(), parsed.begin()));
+        AssertEqual(parsed.back(), rational(7, 9));
+        close(descriptor);
+        remove(path);
+    }
+    
+    try {
+        rational_writer writer("/nonexistent/rational_write");
+        ostringstream os;
+        os << "do not catch runtime_error!";
+        PrintError(__FILE__, __LINE__, "TestFormatRational", os);
+        TestErrors.UpdateError();
+    } 
+    catch (runtime_error const& err) {
+    }
+}
+
+void TestRationalBinary() {
+    mt19937 generator(13);
+    uniform_int_distribution<int> numbers(-1000000, 1000000);
+    vector<rational> values;
+    for (int i = 0; i < 10000; i++) {
+        int deno = numbers(generator);
+        values.push_back(rational(numbers(generator), deno == 0 ? 1 : deno));
+    }
+    values.push_back(rational(integer_traits<int>::min(), 1));
+    values.push_back(rational(integer_traits<int>::max() - 1, 
+            integer_traits<int>::max()));
+    // runs of shared denominators.
+    for (int i = 0; i < 1000; i++) {
+        values.push_back(rational(2 * i + 1, 1 << (i / 100)));
+    }
+    char path[] = "/tmp/rational_binary_XXXXXX";
+    int descriptor = mkstemp(path);
+    AssertTrue(descriptor >= 0);
+    
+    {
+        WriteRationalBinary(path, values, false, 100);
+        size_t plain_size = mapped_file(path).size();
+        vector<rational> loaded;
+        ReadRationalBinary(path, loaded);
+        AssertTrue(loaded == values);
+        WriteRationalBinary(path, values, true, 100);
+        AssertTrue(mapped_file(path).size() < plain_size);
+        ReadRationalBinary(path, loaded);
+        AssertTrue(loaded == values);
+    }
+    
+    {
+        rational_array array(values);
+        WriteRationalBinary(path, array);
+        rational_array loaded;
+        ReadRationalBinary(path, loaded);
+        AssertTrue(loaded.toVector() == values);
+    }
+    
+    {
+        WriteRationalBinary(path, values, true, 64);
+        rational_binary_file file(path);
+        AssertTrue(file.size() == values.size() && file.blockSize() == 64);
+        AssertTrue(file.blocks() == (values.size() + 63) / 64);
+        for (size_t i = 0; i < values.size(); i += 97) {
+            AssertEqual(file.get(i), values[i]);
+        }
+        AssertEqual(file.get(values.size() - 1), values.back());
+        vector<rational> block;
+        file.readBlock(file.blocks() - 1, block);
+        AssertTrue(block.size() == (values.size() - 1) % 64 + 1);
+        AssertTrue(equal(block.begin(), block.end(), 
+                values.begin() + (file.blocks() - 1) * 64));
+        try {
+            file.get(values.size());
+            ostringstream os;
+            os << "do not catch out_of_range!";
+            PrintError(__FILE__, __LINE__, "TestRationalBinary", os);
+            TestErrors.UpdateError();
+        } 
+        catch (out_of_range const& err) {
+        }
+    }
+    
+    {
+        vector<rational> loaded(3);
+        WriteRationalBinary(path, vector<rational>());
+        ReadRationalBinary(path, loaded);
+        AssertTrue(loaded.empty());
+    }
+    
+    {
+        // damaged files: cut block, zero denominator, block offset near
+        // 2^64 in the index, header with `2^32 - 1` values in one block
+        // (the block header has 2 or `2^32 - 1` values).
+        WriteRationalBinary(path, vector<rational>{rational(1, 2), rational(3, 4)},
+                false);
+        string data;
+        {
+            ifstream file(path, ios::binary);
+            data.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+        }
+        string damaged[] = {data.substr(0, data.size() - 1), data, data, data,
+                data, data};
+        damaged[1][32 + 16 + 2] = 0;
+        damaged[2][0] = 'X';
+        damaged[3].replace(data.size() - 8, 8, "\xf8\xff\xff\xff\xff\xff\xff\xff");
+        damaged[4].replace(8, 4, "\xff\xff\xff\xff");
+        damaged[4].replace(16, 4, "\xff\xff\xff\xff");
+        damaged[5] = damaged[4];
+        damaged[5].replace(32, 4, "\xff\xff\xff\xff");
+        for (const string& text : damaged) {
+            {
+                ofstream file(path, ios::binary);
+                file << text;
+            }
+            try {
+                vector<rational> loaded;
+                ReadRationalBinary(path, loaded);
+                ostringstream os;
+                os << "do not catch runtime_error!";
+                PrintError(__FILE__, __LINE__, "TestRationalBinary", os);
+                TestErrors.UpdateError();
+            } 
+            catch (runtime_error const& err) {
+            }
+        }
+    }
+    close(descriptor);
+    remove(path);
+}
+
+void TestInstrumentation() {
+    ResetInstrumentation();
+    rational a(6, 8);
+    rational b = a + rational(1, 3);
+    bool less = a < b;
+    AssertTrue(less);
+    TEST_CONSTEXPR rational c = rational(1, 2) + rational(1, 3);
+#if RATIONAL_CONSTANT_EVALUATION
+    static_assert(c.denominator() == 6, "constexpr with instrumentation");
+#endif
+    AssertTrue(c.numerator() == 5 && c.denominator() == 6);
+    try {
+        rational(1, 0);
+        ostringstream os;
+        os << "do not catch logic_error!";
+        PrintError(__FILE__, __LINE__, "TestInstrumentation", os);
+        TestErrors.UpdateError();
+    } 
+    catch (logic_error const& err) {
+    }
+    thread worker([]() {
+        rational sum;
+        for (int i = 1; i <= 10; i++) {
+            sum += rational(1, i);
+        }
+    });
+    worker.join();
+    instrumentation_snapshot snapshot = InstrumentationSnapshot();
+    if (!IsInstrumentationEnabled()) {
+        for (size_t i = 0; i < RationalEventCount; i++) {
+            AssertTrue(snapshot.events[i] == 0);
+        }
+        return;
+    }
+    // 2 normalizations and 1 addition of this thread, 10 normalizations
+    // and 10 additions of the finished thread. `c` is counted too, if it
+    // is computed at runtime.
+    const unsigned long long runtime = RATIONAL_CONSTANT_EVALUATION ? 0 : 1;
+    AssertTrue(snapshot.count(rational_event::normalization) ==
+            12 + 2 * runtime);
+    AssertTrue(snapshot.count(rational_event::operation) == 23 + 3 * runtime);
+    AssertTrue(snapshot.count(rational_event::comparison) == 1);
+    AssertTrue(snapshot.count(rational_event::exception) == 1);
+    AssertTrue(snapshot.count(rational_event::overflow) == 0);
+    AssertTrue(snapshot.count(rational_event::gcd) >= 12);
+    // Operands are small, so GCD is answered by the table, if it is
+    // compiled in.
+    AssertTrue(snapshot.count(RATIONAL_GCD_TABLE_BITS > 0
+            ? rational_event::gcd_table : rational_event::gcd_iteration) > 0);
+    unsigned long long operations = 0;
+    for (size_t i = 0; i < RationalOperandBuckets; i++) {
+        operations += snapshot.operand_bits[i];
+    }
+    AssertTrue(operations == 23 + 3 * runtime);
+    // `6/8` has 3 bits.
+    AssertTrue(snapshot.operand_bits[3] >= 1);
+    
+    try {
+        rational big(integer_traits<int>::max());
+        big += rational(1);
+    } 
+    catch (overflow_error const& err) {
+    }
+    snapshot = InstrumentationSnapshot();
+    AssertTrue(snapshot.count(rational_event::overflow) == 1);
+    AssertTrue(snapshot.count(rational_event::exception) == 2);
+    AssertTrue(snapshot.operand_bits[31] == 2);
+    ResetInstrumentation();
+    snapshot = InstrumentationSnapshot();
+    AssertTrue(snapshot.count(rational_event::operation) == 0);
+}
+
+void TestRationalMatrix() {
+    rational_matrix a = {{2, 1}, {rational(1, 2), 3}};
+    AssertTrue(a.rows() == 2 && a.columns() == 2);
+    AssertEqual(MatrixDeterminant(a), rational(11, 2));
+    AssertTrue(MatrixRank(a) == 2);
+    rational_matrix inverse = MatrixInverse(a);
+    AssertTrue(a * inverse == rational_matrix::identity(2));
+    AssertEqual(inverse(0, 0), rational(6, 11));
+    vector<rational> x = SolveLinearSystem(a, vector<rational>{3, rational(7, 2)});
+    AssertEqual(x[0], rational(1));
+    AssertEqual(x[1], rational(1));
+    ostringstream os;
+    os << a;
+    AssertTrue(os.str() == "2/1 1/1\n1/2 3/1\n");
+
+    // The first pivot is zero, rows are swapped.
+    rational_matrix swapped = {{0, 1, 2}, {1, 0, 3}, {4, -3, 8}};
+    AssertEqual(MatrixDeterminant(swapped), rational(-2));
+    AssertTrue(MatrixInverse(swapped) * swapped == rational_matrix::identity(3));
+    AssertEqual(MatrixDeterminant(rational_matrix()), rational(1));
+
+    rational_matrix deficient = {{1, 2, 3}, {2, 4, 6}, {1, 0, 1}};
+    AssertEqual(MatrixDeterminant(deficient), rational(0));
+    AssertTrue(MatrixRank(deficient) == 2);
+    AssertTrue(MatrixRank(rational_matrix(3, 5)) == 0);
+    rational_matrix wide = {{0, 0, 1, 2}, {0, 0, 2, 4}, {0, 1, 0, 0}};
+    AssertTrue(MatrixRank(wide) == 2);
+
+    // Inverse of Hilbert matrix has integer values.
+    const size_t size = 6;
+    rational_matrix hilbert(size, size);
+    for (size_t i = 0; i < size; i++) {
+        for (size_t j = 0; j < size; j++) {
+            hilbert(i, j) = rational(1, int(i + j + 1));
+        }
+    }
+    rational_matrix hilbert_inverse = MatrixInverse(hilbert);
+    AssertEqual(hilbert_inverse(0, 0), rational(36));
+    AssertEqual(hilbert_inverse(5, 5), rational(698544));
+    AssertTrue(hilbert * hilbert_inverse == rational_matrix::identity(size));
+    rational_matrix hilbert4 = {{1, rational(1, 2), rational(1, 3), rational(1, 4)},
+            {rational(1, 2), rational(1, 3), rational(1, 4), rational(1, 5)},
+            {rational(1, 3), rational(1, 4), rational(1, 5), rational(1, 6)},
+            {rational(1, 4), rational(1, 5), rational(1, 6), rational(1, 7)}};
+    AssertEqual(MatrixDeterminant(hilbert4), rational(1, 6048000));
+
+    // Large denominators overflow `__int128`, elimination is repeated
+    // with `big_integer`.
+    const int primes[] = {2147483647, 2147483629, 2147483587, 2147483579};
+    rational_matrix large(4, 4);
+    for (size_t i = 0; i < 4; i++) {
+        for (size_t j = 0; j < 4; j++) {
+            large(i, j) = rational(int(i * 4 + j + 1), primes[(i + j) % 4]);
+        }
+    }
+    // The last row is dependent, `2 * row 0` keeps denominators in `int`.
+    for (size_t j = 0; j < 4; j++) {
+        large(3, j) = large(0, j) * rational(2);
+    }
+    AssertEqual(MatrixDeterminant(large), rational(0));
+    AssertTrue(MatrixRank(large) == 3);
+    rational_matrix scaled = {{rational(1, primes[0]), rational(1, primes[1]), 0},
+            {rational(1, primes[2]), rational(1, primes[3]), 0}, {0, 0, 1}};
+    // Rank does not narrow results, so it is found, while determinant of
+    // the same matrix does not fit into `rational`.
+    AssertTrue(MatrixRank(scaled) == 3);
+    try {
+        MatrixDeterminant(scaled);
+        ostringstream os;
+        os << "do not catch overflow_error!";
+        PrintError(__FILE__, __LINE__, "TestRationalMatrix", os);
+        TestErrors.UpdateError();
+    } 
+    catch (overflow_error const& err) {
+    }
+
+    // Parallel elimination gives the same results. `lower * upper` has
+    // determinant 1.
+    const size_t count = 80;
+    rational_matrix lower = rational_matrix::identity(count);
+    rational_matrix upper = rational_matrix::identity(count);
+    mt19937 generator(15);
+    for (size_t i = 0; i < count; i++) {
+        for (size_t j = 0; j < i; j++) {
+            lower(i, j) = int(generator() % 3) - 1;
+            upper(j, i) = rational(int(generator() % 3) - 1, 2);
+        }
+    }
+    rational_matrix product = lower * upper;
+    thread_pool pool(4);
+    AssertEqual(MatrixDeterminant(product), rational(1));
+    AssertEqual(MatrixDeterminant(product, &pool), rational(1));
+    for (size_t j = 0; j < count; j++) {
+        product(count - 1, j) = product(0, j) - product(1, j);
+    }
+    AssertTrue(MatrixRank(product) == count - 1);
+    AssertTrue(MatrixRank(product, &pool) == count - 1);
+    AssertEqual(MatrixDeterminant(product, &pool), rational(0));
+    // Inverse of unit bidiagonal matrix has entries `+-1`.
+    rational_matrix small = rational_matrix::identity(count);
+    for (size_t i = 0; i + 1 < count; i++) {
+        small(i, i + 1) = 1;
+    }
+    AssertTrue(MatrixInverse(small, &pool) == MatrixInverse(small));
+
+    try {
+        MatrixInverse(deficient);
+        ostringstream os;
+        os << "do not catch logic_error!";
+        PrintError(__FILE__, __LINE__, "TestRationalMatrix", os);
+        TestErrors.UpdateError();
+    } 
+    catch (logic_error const& err) {
+    }
+    try {
+        MatrixDeterminant(wide);
+        ostringstream os;
+        os << "do not catch logic_error!";
+        PrintError(__FILE__, __LINE__, "TestRationalMatrix", os);
+        TestErrors.UpdateError();
+    } 
+    catch (logic_error const& err) {
+    }
+    try {
+        a * wide;
+        ostringstream os;
+        os << "do not catch logic_error!";
+        PrintError(__FILE__, __LINE__, "TestRationalMatrix", os);
+        TestErrors.UpdateError();
+    } 
+    catch (logic_error const& err) {
+    }
+}
+
+void TestRationalPolynomial() {
+    rational_polynomial p = {1, 0, rational(1, 2)};
+    AssertTrue(p.degree() == 2 && p.size() == 3);
+    AssertTrue(p.denominator() == big_integer(2));
+    AssertTrue(p.numerators() == vector<big_integer>({2, 0, 1}));
+    AssertTrue(p.coefficient(2) == big_rational(1, 2));
+    AssertTrue(p.coefficient(5) == big_rational(0));
+    AssertTrue(p.evaluate(big_rational(2, 3)) == big_rational(11, 9));
+    AssertTrue((p - p).degree() == -1);
+    AssertTrue(p - p == rational_polynomial());
+    rational_polynomial linear = {1, rational(1, 3)};
+    rational_polynomial difference = {0, rational(1, 3), rational(-1, 2)};
+    AssertTrue(p + difference == linear);
+    rational_polynomial halves = {rational(2, 4), rational(3, 6)};
+    AssertTrue(halves == rational_polynomial(vector<big_integer>(2, -1),
+            big_integer(-2)));
+    ostringstream os;
+    os << p;
+    AssertTrue(os.str() == "1/1 0/1 1/2");
+    rational_polynomial plus = {1, 1}, minus = {-1, 1}, square = {-1, 0, 1};
+    AssertTrue(plus * minus == square);
+
+    // Karatsuba multiplication is compared with the schoolbook method.
+    mt19937 generator(16);
+    auto random_polynomial = [&generator](size_t size) {
+        vector<rational> values(size);
+        for (rational& value : values) {
+            value = rational(int(generator() % 2001) - 1000,
+                    int(generator() % 50) + 1);
+        }
+        values.back() += rational(1, 1000);
+        return rational_polynomial(values);
+    };
+    for (size_t size : {1, 5, 17, 40, 100}) {
+        rational_polynomial a = random_polynomial(size);
+        rational_polynomial b = random_polynomial(size * 2 + 3);
+        rational_polynomial product = a * b;
+        AssertTrue(product.degree() == a.degree() + b.degree());
+        bool same = true;
+        for (size_t k = 0; k < product.size(); k++) {
+            big_rational sum;
+            for (size_t i = 0; i <= k && i < a.size(); i++) {
+                sum += a.coefficient(i) * b.coefficient(k - i);
+            }
+            same = same && sum == product.coefficient(k);
+        }
+        AssertTrue(same);
+        AssertTrue(b * a == product);
+
+        rational_polynomial quotient, remainder;
+        PolynomialDivide(product + a, b, quotient, remainder);
+        AssertTrue(quotient == a);
+        AssertTrue(remainder == (size < size * 2 + 3 ? a : rational_polynomial()));
+        PolynomialDivide(b, a, quotient, remainder);
+        AssertTrue(remainder.degree() < a.degree() || a.degree() == 0);
+        AssertTrue(quotient * a + remainder == b);
+    }
+    rational_polynomial quotient, remainder;
+    rational_polynomial divisor = {1, 2, 3};
+    rational_polynomial one = {1};
+    rational_polynomial expected = {rational(5, 6), rational(-1, 3)};
+    PolynomialDivide(p, divisor, quotient, remainder);
+    AssertTrue(quotient == rational_polynomial({rational(1, 6)}));
+    AssertTrue(remainder == expected);
+    PolynomialDivide(one, p, quotient, remainder);
+    AssertTrue(quotient.degree() == -1 && remainder == one);
+
+    // Points with large denominators overflow `__int128`.
+    rational_polynomial q = random_polynomial(12);
+    vector<rational> points;
+    for (int i = 0; i < 3000; i++) {
+        points.push_back(i % 3 ? rational(i - 1500, i % 7 + 1)
+                : rational(i + 1, integer_traits<int>::max() - i));
+    }
+    vector<big_rational> values = EvaluatePolynomial(q, points);
+    thread_pool pool(3);
+    AssertTrue(EvaluatePolynomial(q, points, &pool) == values);
+    bool same = true;
+    for (size_t i = 0; i < points.size(); i++) {
+        same = same && values[i] == q.evaluate(points[i]);
+    }
+    AssertTrue(same);
+    AssertTrue(EvaluatePolynomial(rational_polynomial(), points)[7] ==
+            big_rational());
+
+    try {
+        PolynomialDivide(p, rational_polynomial(), quotient, remainder);
+        ostringstream os;
+        os << "do not catch logic_error!";
+        PrintError(__FILE__, __LINE__, "TestRationalPolynomial", os);
+        TestErrors.UpdateError();
+    } 
+    catch (logic_error const& err) {
+    }
+}
+
+/*
+ * Function checks, that `result` is the closest `double` to `num/deno`.
+ */
+bool IsClosestDouble(long long num, long long deno, double result) {
+    typedef basic_rational<__int128> wide_rational;
+    big_rational exact = basic_rational<long long>(num, deno);
+    big_rational distance = exact - RationalFromDouble<wide_rational>(result);
+    for (double other : {nextafter(result, -INFINITY),
+            nextafter(result, INFINITY)}) {
+        big_rational other_distance = exact -
+                RationalFromDouble<wide_rational>(other);
+        if ((distance < big_rational() ? big_rational() - distance : distance) >
+                (other_distance < big_rational() ? big_rational() -
+                other_distance : other_distance)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void TestRationalFloat() {
+    AssertTrue(RationalToDouble(rational(1, 3)) == 1.0 / 3);
+    AssertTrue(RationalToDouble(rational(-7, 2)) == -3.5);
+    AssertTrue(RationalToFloat(rational(1, 3)) == 1.0f / 3);
+    // Ties to even.
+    AssertTrue(RationalToFloat(rational(16777217)) == 16777216.0f);
+    AssertTrue(RationalToFloat(rational(16777219)) == 16777220.0f);
+    typedef basic_rational<long long> long_rational;
+    AssertTrue(RationalToDouble(long_rational((1LL << 53) + 1)) ==
+            9007199254740992.0);
+    AssertTrue(RationalToDouble(long_rational((1LL << 53) + 3)) ==
+            9007199254740996.0);
+    // `(double)` cast of numerator rounds it, then division rounds again.
+    long_rational twice(8197498975434128944LL, 67);
+    AssertTrue(RationalToDouble(twice) ==
+            ldexp(double(0x1b2ad5771df103LL), 4));
+    AssertTrue(double(twice.numerator()) / twice.denominator() !=
+            RationalToDouble(twice));
+    mt19937_64 generator(17);
+    bool closest = true;
+    for (int i = 0; i < 1000; i++) {
+        long long num = static_cast<long long>(generator() >> (i % 20));
+        long long deno = static_cast<long long>(generator() >> (i % 30)) + 1;
+        long_rational value(i % 2 ? num : -num, deno);
+        closest = closest && IsClosestDouble(value.numerator(),
+                value.denominator(), RationalToDouble(value));
+    }
+    AssertTrue(closest);
+    typedef basic_rational<__int128> wide_rational;
+    __int128 large = static_cast<__int128>(1) << 126;
+    AssertTrue(RationalToDouble(wide_rational(1, large + 1)) == ldexp(1.0, -126));
+    AssertTrue(RationalToDouble(wide_rational(3, large)) == ldexp(3.0, -126));
+    AssertTrue(RationalToDouble(wide_rational(large + 1, 1)) == ldexp(1.0, 126));
+
+    AssertEqual(RationalFromDouble(0.75), rational(3, 4));
+    AssertEqual(RationalFromDouble(-2.5), rational(-5, 2));
+    AssertEqual(RationalFromDouble(0.0), rational(0));
+    AssertTrue(RationalFromDouble<long_rational>(1e10) ==
+            long_rational(10000000000LL));
+    AssertTrue(RationalFromDouble<long_rational>(0.1) ==
+            long_rational(3602879701896397LL, 36028797018963968LL));
+    AssertTrue(RationalToDouble(RationalFromDouble<long_rational>(0.1)) == 0.1);
+
+    AssertEqual(BestRationalApproximation(M_PI, 1000), rational(355, 113));
+    AssertEqual(BestRationalApproximation(M_PI, 100), rational(311, 99));
+    AssertEqual(BestRationalApproximation(M_PI, 10), rational(22, 7));
+    AssertEqual(BestRationalApproximation(-M_PI, 1000), rational(-355, 113));
+    AssertEqual(BestRationalApproximation(0.5, 1), rational(0));
+    AssertEqual(BestRationalApproximation(0.75, 1), rational(1));
+    AssertEqual(BestRationalApproximation(2.5, 1), rational(2));
+    AssertEqual(BestRationalApproximation(1e-20, 100), rational(0));
+    AssertEqual(BestRationalApproximation(0.1, 1000000), rational(1, 10));
+    AssertTrue(BestRationalApproximation<long_rational>(M_PI, 1LL << 62) ==
+            RationalFromDouble<long_rational>(M_PI));
+
+    vector<rational> values;
+    for (int i = 1; i <= 1000; i++) {
+        values.push_back(rational(i * 7919 % 2001 - 1000, i));
+    }
+    rational_array array(values), restored;
+    vector<double> doubles;
+    vector<float> floats;
+    RationalArrayToDouble(array, doubles);
+    RationalArrayToFloat(array, floats);
+    bool same = true;
+    for (size_t i = 0; i < values.size(); i++) {
+        same = same && doubles[i] == RationalToDouble(values[i]) &&
+                floats[i] == RationalToFloat(values[i]);
+    }
+    AssertTrue(same);
+    BestRationalApproximationArray(doubles, 1000, restored);
+    AssertTrue(restored.toVector() == values);
+    RationalArrayFromDouble(vector<double>{0.5, -0.25, 3}, restored);
+    AssertTrue(restored.toVector() == vector<rational>({rational(1, 2),
+            rational(-1, 4), rational(3)}));
+
+    try {
+        RationalFromDouble(0.1);
+        ostringstream os;
+        os << "do not catch overflow_error!";
+        PrintError(__FILE__, __LINE__, "TestRationalFloat", os);
+        TestErrors.UpdateError();
+    } 
+    catch (overflow_error const& err) {
+    }
+    try {
+        BestRationalApproximation(1e10, 10);
+        ostringstream os;
+        os << "do not catch overflow_error!";
+        PrintError(__FILE__, __LINE__, "TestRationalFloat", os);
+        TestErrors.UpdateError();
+    } 
+    catch (overflow_error const& err) {
+    }
+    try {
+        RationalFromDouble(NAN);
+        ostringstream os;
+        os << "do not catch logic_error!";
+        PrintError(__FILE__, __LINE__, "TestRationalFloat", os);
+        TestErrors.UpdateError();
+    } 
+    catch (logic_error const& err) {
+    }
+    try {
+        BestRationalApproximation(0.5, 0);
+        ostringstream os;
+        os << "do not catch logic_error!";
+        PrintError(__FILE__, __LINE__, "TestRationalFloat", os);
+        TestErrors.UpdateError();
+    } 
+    catch (logic_error const& err) {
+    }
+}
+
+void TestRationalExpression() {
+    rational a(1, 2), b(3, 4), c(5, 6), d(7, 8), e(1, 9);
+    rational fused = Fuse(a) * b + Fuse(c) * d - e;
+    AssertEqual(fused, a * b + c * d - e);
+    AssertEqual(rational(Fuse(a) / b - c / Fuse(d)), a / b - c / d);
+    AssertEqual(rational(Fuse(a) * 2 + 1), rational(2));
+    rational sum = a;
+    sum += Fuse(b) * c;
+    AssertEqual(sum, a + b * c);
+    TEST_CONSTEXPR rational folded = Fuse(rational(1, 2)) + rational(1, 3);
+#if RATIONAL_CONSTANT_EVALUATION
+    static_assert(folded.denominator() == 6, "constexpr expression");
+#endif
+    AssertEqual(folded, rational(5, 6));
+
+    mt19937 generator(18);
+    auto random_rational = [&generator](int limit) {
+        int num = int(generator() % (2 * limit + 1)) - limit;
+        return rational(num, int(generator() % limit) + 1);
+    };
+    // Eager operators are the reference, values are small enough for
+    // their intermediate results to fit into `int`.
+    bool same = true;
+    for (int i = 0; i < 1000; i++) {
+        rational x = random_rational(30), y = random_rational(30),
+                z = random_rational(30), w = random_rational(30);
+        same = same && rational(Fuse(x) * y + z * Fuse(w) - x) ==
+                x * y + z * w - x;
+        same = same && rational(Fuse(x) - y * (Fuse(z) + w)) ==
+                x - y * (z + w);
+        if (w != rational(0)) {
+            same = same && rational((Fuse(x) + y) / w - z) == (x + y) / w - z;
+        }
+    }
+    AssertTrue(same);
+    typedef basic_rational<long long> long_rational;
+    long_rational big(3037000499LL, 7), other(2, 3037000493LL);
+    AssertTrue(long_rational(Fuse(big) * other - big) == big * other - big);
+
+    // Intermediate value does not fit into `int`, the result fits.
+    rational large(65536);
+    AssertEqual(rational(Fuse(large) * large / rational(4)),
+            rational(1 << 30));
+    try {
+        rational(large * large / rational(4));
+        ostringstream os;
+        os << "do not catch overflow_error!";
+        PrintError(__FILE__, __LINE__, "TestRationalExpression", os);
+        TestErrors.UpdateError();
+    } 
+    catch (overflow_error const& err) {
+    }
+    try {
+        rational(Fuse(large) * large + large);
+        ostringstream os;
+        os << "do not catch overflow_error!";
+        PrintError(__FILE__, __LINE__, "TestRationalExpression", os);
+        TestErrors.UpdateError();
+    } 
+    catch (overflow_error const& err) {
+    }
+    try {
+        rational(Fuse(a) / (b - b));
+        ostringstream os;
+        os << "do not catch logic_error!";
+        PrintError(__FILE__, __LINE__, "TestRationalExpression", os);
+        TestErrors.UpdateError();
+    } 
+    catch (logic_error const& err) {
+    }
+    // Overflow policy of eager operators is used, if the result does not
+    // fit.
+    typedef basic_rational<int, overflow_saturate> saturated;
+    saturated huge(integer_traits<int>::max());
+    AssertTrue(saturated(Fuse(huge) * huge + huge) == huge * huge + huge);
+
+    if (IsInstrumentationEnabled()) {
+        ResetInstrumentation();
+        rational eager = a * b + c * d - e;
+        unsigned long long eager_gcd =
+                InstrumentationSnapshot().count(rational_event::gcd);
+        ResetInstrumentation();
+        rational lazy = Fuse(a) * b + Fuse(c) * d - e;
+        unsigned long long fused_gcd =
+                InstrumentationSnapshot().count(rational_event::gcd);
+        AssertEqual(eager, lazy);
+        AssertTrue(fused_gcd == 1 && fused_gcd < eager_gcd);
+    }
+}
+
+void TestRationalDot() {
+    rational a(1, 2), b(3, 4), c(5, 6);
+    AssertEqual(RationalFma(a, b, c), a + b * c);
+    rational_accumulator<rational> accumulator;
+    RationalFma(accumulator, a, b);
+    RationalFma(accumulator, b, c);
+    accumulator.add(c);
+    AssertEqual(accumulator.value(), a * b + b * c + c);
+    vector<rational> empty;
+    AssertEqual(RationalDot(empty, empty), rational(0));
+
+    // Denominators `2^i` and `3^j`, so the sum fits into `long long`.
+    typedef basic_rational<long long> long_rational;
+    mt19937 generator(19);
+    vector<long_rational> x, y;
+    long_rational expected;
+    for (int i = 0; i < 20000; i++) {
+        int num1 = int(generator() % 8191) - 4095;
+        int num2 = int(generator() % 8191) - 4095;
+        x.push_back(long_rational(num1, 1 << (generator() % 7)));
+        y.push_back(long_rational(num2, int(pow(3, generator() % 5))));
+        expected += x.back() * y.back();
+    }
+    thread_pool pool(4);
+    AssertTrue(RationalDot(x, y) == expected);
+    AssertTrue(RationalDot(x, y, pool) == expected);
+    AssertTrue(RationalDot(x.data(), y.data(), 100) ==
+            RationalDot(x.data(), y.data(), 100, pool));
+
+    // Products do not fit into `int`, the sum fits.
+    vector<rational> large = {65536, -65536, 3};
+    vector<rational> same = {65536, 65536, rational(1, 3)};
+    AssertEqual(RationalDot(large, same), rational(1));
+    // Coprime denominators overflow `__int128`, eager fallback raises
+    // the error of `rational` operators.
+    vector<rational> inverse = {rational(1, 2147483647),
+            rational(1, 2147483629), rational(1, 2147483587),
+            rational(1, 2147483579), rational(1, 2147483563)};
+    vector<rational> ones(inverse.size(), rational(1));
+    try {
+        RationalDot(inverse, ones);
+        ostringstream os;
+        os << "do not catch overflow_error!";
+        PrintError(__FILE__, __LINE__, "TestRationalDot", os);
+        TestErrors.UpdateError();
+    } 
+    catch (overflow_error const& err) {
+    }
+    // Saturating rationals saturate like the serial sum.
+    typedef basic_rational<int, overflow_saturate> saturated;
+    const int max = integer_traits<int>::max();
+    for (int sign : {1, -1}) {
+        vector<saturated> terms = {sign * max, sign * max, sign * 3};
+        vector<saturated> units(terms.size(), saturated(1));
+        saturated serial;
+        for (const saturated& term : terms) {
+            serial += term;
+        }
+        AssertTrue(RationalDot(terms, units) == serial);
+        AssertTrue(RationalFma(terms[0], terms[1], units[1]) ==
+                terms[0] + terms[1]);
+    }
+    vector<saturated> saturated_inverse;
+    for (const rational& value : inverse) {
+        saturated_inverse.push_back(saturated(1, value.denominator()));
+    }
+    vector<saturated> saturated_ones(inverse.size(), saturated(1));
+    AssertTrue(RationalDot(saturated_inverse, saturated_ones) > saturated(0));
+    try {
+        RationalDot(inverse, empty);
+        ostringstream os;
+        os << "do not catch logic_error!";
+        PrintError(__FILE__, __LINE__, "TestRationalDot", os);
+        TestErrors.UpdateError();
+    } 
+    catch (logic_error const& err) {
+    }
+}
+
+void TestRationalSort() {
+    mt19937 generator(20);
+    vector<rational> values;
+    for (int i = 0; i < 100000; i++) {
+        int num = int(generator() % 2001) - 1000;
+        values.push_back(rational(num, int(generator() % 1000) + 1));
+        // Neighbours of 1, which have equal double keys.
+        int large = 2147483647 - int(generator() % 1000);
+        values.push_back(rational(large - 1, large));
+    }
+    vector<rational> expected = values;
+    sort(expected.begin(), expected.end());
+    vector<rational> serial = values;
+    RationalSort(serial);
+    AssertTrue(serial == expected);
+    vector<rational> parallel = values;
+    thread_pool pool(4);
+    RationalSort(parallel, pool);
+    AssertTrue(parallel == expected);
+    vector<rational> small(values.begin(), values.begin() + 100);
+    vector<rational> small_expected = small;
+    sort(small_expected.begin(), small_expected.end());
+    RationalSort(small);
+    AssertTrue(small == small_expected);
+
+    // Ratios of Fibonacci numbers, all keys are equal to golden ratio.
+    typedef basic_rational<long long> long_rational;
+    vector<long_rational> fibonacci;
+    long long a = 1, b = 2;
+    while (b < 4000000000000000000LL) {
+        fibonacci.push_back(long_rational(b, a));
+        long long next = a + b;
+        a = b;
+        b = next;
+    }
+    for (int i = 0; i < 2000; i++) {
+        fibonacci.push_back(long_rational(
+                (long long)(generator()) - (1LL << 31), generator() + 1ULL));
+    }
+    shuffle(fibonacci.begin(), fibonacci.end(), generator);
+    vector<long_rational> long_expected = fibonacci;
+    sort(long_expected.begin(), long_expected.end());
+    RationalSort(fibonacci);
+    AssertTrue(fibonacci == long_expected);
+    vector<rational> empty;
+    RationalSort(empty, pool);
+    AssertTrue(empty.empty());
+}
+
+void TestFixedRational() {
+    typedef fixed_rational<100> money;
+    constexpr money price = money::fromTicks(1999);
+    static_assert(price.ticks() == 1999 && money::denominator() == 100,
+            "fixed rational must be evaluated at compile time");
+    money a = money::fromTicks(1050), b = money::fromTicks(-275);
+    AssertTrue((a + b).ticks() == 775);
+    AssertTrue((a - b).ticks() == 1325);
+    AssertTrue((a * 3).ticks() == 3150);
+    AssertTrue((a / 2).ticks() == 525);
+    AssertTrue(money(7).ticks() == 700);
+    money sum = a;
+    sum += b;
+    sum -= money(1);
+    AssertTrue(sum.ticks() == 675);
+
+    // Product and quotient are rounded to the nearest tick, ties to even.
+    money half = money::fromTicks(50);
+    AssertTrue((money::fromTicks(5) * half).ticks() == 2);
+    AssertTrue((money::fromTicks(15) * half).ticks() == 8);
+    AssertTrue((money::fromTicks(-15) * half).ticks() == -8);
+    AssertTrue((money::fromTicks(-5) * half).ticks() == -2);
+    AssertTrue((money::fromTicks(101) * half).ticks() == 50);
+    AssertTrue((money(1) / money(3)).ticks() == 33);
+    AssertTrue((money(2) / money(-3)).ticks() == -67);
+    // Remainders near `LLONG_MAX` are rounded without doubling them.
+    typedef fixed_rational<1> whole;
+    const long long long_max = integer_traits<long long>::max();
+    AssertTrue((whole::fromTicks(5000000000000000000LL) /
+            whole::fromTicks(long_max)).ticks() == 1);
+    AssertTrue((whole::fromTicks(-5000000000000000000LL) /
+            whole::fromTicks(long_max)).ticks() == -1);
+    AssertTrue((whole::fromTicks(4000000000000000000LL) /
+            whole::fromTicks(-long_max)).ticks() == 0);
+
+    // Conversions are exact.
+    rational quarter(1, 4);
+    AssertTrue(money(quarter).toRational() ==
+            basic_rational<long long>(1, 4));
+    AssertTrue(money(quarter).ticks() == 25);
+    basic_rational<long long> value = a;
+    AssertTrue(value == basic_rational<long long>(21, 2));
+    AssertTrue(money(value) == a);
+    typedef fixed_rational<1000000, int> ticks;
+    AssertEqual(rational(ticks::fromTicks(250000)), quarter);
+
+    // Comparison and arithmetic with `basic_rational`.
+    basic_rational<long long> ten(10);
+    AssertTrue(a > ten && ten < a && a != ten && !(a == ten));
+    AssertTrue(money(10) == ten && money(10) <= ten && money(10) >= ten);
+    AssertTrue(a + ten == basic_rational<long long>(41, 2));
+    AssertTrue(b < a && a >= b && bool(a) && !bool(money()));
+
+    ostringstream output;
+    output << a << " " << money::fromTicks(25);
+    AssertTrue(output.str() == "21/2 1/4");
+    istringstream input("3/4 1/3");
+    money read;
+    input >> read;
+    AssertTrue(read.ticks() == 75);
+
+    try {
+        money third(rational(1, 3));
+        ostringstream os;
+        os << "do not catch logic_error! Result: " << third;
+        PrintError(__FILE__, __LINE__, "TestFixedRational", os);
+        TestErrors.UpdateError();
+    } 
+    catch (logic_error const& err) {
+    }
+    try {
+        money zero;
+        a /= zero;
+        ostringstream os;
+        os << "do not catch logic_error!";
+        PrintError(__FILE__, __LINE__, "TestFixedRational", os);
+        TestErrors.UpdateError();
+    } 
+    catch (logic_error const& err) {
+    }
+    try {
+        ticks large = ticks(2000) + ticks(2000);
+        ostringstream os;
+        os << "do not catch overflow_error! Result: " << large;
+        PrintError(__FILE__, __LINE__, "TestFixedRational", os);
+        TestErrors.UpdateError();
+    } 
+    catch (overflow_error const& err) {
+    }
+    try {
+        ticks large = ticks(40) * ticks(60);
+        ostringstream os;
+        os << "do not catch overflow_error! Result: " << large;
+        PrintError(__FILE__, __LINE__, "TestFixedRational", os);
+        TestErrors.UpdateError();
+    } 
+    catch (overflow_error const& err) {
+    }
+    try {
+        typedef fixed_rational<2> halves;
+        halves large = halves::fromTicks(integer_traits<long long>::min() / 2)
+                / halves::fromTicks(-1);
+        ostringstream os;
+        os << "do not catch overflow_error! Result: " << large;
+        PrintError(__FILE__, __LINE__, "TestFixedRational", os);
+        TestErrors.UpdateError();
+    } 
+    catch (overflow_error const& err) {
+    }
+}
+
+void TestRationalDecimal() {
+    char buffer[128];
+    auto decimal = [&buffer](basic_rational<long long> value,
+            std::size_t digits, rounding_mode rounding) {
+        format_result result = FormatDecimal(buffer, buffer + sizeof(buffer),
+                value, digits, rounding);
+        return result.ec == std::errc() ? string(buffer, result.ptr)
+                : string("error");
+    };
+    auto repeating = [&buffer](basic_rational<long long> value) {
+        format_result result = FormatRepeatingDecimal(buffer,
+                buffer + sizeof(buffer), value);
+        return result.ec == std::errc() ? string(buffer, result.ptr)
+                : string("error");
+    };
+    typedef basic_rational<long long> value_type;
+    rounding_mode even = rounding_mode::half_even;
+    AssertTrue(repeating(value_type(1, 3)) == "0.(3)");
+    AssertTrue(repeating(value_type(1, 6)) == "0.1(6)");
+    AssertTrue(repeating(value_type(1, 4)) == "0.25");
+    AssertTrue(repeating(value_type(-22, 7)) == "-3.(142857)");
+    AssertTrue(repeating(value_type(5)) == "5");
+    AssertTrue(repeating(value_type(0)) == "0");
+    AssertTrue(repeating(value_type(7, 12)) == "0.58(3)");
+    AssertTrue(repeating(value_type(1, 81)) == "0.(012345679)");
+
+    // Multiplicative order agrees with the brute force.
+    for (unsigned long long modulus = 1; modulus < 2000; modulus++) {
+        if (BinaryGreatestCommonDivisor(10ULL, modulus) != 1) {
+            continue;
+        }
+        unsigned long long order = 1, power = 10 % modulus;
+        while (power != 1 % modulus) {
+            power = power * 10 % modulus;
+            order++;
+        }
+        AssertTrue(MultiplicativeOrder(10, modulus) == order);
+    }
+    std::size_t preperiod = 0;
+    unsigned long long period = 0;
+    DecimalPeriod(97, preperiod, period);
+    AssertTrue(preperiod == 0 && period == 96);
+    DecimalPeriod(7 * 40, preperiod, period);
+    AssertTrue(preperiod == 3 && period == 6);
+    DecimalPeriod(1000, preperiod, period);
+    AssertTrue(preperiod == 3 && period == 0);
+    // 10 is a primitive root of the prime, and its half for a safe prime.
+    const unsigned long long prime = 1000000000000000003ULL;
+    unsigned long long order = MultiplicativeOrder(10, prime);
+    AssertTrue((prime - 1) % order == 0);
+    AssertTrue(MultiplicativeOrder(2, 2305843009213693951ULL) == 61);
+    AssertTrue(MultiplicativeOrder(3, 4294967297ULL) ==
+            MultiplicativeOrder(3, 641) / BinaryGreatestCommonDivisor(
+            MultiplicativeOrder(3, 641), MultiplicativeOrder(3, 6700417)) *
+            MultiplicativeOrder(3, 6700417));
+
+    // Rounding modes.
+    AssertTrue(decimal(value_type(2, 3), 3, even) == "0.667");
+    AssertTrue(decimal(value_type(2, 3), 0, even) == "1");
+    AssertTrue(decimal(value_type(1, 8), 2, even) == "0.12");
+    AssertTrue(decimal(value_type(3, 8), 2, even) == "0.38");
+    AssertTrue(decimal(value_type(1, 8), 2,
+            rounding_mode::half_away_from_zero) == "0.13");
+    AssertTrue(decimal(value_type(-1, 8), 2,
+            rounding_mode::half_away_from_zero) == "-0.13");
+    AssertTrue(decimal(value_type(2, 3), 2, rounding_mode::toward_zero) ==
+            "0.66");
+    AssertTrue(decimal(value_type(-1, 3), 2, rounding_mode::floor) == "-0.34");
+    AssertTrue(decimal(value_type(-1, 3), 2, rounding_mode::ceiling) ==
+            "-0.33");
+    AssertTrue(decimal(value_type(1, 3), 2, rounding_mode::ceiling) == "0.34");
+    AssertTrue(decimal(value_type(-1, 1000), 2, even) == "-0.00");
+    AssertTrue(decimal(value_type(999, 100), 1, even) == "10.0");
+    AssertTrue(decimal(value_type(-995, 100), 1,
+            rounding_mode::half_away_from_zero) == "-10.0");
+    AssertTrue(decimal(value_type(5, 2), 0, even) == "2");
+    AssertTrue(decimal(value_type(7, 2), 0, even) == "4");
+    AssertTrue(decimal(value_type(1, 7), 30, even) ==
+            "0.142857142857142857142857142857");
+    AssertTrue(decimal(value_type(-3), 2, even) == "-3.00");
+    AssertTrue(decimal(value_type(integer_traits<long long>::min()), 0,
+            even) == "-9223372036854775808");
+
+    // Small buffers.
+    char small[4];
+    AssertTrue(FormatDecimal(small, small + sizeof(small), value_type(1, 3),
+            3).ec == std::errc::value_too_large);
+    // `10.0` needs one more character after the carry.
+    AssertTrue(FormatDecimal(small, small + 3, value_type(999, 100),
+            1).ec == std::errc::value_too_large);
+    AssertTrue(FormatRepeatingDecimal(small, small + sizeof(small),
+            value_type(1, 7)).ec == std::errc::value_too_large);
+    AssertTrue(FormatRepeatingDecimal(buffer, buffer + sizeof(buffer),
+            value_type(1, 97)).ec == std::errc());
+    AssertTrue(FormatRepeatingDecimal(buffer, buffer + sizeof(buffer),
+            value_type(1, 997)).ec == std::errc::value_too_large);
+
+    // Digits agree with the long division by one digit.
+    mt19937_64 generator(23);
+    for (int i = 0; i < 2000; i++) {
+        long long denominator = i % 2 ? static_cast<long long>(
+                generator() >> 2) + 1 : static_cast<long long>(
+                generator() % 100000) + 1;
+        long long numerator = static_cast<long long>(generator() >> 1) -
+                (i % 3 ? static_cast<long long>(1ULL << 62) : 0);
+        value_type value(numerator, denominator);
+        unsigned long long magnitude = static_cast<unsigned long long>(
+                AbsoluteValue(value.numerator()));
+        unsigned long long d = value.denominator();
+        string expected = (value.numerator() < 0 ? "-" : "") +
+                to_string(magnitude / d) + ".";
+        unsigned __int128 remainder = magnitude % d;
+        for (int digit = 0; digit < 40; digit++) {
+            remainder *= 10;
+            expected += static_cast<char>('0' + remainder / d);
+            remainder %= d;
+        }
+        AssertTrue(decimal(value, 40, rounding_mode::toward_zero) == expected);
+    }
+    value_type fraction(1, 3);
+    AssertTrue(repeating(fraction * value_type(1, 16)) == "0.0208(3)");
+}
+
+void TestRationalFarey() {
+    vector<rational> terms;
+    ForEachFarey(5, [&terms](int n, int d) {
+        terms.push_back(rational(n, d));
+    });
+    vector<rational> expected = {rational(0), rational(1, 5), rational(1, 4),
+            rational(1, 3), rational(2, 5), rational(1, 2), rational(3, 5),
+            rational(2, 3), rational(3, 4), rational(4, 5), rational(1)};
+    AssertTrue(terms == expected);
+    AssertTrue(FareyLength(5) == 11);
+    AssertTrue(FareyLength(1) == 2);
+
+    // Terms agree with the set of all reduced fractions.
+    for (int order : {1, 2, 7, 60}) {
+        set<rational> all;
+        for (int d = 1; d <= order; d++) {
+            for (int n = 0; n <= d; n++) {
+                all.insert(rational(n, d));
+            }
+        }
+        farey_sequence<> sequence(order);
+        vector<rational> generated;
+        do {
+            AssertTrue(GreatestCommonDivisor(sequence.numerator(),
+                    sequence.denominator()) == 1);
+            generated.push_back(sequence.value());
+        } while (sequence.next());
+        AssertTrue(generated == vector<rational>(all.begin(), all.end()));
+        AssertTrue(FareyLength(order) == all.size());
+    }
+
+    // Start from a term in the middle.
+    farey_sequence<long long> middle(1000000, 1, 3);
+    AssertTrue(middle.next());
+    AssertTrue(middle.numerator() == 333333 && middle.denominator() == 999998);
+    farey_sequence<> last(5, 4, 5);
+    AssertTrue(last.next() && last.value() == rational(1));
+    AssertFalse(last.next());
+    for (int start = 0; start + 1 < static_cast<int>(expected.size());
+            start++) {
+        farey_sequence<> sequence(5, expected[start].numerator(),
+                expected[start].denominator());
+        AssertTrue(sequence.next());
+        AssertEqual(sequence.value(), expected[start + 1]);
+    }
+
+    // Chunks of the parallel version cover the sequence in order.
+    thread_pool pool(4);
+    const int order = 300;
+    vector<vector<rational>> chunks(FareyChunkCount(order, pool));
+    ParallelFarey(order, pool, [&chunks](size_t chunk, int n, int d) {
+        chunks[chunk].push_back(rational(n, d));
+    });
+    vector<rational> joined, serial;
+    for (const vector<rational>& chunk : chunks) {
+        AssertFalse(chunk.empty());
+        joined.insert(joined.end(), chunk.begin(), chunk.end());
+    }
+    ForEachFarey(order, [&serial](int n, int d) {
+        serial.push_back(rational(n, d));
+    });
+    AssertTrue(joined == serial);
+    AssertTrue(serial.size() == FareyLength(order));
+    thread_pool single(1);
+    size_t small_count = 0;
+    ParallelFarey(3, single, [&small_count](size_t, int, int) {
+        small_count++;
+    });
+    AssertTrue(small_count == 5);
+
+    // Stern-Brocot tree.
+    stern_brocot_node<> node;
+    AssertEqual(node.value(), rational(1));
+    node.goLeft();
+    AssertEqual(node.value(), rational(1, 2));
+    node.goRight();
+    AssertEqual(node.value(), rational(2, 3));
+    node.goRight();
+    AssertEqual(node.value(), rational(3, 4));
+    node.goLeft();
+    AssertEqual(node.value(), rational(5, 7));
+    AssertTrue(node.depth() == 4);
+    vector<rational> tree;
+    ForEachSternBrocot<int>(3, [&tree](int n, int d) {
+        tree.push_back(rational(n, d));
+    });
+    vector<rational> levels = {rational(1, 3), rational(1, 2), rational(2, 3),
+            rational(1), rational(3, 2), rational(2), rational(3)};
+    AssertTrue(tree == levels);
+    tree.clear();
+    ForEachSternBrocot<long long>(12, [&tree](long long n, long long d) {
+        tree.push_back(rational(static_cast<int>(n), static_cast<int>(d)));
+    });
+    AssertTrue(tree.size() == (1 << 12) - 1);
+    AssertTrue(is_sorted(tree.begin(), tree.end()));
+    AssertTrue(set<rational>(tree.begin(), tree.end()).size() == tree.size());
+
+    try {
+        farey_sequence<> sequence(0);
+        ostringstream os;
+        os << "do not catch logic_error! Result: " << sequence.value();
+        PrintError(__FILE__, __LINE__, "TestRationalFarey", os);
+        TestErrors.UpdateError();
+    } 
+    catch (logic_error const& err) {
+    }
+    try {
+        farey_sequence<> sequence(5, 2, 4);
+        ostringstream os;
+        os << "do not catch logic_error! Result: " << sequence.value();
+        PrintError(__FILE__, __LINE__, "TestRationalFarey", os);
+        TestErrors.UpdateError();
+    } 
+    catch (logic_error const& err) {
+    }
+    try {
+        stern_brocot_node<> right;
+        for (int i = 0; i < 1 << 16; i++) {
+            right.goRight();
+        }
+        for (int i = 0; i < 1 << 16; i++) {
+            right.goLeft();
+        }
+        ostringstream os;
+        os << "do not catch overflow_error! Result: " << right.value();
+        PrintError(__FILE__, __LINE__, "TestRationalFarey", os);
+        TestErrors.UpdateError();
+    } 
+    catch (overflow_error const& err) {
+    }
+}
+
+void TestRationalStatistics() {
+    rational_statistics<rational> statistics;
+    for (int value : {2, 4, 4, 4, 5, 5, 7, 9}) {
+        statistics.add(rational(value));
+    }
+    AssertTrue(statistics.count() == 8);
+    AssertEqual(statistics.sum(), rational(40));
+    AssertEqual(statistics.sumOfSquares(), rational(232));
+    AssertEqual(statistics.mean(), rational(5));
+    AssertEqual(statistics.variance(), rational(4));
+    AssertEqual(statistics.sampleVariance(), rational(32, 7));
+
+    rational_weighted_mean<rational> weighted;
+    weighted.add(rational(1, 2), rational(1));
+    weighted.add(rational(1, 3), rational(2));
+    weighted.add(rational(-1, 6), rational(1, 2));
+    AssertEqual(weighted.totalWeight(), rational(7, 2));
+    AssertEqual(weighted.weightedSum(), rational(13, 12));
+    AssertEqual(weighted.value(), rational(13, 42));
+
+    // Sum of squares does not fit into `int`, variance does.
+    rational_statistics<rational> constant;
+    for (int i = 0; i < 4; i++) {
+        constant.add(rational(50000, 3));
+    }
+    AssertEqual(constant.mean(), rational(50000, 3));
+    AssertEqual(constant.variance(), rational(0));
+
+    // Exact values agree with `big_rational`, merged halves and parallel
+    // chunks agree with one pass.
+    typedef basic_rational<long long> long_rational;
+    mt19937 generator(25);
+    vector<long_rational> values;
+    for (int i = 0; i < 10000; i++) {
+        long long numerator = static_cast<long long>(generator() % 2001) -
+                1000;
+        long long denominator = i % 2 ? (generator() % 3 ? 1 : 3)
+                : 1 << (generator() % 5);
+        values.push_back(long_rational(numerator, denominator));
+    }
+    big_rational sum, squares, weight_sum, product_sum;
+    rational_statistics<long_rational> first, second;
+    rational_weighted_mean<long_rational> weighted_first, weighted_second;
+    for (size_t i = 0; i < values.size(); i++) {
+        big_rational value(values[i]);
+        sum += value;
+        value *= values[i];
+        squares += value;
+        (i < values.size() / 2 ? first : second).add(values[i]);
+        long_rational weight(static_cast<long long>(i % 7) + 1, 3);
+        (i % 3 ? weighted_first : weighted_second).add(values[i], weight);
+        weight_sum += weight;
+        big_rational product(values[i]);
+        product *= weight;
+        product_sum += product;
+    }
+    rational_statistics<long_rational> all = RationalStatistics(values);
+    first.merge(second);
+    big_rational count(static_cast<long long>(values.size()));
+    big_rational mean = sum;
+    mean /= count;
+    big_rational variance = mean;
+    variance *= sum;
+    variance -= squares;
+    variance /= count;
+    variance *= big_rational(-1);
+    AssertTrue(all.exactMean() == mean && all.exactVariance() == variance);
+    long_rational expected;
+    AssertTrue(mean.toRational(expected));
+    AssertTrue(all.mean() == expected && first.mean() == expected);
+    AssertTrue(variance.toRational(expected));
+    AssertTrue(all.variance() == expected && first.variance() == expected);
+    variance *= count;
+    variance /= big_rational(static_cast<long long>(values.size() - 1));
+    AssertTrue(variance.toRational(expected));
+    AssertTrue(all.sampleVariance() == expected);
+    AssertTrue(sum.toRational(expected) && all.sum() == expected);
+    AssertTrue(squares.toRational(expected) && all.sumOfSquares() == expected);
+    weighted_first.merge(weighted_second);
+    AssertTrue(weight_sum.toRational(expected) &&
+            weighted_first.totalWeight() == expected);
+    product_sum /= weight_sum;
+    AssertTrue(weighted_first.exactValue() == product_sum);
+    AssertTrue(product_sum.toRational(expected));
+    AssertTrue(weighted_first.value() == expected);
+    thread_pool pool(4);
+    rational_statistics<long_rational> parallel =
+            RationalStatistics(values, pool);
+    AssertTrue(parallel.variance() == all.variance());
+    AssertTrue(parallel.count() == values.size());
+
+    // Unreduced sums of large denominators overflow `__int128` and are
+    // reduced, their common denominator `2^40 * 105` fits.
+    rational_statistics<basic_rational<long long>> large;
+    big_rational large_sum;
+    const long long odd[] = {1, 3, 5, 7};
+    for (long long i = 0; i < 200; i++) {
+        basic_rational<long long> value(i, (1LL << 40) * odd[i % 4]);
+        large.add(value);
+        large_sum += value;
+    }
+    large_sum /= big_rational(200);
+    basic_rational<long long> large_mean;
+    AssertTrue(large_sum.toRational(large_mean));
+    AssertTrue(large.mean() == large_mean);
+    AssertTrue(large.count() == 200);
+
+    // Coprime denominators near `2^31`: sums do not fit into `__int128`,
+    // results stay exact for every overflow policy.
+    const int primes[] = {2147483647, 2147483629, 2147483587, 2147483579,
+            2147483563, 2147483549};
+    rational_statistics<rational> inverse;
+    rational_statistics<basic_rational<int, overflow_saturate>>
+            saturated_inverse;
+    rational_weighted_mean<rational> inverse_weighted;
+    big_rational inverse_sum, inverse_squares;
+    for (int prime : primes) {
+        inverse.add(rational(1, prime));
+        saturated_inverse.add(basic_rational<int, overflow_saturate>(1, prime));
+        inverse_weighted.add(rational(1, prime), rational(1, prime));
+        big_rational value(1, prime);
+        inverse_sum += value;
+        value *= value;
+        inverse_squares += value;
+    }
+    big_rational inverse_count(6);
+    big_rational inverse_mean = inverse_sum;
+    inverse_mean /= inverse_count;
+    big_rational inverse_variance = inverse_mean;
+    inverse_variance *= inverse_sum;
+    inverse_variance -= inverse_squares;
+    inverse_variance /= inverse_count;
+    inverse_variance *= big_rational(-1);
+    AssertTrue(inverse.exactMean() == inverse_mean);
+    AssertTrue(saturated_inverse.exactMean() == inverse_mean);
+    AssertTrue(inverse.exactVariance() == inverse_variance);
+    AssertTrue(saturated_inverse.exactVariance() == inverse_variance);
+    AssertFalse(inverse_mean.isSmall());
+    inverse_squares /= inverse_sum;
+    AssertTrue(inverse_weighted.exactValue() == inverse_squares);
+    rational_statistics<rational> twice = inverse;
+    twice.merge(inverse);
+    AssertTrue(twice.count() == 12 && twice.exactMean() == inverse_mean);
+    try {
+        saturated_inverse.mean();
+        ostringstream os;
+        os << "do not catch overflow_error!";
+        PrintError(__FILE__, __LINE__, "TestRationalStatistics", os);
+        TestErrors.UpdateError();
+    } 
+    catch (overflow_error const& err) {
+    }
+    try {
+        rational_statistics<rational> empty;
+        ostringstream os;
+        os << "do not catch logic_error! Result: " << empty.mean();
+        PrintError(__FILE__, __LINE__, "TestRationalStatistics", os);
+        TestErrors.UpdateError();
+    } 
+    catch (logic_error const& err) {
+    }
+    try {
+        rational_statistics<rational> single;
+        single.add(rational(1));
+        ostringstream os;
+        os << "do not catch logic_error! Result: " << single.sampleVariance();
+        PrintError(__FILE__, __LINE__, "TestRationalStatistics", os);
+        TestErrors.UpdateError();
+    } 
+    catch (logic_error const& err) {
+    }
+    try {
+        rational_weighted_mean<rational> zero;
+        zero.add(rational(1), rational(1));
+        zero.add(rational(2), rational(-1));
+        ostringstream os;
+        os << "do not catch logic_error! Result: " << zero.value();
+        PrintError(__FILE__, __LINE__, "TestRationalStatistics", os);
+        TestErrors.UpdateError();
+    } 
+    catch (logic_error const& err) {
+    }
+    try {
+        rational_statistics<rational> wide;
+        wide.add(rational(integer_traits<int>::max()));
+        wide.add(rational(integer_traits<int>::max()));
+        ostringstream os;
+        os << "do not catch overflow_error! Result: " << wide.sum();
+        PrintError(__FILE__, __LINE__, "TestRationalStatistics", os);
+        TestErrors.UpdateError();
+    } 
+    catch (overflow_error const& err) {
+    }
+}
+
 void RunDefaultTests() {
     vector<function<void()>> funcs = {
         TestEqual, TestTrueOrFalse, TestComparsion, TestOperators, 
         TestOperatorsTwo, TestIOSTREAM, TestContainer, TestMap, TestCatchError,
+        TestWidths, TestGreatestCommonDivisor, TestOverflow, TestBigRational,
+        TestLazyRational, TestRationalArray, TestRationalReduce,
+        TestRationalHash, TestParseRational, TestFormatRational,
+        TestRationalBinary, TestInstrumentation, TestRationalMatrix,
+        TestRationalPolynomial, TestRationalFloat,
+        TestRationalExpression, TestRationalDot, TestRationalSort,
+        TestFixedRational, TestRationalDecimal, TestRationalFarey,
+        TestRationalStatistics,
     };
     RunTests(funcs);
     PrintGlobalResultTest();
@@ -0,0 +1,140 @@
+#include "thread_pool.h"
+#include <limits>
+
+
+/*
+ * `true` in the threads, which run a loop of some thread pool.
+ */
+static thread_local bool InsideParallelFor = false;
+
+/*
+ * Constructor class. Starts `threads - 1` worker threads, the calling
+ * thread is the last one.
+ */
+thread_pool::thread_pool(std::size_t threads)
+    : task(nullptr), task_count(0), next_index(0), pending(0), generation(0),
+      stopping(false), error_index(0)
+{
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    for (std::size_t i = 1; i < threads; i++) {
+        workers.emplace_back(&thread_pool::work, this);
+    }
+}
+/*
+ * Destructor class. Stops and joins worker threads.
+ */
+thread_pool::~thread_pool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+/*
+ * This function returns number of threads, including the calling thread.
+ */
+std::size_t thread_pool::size() const {
+    return workers.size() + 1;
+}
+/*
+ * This function runs loop: publishes it to workers, takes part in it and
+ * waits for the last index. Loops from different threads run one by one.
+ */
+void thread_pool::run(std::size_t count,
+        const std::function<void(std::size_t)>& function) {
+    if (count == 0) {
+        return;
+    }
+    if (InsideParallelFor || workers.empty()) {
+        for (std::size_t i = 0; i < count; i++) {
+            function(i);
+        }
+        return;
+    }
+    std::lock_guard<std::mutex> serial(run_mutex);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = &function;
+        task_count = count;
+        next_index = 0;
+        pending = count;
+        error = nullptr;
+        error_index = std::numeric_limits<std::size_t>::max();
+        generation++;
+    }
+    wake.notify_all();
+    runTasks();
+    std::exception_ptr result;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this]() { return pending == 0; });
+        task = nullptr;
+        result = error;
+        error = nullptr;
+    }
+    if (result) {
+        std::rethrow_exception(result);
+    }
+}
+/*
+ * This function takes indices of the current loop and runs them, until
+ * all indices are taken.
+ */
+void thread_pool::runTasks() {
+    InsideParallelFor = true;
+    for (;;) {
+        const std::function<void(std::size_t)>* function;
+        std::size_t index;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (task == nullptr || next_index >= task_count) {
+                break;
+            }
+            function = task;
+            index = next_index++;
+        }
+        try {
+            (*function)(index);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (index < error_index) {
+                error = std::current_exception();
+                error_index = index;
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--pending == 0) {
+            finished.notify_all();
+        }
+    }
+    InsideParallelFor = false;
+}
+/*
+ * Main function of worker thread: waits for a new loop and runs it.
+ */
+void thread_pool::work() {
+    std::size_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this, seen]() {
+                return stopping || generation != seen;
+            });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+        }
+        runTasks();
+    }
+}
+
+thread_pool& DefaultThreadPool() {
+    static thread_pool pool;
+    return pool;
+}
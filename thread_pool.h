@@ -0,0 +1,76 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Class thread_pool. Fixed set of worker threads for data-parallel loops.
+ *
+ * Public:
+ * 1. `thread_pool(threads)` - class initializer. `threads` - number of
+ * threads, including the calling thread. By default (0) it is
+ * `std::thread::hardware_concurrency()`.
+ * 2. `size()` - return number of threads.
+ * 3. `parallelFor(count, function)` - call `function(index)` for every
+ * index in `[0, count)` and wait for all calls. The calling thread takes
+ * part in the work. If calls raise errors, the error of the smallest
+ * index is raised again, so the result does not depend on scheduling.
+ * Nested `parallelFor` (from inside `function`) runs serially.
+ *
+ * Private:
+ * 1. `workers` - worker threads.
+ * 2. `task`, `task_count`, `next_index`, `pending` - current loop.
+ * 3. `generation` - number of started loops, wakes the workers.
+ * 4. `error`, `error_index` - first error of the current loop.
+ * 5. `run` - run loop with type-erased function.
+ * 6. `runTasks` - take indices of the current loop until there are none.
+ * 7. `work` - main function of worker thread.
+ */
+class thread_pool {
+public:
+    explicit thread_pool(std::size_t threads = 0);
+    ~thread_pool();
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    std::size_t size() const;
+
+    template<typename Function>
+    void parallelFor(std::size_t count, Function function) {
+        run(count, std::function<void(std::size_t)>(function));
+    }
+
+private:
+    std::vector<std::thread> workers;
+    std::mutex run_mutex;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    const std::function<void(std::size_t)>* task;
+    std::size_t task_count;
+    std::size_t next_index;
+    std::size_t pending;
+    std::size_t generation;
+    bool stopping;
+    std::exception_ptr error;
+    std::size_t error_index;
+
+    void run(std::size_t count, const std::function<void(std::size_t)>& function);
+    void runTasks();
+    void work();
+};
+
+/*
+ * Function returns thread pool, shared by parallel algorithms of the
+ * library. It is created on first use with
+ * `std::thread::hardware_concurrency()` threads.
+ */
+thread_pool& DefaultThreadPool();
+
+#endif /* THREAD_POOL_H */
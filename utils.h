@@ -1,14 +1,484 @@
 #ifndef UTILS_H
 #define UTILS_H
 
-/* 
- * Function returns least common denominator of two numbers.
+#include <istream>
+#include <ostream>
+#include <limits>
+#include <cstddef>
+#include <type_traits>
+#include "rational_instrumentation.h"
+
+/*
+ * Traits of integer types, which can be used as numerator and denominator
+ * of `basic_rational`: `int`, `long`, `long long` and `__int128`.
+ *
+ * `std::numeric_limits` is not specialized for `__int128` in strict ISO
+ * mode, so the limits are declared here.
+ *
+ * `unsigned_type` - unsigned integer type of the same width.
+ * `wider_type` - next wider signed integer type, `void` for the widest one.
+ * `min()` - minimal value of the type.
+ * `max()` - maximal value of the type.
+ */
+template<typename T>
+struct integer_traits;
+
+template<>
+struct integer_traits<int> {
+    typedef unsigned int unsigned_type;
+    typedef long long wider_type;
+    static constexpr int min() { return std::numeric_limits<int>::min(); }
+    static constexpr int max() { return std::numeric_limits<int>::max(); }
+};
+
+template<>
+struct integer_traits<long> {
+    typedef unsigned long unsigned_type;
+    typedef __int128 wider_type;
+    static constexpr long min() { return std::numeric_limits<long>::min(); }
+    static constexpr long max() { return std::numeric_limits<long>::max(); }
+};
+
+template<>
+struct integer_traits<long long> {
+    typedef unsigned long long unsigned_type;
+    typedef __int128 wider_type;
+    static constexpr long long min() {
+        return std::numeric_limits<long long>::min();
+    }
+    static constexpr long long max() {
+        return std::numeric_limits<long long>::max();
+    }
+};
+
+template<>
+struct integer_traits<__int128> {
+    typedef unsigned __int128 unsigned_type;
+    typedef void wider_type;
+    static constexpr __int128 min() { return -max() - 1; }
+    static constexpr __int128 max() {
+        return static_cast<__int128>(~static_cast<unsigned_type>(0) >> 1);
+    }
+};
+
+/*
+ * Function returns absolute value of number.
+ * Works for every type from `integer_traits`, including `__int128`.
+ */
+template<typename T>
+constexpr T AbsoluteValue(T value) {
+    return value < 0 ? -value : value;
+}
+
+/*
+ * Function returns number of trailing zero bits of the number.
+ * Number must be different from zero.
+ *
+ * Overloaded for every unsigned width, so the matching `ctz` instruction
+ * is used.
+ */
+constexpr int CountTrailingZeros(unsigned int value) {
+    return __builtin_ctz(value);
+}
+constexpr int CountTrailingZeros(unsigned long value) {
+    return __builtin_ctzl(value);
+}
+constexpr int CountTrailingZeros(unsigned long long value) {
+    return __builtin_ctzll(value);
+}
+constexpr int CountTrailingZeros(unsigned __int128 value) {
+    return static_cast<unsigned long long>(value)
+            ? __builtin_ctzll(static_cast<unsigned long long>(value))
+            : 64 + __builtin_ctzll(static_cast<unsigned long long>(value >> 64));
+}
+
+/*
+ * The function returns the greatest common divisor of two unsigned numbers.
+ *
+ * Stein's (binary) algorithm is used: common powers of two are removed
+ * with `CountTrailingZeros`, then the smaller number is subtracted from the
+ * larger one, so there is no division in the loop. Both differences are
+ * computed and selected without branches, trailing zeros of `b - a` and
+ * `a - b` are the same.
+ */
+template<typename U>
+RATIONAL_INSTRUMENTED_CONSTEXPR
+U BinaryGreatestCommonDivisor(U a, U b) {
+    if (a == 0) {
+        return b;
+    }
+    if (b == 0) {
+        return a;
+    }
+    int azeros = CountTrailingZeros(a);
+    int bzeros = CountTrailingZeros(b);
+    int shift = azeros < bzeros ? azeros : bzeros;
+    a >>= azeros;
+    b >>= bzeros;
+    while (a != b) {
+        RATIONAL_INSTRUMENT(CountRationalEvent(rational_event::gcd_iteration));
+        U difference = b - a;
+        U reversed = a - b;
+        azeros = CountTrailingZeros(difference);
+        bool less = a < b;
+        b = less ? a : b;
+        a = (less ? difference : reversed) >> azeros;
+    }
+    return b << shift;
+}
+
+/*
+ * Size bound of the small-operand GCD table: it answers GCD, if one of
+ * the operands is less than `2^RATIONAL_GCD_TABLE_BITS`. Values are
+ * stored in bytes, so the bound is at most 8 bits (64 KB table). Build
+ * with `-DRATIONAL_GCD_TABLE_BITS=0` to disable the table. The macro must
+ * be the same for all files of the program.
+ */
+#ifndef RATIONAL_GCD_TABLE_BITS
+#define RATIONAL_GCD_TABLE_BITS 8
+#endif
+
+static_assert(RATIONAL_GCD_TABLE_BITS >= 0 && RATIONAL_GCD_TABLE_BITS <= 8,
+        "RATIONAL_GCD_TABLE_BITS must be in range [0, 8]");
+
+const unsigned GreatestCommonDivisorTableSize = 1u << RATIONAL_GCD_TABLE_BITS;
+
+/*
+ * Struct gcd_table. Greatest common divisors of all pairs of numbers less
+ * than `GreatestCommonDivisorTableSize`.
+ *
+ * Every entry is computed from an entry with smaller operands,
+ * `gcd(a, b) = gcd(b, a % b)`, so the table is built at compile time.
+ */
+struct gcd_table {
+    unsigned char values[GreatestCommonDivisorTableSize]
+            [GreatestCommonDivisorTableSize];
+
+    constexpr gcd_table() : values() {
+        for (unsigned a = 0; a < GreatestCommonDivisorTableSize; a++) {
+            for (unsigned b = 0; b <= a; b++) {
+                unsigned char gcd = static_cast<unsigned char>(
+                        b == 0 ? a : values[b][a % b]);
+                values[a][b] = gcd;
+                values[b][a] = gcd;
+            }
+        }
+    }
+};
+
+/*
+ * Shared read-only table. The class is a template, so the table is
+ * defined in the header once for the whole program.
+ */
+template<typename Tag = void>
+struct gcd_table_storage {
+    static constexpr gcd_table table{};
+};
+
+template<typename Tag>
+constexpr gcd_table gcd_table_storage<Tag>::table;
+
+/*
+ * Function checks, if the GCD table answers GCD of `a` and `b`.
+ */
+template<typename U>
+constexpr bool IsTableGreatestCommonDivisor(U a, U b) {
+    return RATIONAL_GCD_TABLE_BITS > 0 &&
+            (a < GreatestCommonDivisorTableSize ||
+            b < GreatestCommonDivisorTableSize);
+}
+
+/*
+ * The function returns the greatest common divisor of two unsigned
+ * numbers by the table, one of them must be less than
+ * `GreatestCommonDivisorTableSize`. The other one is reduced by one `%`
+ * first: `gcd(a, b) = gcd(a % b, b)`.
  */
-int LeastCommonDenominator(int a, int b);
-/* 
- * Function returns greatest common divisor of two numbers.
- * Euclid's algorithm for integers is used.
+template<typename U>
+constexpr U TableGreatestCommonDivisor(U a, U b) {
+    if (a >= GreatestCommonDivisorTableSize) {
+        if (b == 0) {
+            return a;
+        }
+        a %= b;
+    } else if (b >= GreatestCommonDivisorTableSize) {
+        if (a == 0) {
+            return b;
+        }
+        b %= a;
+    }
+    return gcd_table_storage<>::table.values[a][b];
+}
+
+/*
+ * The function returns the greatest common divisor of two numbers.
+ * Sign of the numbers is ignored, result is not negative.
+ *
+ * If one of the numbers is small, the GCD table is used (see
+ * `RATIONAL_GCD_TABLE_BITS`), otherwise binary GCD on the unsigned type
+ * of the same width. Both ways are used by `updateRational`, operators
+ * and `LeastCommonDenominator`.
+ */
+template<typename T>
+RATIONAL_INSTRUMENTED_CONSTEXPR
+T GreatestCommonDivisor(T p, T q) {
+    typedef typename integer_traits<T>::unsigned_type unsigned_type;
+    RATIONAL_INSTRUMENT(CountRationalEvent(rational_event::gcd));
+    unsigned_type u = static_cast<unsigned_type>(p);
+    unsigned_type v = static_cast<unsigned_type>(q);
+    u = p < 0 ? static_cast<unsigned_type>(0 - u) : u;
+    v = q < 0 ? static_cast<unsigned_type>(0 - v) : v;
+    if (IsTableGreatestCommonDivisor(u, v)) {
+        RATIONAL_INSTRUMENT(CountRationalEvent(rational_event::gcd_table));
+        return static_cast<T>(TableGreatestCommonDivisor(u, v));
+    }
+    return static_cast<T>(BinaryGreatestCommonDivisor(u, v));
+}
+
+/*
+ * The function returns the smallest common denominator for two
+ * rational numbers: `a / gcd(a, b) * b`.
+ *
+ * Denominators must be positive. Division is done before multiplication,
+ * so the result overflows only if least common multiple itself does
+ * not fit into the type.
+ */
+template<typename T>
+RATIONAL_INSTRUMENTED_CONSTEXPR
+T LeastCommonDenominator(T a, T b) {
+    RATIONAL_INSTRUMENT(CountRationalEvent(rational_event::lcd));
+    return a / GreatestCommonDivisor(a, b) * b;
+}
+
+/*
+ * Function mixes bits of 64-bit value, so every bit of the input changes
+ * about half of the bits of the result (finalizer of MurmurHash3).
+ */
+constexpr unsigned long long MixHash(unsigned long long value) {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return value;
+}
+
+/*
+ * Functions return hash of integer and of rational `num/deno`.
+ * `__int128` is folded to 64 bits first.
+ */
+template<typename T>
+constexpr unsigned long long HashInteger(T value) {
+    return static_cast<unsigned long long>(value);
+}
+constexpr unsigned long long HashInteger(__int128 value) {
+    return static_cast<unsigned long long>(value) ^
+            MixHash(static_cast<unsigned long long>(
+                    static_cast<unsigned __int128>(value) >> 64));
+}
+
+template<typename T>
+constexpr unsigned long long HashRational(T num, T deno) {
+    return MixHash(HashInteger(num) ^
+            MixHash(HashInteger(deno) + 0x9e3779b97f4a7c15ULL));
+}
+
+/*
+ * Function returns table of two-digit numbers `"00"`, `"01"`, ..., `"99"`,
+ * so integers are formatted by two digits per division.
+ */
+inline const char* DecimalDigitPairs() {
+    static const char table[] =
+            "00010203040506070809101112131415161718192021222324252627282930313233"
+            "34353637383940414243444546474849505152535455565758596061626364656667"
+            "6869707172737475767778798081828384858687888990919293949596979899";
+    return table;
+}
+
+/*
+ * Function returns number of decimal digits of the number.
+ */
+constexpr int CountDecimalDigits(unsigned long long value) {
+    int digits = 1;
+    for (;;) {
+        if (value < 10) {
+            return digits;
+        }
+        if (value < 100) {
+            return digits + 1;
+        }
+        if (value < 1000) {
+            return digits + 2;
+        }
+        if (value < 10000) {
+            return digits + 3;
+        }
+        value /= 10000;
+        digits += 4;
+    }
+}
+
+/*
+ * Function writes exactly `digits` decimal digits of the number, which
+ * end at `last`, with leading zeros.
+ */
+inline void FormatDigits(char* last, unsigned long long value, int digits) {
+    const char* pairs = DecimalDigitPairs();
+    while (digits >= 2) {
+        unsigned index = static_cast<unsigned>(value % 100) * 2;
+        value /= 100;
+        *--last = pairs[index + 1];
+        *--last = pairs[index];
+        digits -= 2;
+    }
+    if (digits) {
+        *--last = static_cast<char>('0' + value % 10);
+    }
+}
+
+/*
+ * Function returns number of characters, which is enough for decimal
+ * integer of the type with sign.
+ */
+template<typename T>
+constexpr std::size_t MaxFormattedLength() {
+    return sizeof(T) * 3 + 2;
+}
+
+/*
+ * Functions write integer in decimal format to `first` and return the
+ * end of written characters. There must be space for
+ * `MaxFormattedLength<T>()` characters.
+ *
+ * The output is the same as of `std::ostream` with default flags.
+ * `__int128` is formatted by 19 digits in 64-bit parts.
+ */
+inline char* FormatUnsigned(char* first, unsigned long long value) {
+    int digits = CountDecimalDigits(value);
+    FormatDigits(first + digits, value, digits);
+    return first + digits;
+}
+
+inline char* FormatUnsigned(char* first, unsigned __int128 value) {
+    const unsigned long long base = 10000000000000000000ULL;
+    if (value <= ~0ULL) {
+        return FormatUnsigned(first, static_cast<unsigned long long>(value));
+    }
+    first = FormatUnsigned(first, value / base);
+    FormatDigits(first + 19, static_cast<unsigned long long>(value % base), 19);
+    return first + 19;
+}
+
+template<typename T>
+char* FormatInteger(char* first, T value) {
+    typedef typename integer_traits<T>::unsigned_type unsigned_type;
+    typedef typename std::conditional<(sizeof(T) > 8), unsigned __int128,
+            unsigned long long>::type format_type;
+    unsigned_type magnitude = static_cast<unsigned_type>(value);
+    if (value < 0) {
+        *first++ = '-';
+        magnitude = ~magnitude + 1;
+    }
+    return FormatUnsigned(first, static_cast<format_type>(magnitude));
+}
+
+/*
+ * Function checks, if the stream formats integers in plain decimal
+ * format, so `FormatInteger` gives the same characters.
+ */
+inline bool HasDefaultIntegerFormat(const std::ostream& stream) {
+    return (stream.flags() & (std::ios_base::basefield | std::ios_base::showpos))
+            == std::ios_base::dec && stream.width() == 0;
+}
+
+/*
+ * Function writes integer to the stream in decimal format.
+ *
+ * With default flags the integer is formatted by `FormatInteger` and
+ * written with one `write` call. Otherwise (`std::hex`, `std::showpos`,
+ * `std::setw`) types not wider than `long long` are written by the
+ * stream itself.
+ */
+template<typename T>
+void WriteInteger(std::ostream& stream, T value) {
+    if (!HasDefaultIntegerFormat(stream)) {
+        stream << static_cast<long long>(value);
+        return;
+    }
+    char buffer[MaxFormattedLength<T>()];
+    stream.write(buffer, FormatInteger(buffer, value) - buffer);
+}
+
+/*
+ * Function writes `__int128` to the stream in decimal format.
+ * The stream has no overload for this type, so flags are ignored.
+ */
+inline void WriteInteger(std::ostream& stream, __int128 value) {
+    char buffer[MaxFormattedLength<__int128>()];
+    stream.write(buffer, FormatInteger(buffer, value) - buffer);
+}
+
+/*
+ * Function reads integer in decimal format from the stream.
+ *
+ * Types not wider than `long long` are read by the stream itself.
+ * Sets `failbit`, if value does not fit into the type.
+ */
+template<typename T>
+void ReadInteger(std::istream& stream, T& value) {
+    long long input;
+    stream >> input;
+    if (input < integer_traits<T>::min() || input > integer_traits<T>::max()) {
+        stream.setstate(std::ios_base::failbit);
+        return;
+    }
+    value = static_cast<T>(input);
+}
+
+/*
+ * Function reads `__int128` in decimal format from the stream.
+ *
+ * Skips leading whitespaces, accepts optional sign.
+ * Sets `failbit`, if there are no digits or value does not fit into the type.
  */
-int GreatestCommonDivisor(int p, int q);
+inline void ReadInteger(std::istream& stream, __int128& value) {
+    typedef unsigned __int128 magnitude_type;
+    std::istream::sentry sentry(stream);
+    if (!sentry) {
+        return;
+    }
+    bool negative = false;
+    int c = stream.peek();
+    if (c == '-' || c == '+') {
+        negative = c == '-';
+        stream.get();
+        c = stream.peek();
+    }
+    const magnitude_type limit =
+            static_cast<magnitude_type>(integer_traits<__int128>::max()) +
+            (negative ? 1 : 0);
+    magnitude_type magnitude = 0;
+    bool digits = false;
+    while (c >= '0' && c <= '9') {
+        unsigned digit = static_cast<unsigned>(c - '0');
+        if (magnitude > (limit - digit) / 10) {
+            stream.setstate(std::ios_base::failbit);
+            return;
+        }
+        magnitude = magnitude * 10 + digit;
+        digits = true;
+        stream.get();
+        c = stream.peek();
+    }
+    if (c == std::char_traits<char>::eof()) {
+        stream.setstate(std::ios_base::eofbit);
+    }
+    if (!digits) {
+        stream.setstate(std::ios_base::failbit);
+        return;
+    }
+    value = negative ? static_cast<__int128>(~magnitude + 1)
+            : static_cast<__int128>(magnitude);
+}
 
 #endif /* UTILS_H */